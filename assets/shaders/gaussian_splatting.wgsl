@@ -1,3 +1,11 @@
+// Permutation defines, set by the renderer through ShaderPreprocessor:
+//   WORKGROUP_SIZE  threads per compute workgroup.
+//   SH_DEGREE       degree of the view dependent color, 0 reads the packed splat color.
+//   CHUNK_CULLING   threads map to splats through the visible chunk list.
+//   SPLAT_CULLING   the transform pass culls splats by opacity and pixel area.
+//   SHARED_SORT     adds the block sort kernels that run the short bitonic steps in workgroup memory.
+//   KEYS_PER_THREAD sort keys per thread of the block sort kernels, 2 or 4.
+
 struct VertexInput {
     @builtin(vertex_index) index: u32,
     @builtin(instance_index) instanceIndex: u32
@@ -7,14 +15,30 @@ struct VertexOutput {
     @builtin(position) position: vec4<f32>,
     @location(0) @interpolate(perspective) offset: vec2<f32>,
     @location(1) @interpolate(flat) uniformScale: f32,
-    @location(2) color: u32
+    @location(2) color: u32,
+    @location(3) @interpolate(flat) viewDepth: f32,
+    @location(4) @interpolate(flat) instance: u32
+}
+
+// Weighted blended order independent transparency targets.
+struct OitOutput {
+    @location(0) accum: vec4<f32>,  // Weighted sum of premultiplied color and alpha
+    @location(1) reveal: f32        // Product of (1 - alpha), blended by the pipeline
 }
 
 struct ShaderUniforms {
     model: mat4x4<f32>,      // Model matrix
     view: mat4x4<f32>,       // Camera view matrix
     projection: mat4x4<f32>, // Camera projection matrix
-    splatScale: f32          // Scaling of splats
+    splatScale: f32,         // Scaling of splats
+    cameraPosition: vec4<f32>, // Camera position in model space
+    shDegree: u32,           // Degree of SH evaluated this frame, 0 disables the SH pass
+    shWordsPerSplat: u32,    // Stride of the packed SH coefficients
+    visibleChunkCount: u32,  // Number of chunks that passed culling this frame
+    alphaThreshold: f32,     // Splats below this opacity are culled
+    pixelAreaThreshold: f32, // Splats covering fewer pixels are culled
+    viewportHeight: f32,     // Viewport height in pixels
+    frameIndex: u32          // Seeds the stochastic transparency hash
 };
 
 struct Splat {
@@ -32,6 +56,12 @@ struct SortSplatsData {
 @group(0) @binding(0)
 var<storage, read> splats: array<Splat>;
 
+@group(0) @binding(1)
+var<storage, read> shCoefficients: array<u32>;
+
+@group(0) @binding(2)
+var<storage, read_write> splatColors: array<u32>;
+
 @group(1) @binding(0)
 var<storage, read_write> sortedSplats: array<SortSplatsData>;
 
@@ -44,6 +74,22 @@ var<storage, read> sortSplatsParamsData: array<vec2<u32>>;
 @group(1) @binding(3)
 var<uniform> uSortSplatsParam: vec2<u32>;
 
+@group(1) @binding(4)
+var<storage, read> visibleChunks: array<u32>;
+
+// Indirect draw arguments (vertex count, instance count, first vertex, first instance) followed by
+// the number of splats culled by opacity and by size.
+@group(1) @binding(5)
+var<storage, read_write> cullStats: array<atomic<u32>, 6>;
+
+// Per workgroup counts of drawn, opacity culled and size culled splats.
+var<workgroup> groupCullCounts: array<atomic<u32>, 3>;
+
+// Splats per chunk, matches SceneCache::ChunkSize.
+const CHUNK_SIZE: u32 = 256u;
+// Marks padding entries of the sort buffer, they sort to the back and are never drawn.
+const INVALID_INDEX: u32 = 0xFFFFFFFFu;
+
 // Define the 2 triangles
 var<private> quadVertices: array<vec2<f32>, 4> = array<vec2<f32>, 4>(
     vec2<f32>(1.0, 1.0),   // bottom right
@@ -52,22 +98,108 @@ var<private> quadVertices: array<vec2<f32>, 4> = array<vec2<f32>, 4>(
     vec2<f32>(-1.0, -1.0),   // top left
 );
 
-@compute @workgroup_size(256)
-fn cs_calculate_sort_splats(@builtin(global_invocation_id) global_id: vec3<u32>) {
-   if (global_id.x >= arrayLength(&splats)) {
+// Spherical harmonics basis constants.
+const SH_C1: f32 = 0.4886025119029199;
+const SH_C2 = array<f32, 5>(1.0925484305920792, -1.0925484305920792, 0.31539156525252005, -1.0925484305920792, 0.5462742152960396);
+const SH_C3 = array<f32, 7>(-0.5900435899266435, 2.890611442640554, -0.4570457994644658, 0.3731763325901154, -0.4570457994644658, 1.445305721320277, -0.5900435899266435);
+
+@compute @workgroup_size(WORKGROUP_SIZE)
+fn cs_evaluate_sh(@builtin(global_invocation_id) global_id: vec3<u32>) {
+   let index = visibleSplatIndex(global_id.x);
+   if (index == INVALID_INDEX) {
       return;
    }
 
-   var viewPosition = uUniforms.view * uUniforms.model * splats[global_id.x].position;
+   let splat = splats[index];
+   let dir = normalize(splat.position.xyz - uUniforms.cameraPosition.xyz);
+   let x = dir.x;
+   let y = dir.y;
+   let z = dir.z;
+
+   // Degree 0 is already baked into the packed color.
+   var color = unpackColor(splat.color);
+   var result = -SH_C1 * y * shCoefficient(index, 1u) + SH_C1 * z * shCoefficient(index, 2u) - SH_C1 * x * shCoefficient(index, 3u);
+
+#if SH_DEGREE > 1
+   {
+      let xx = x * x;
+      let yy = y * y;
+      let zz = z * z;
+      result += SH_C2[0] * x * y * shCoefficient(index, 4u) +
+                SH_C2[1] * y * z * shCoefficient(index, 5u) +
+                SH_C2[2] * (2.0 * zz - xx - yy) * shCoefficient(index, 6u) +
+                SH_C2[3] * x * z * shCoefficient(index, 7u) +
+                SH_C2[4] * (xx - yy) * shCoefficient(index, 8u);
+
+#if SH_DEGREE > 2
+         result += SH_C3[0] * y * (3.0 * xx - yy) * shCoefficient(index, 9u) +
+                   SH_C3[1] * x * y * z * shCoefficient(index, 10u) +
+                   SH_C3[2] * y * (4.0 * zz - xx - yy) * shCoefficient(index, 11u) +
+                   SH_C3[3] * z * (2.0 * zz - 3.0 * xx - 3.0 * yy) * shCoefficient(index, 12u) +
+                   SH_C3[4] * x * (4.0 * zz - xx - yy) * shCoefficient(index, 13u) +
+                   SH_C3[5] * z * (xx - yy) * shCoefficient(index, 14u) +
+                   SH_C3[6] * x * (xx - 3.0 * yy) * shCoefficient(index, 15u);
+#endif
+   }
+#endif
+
+   color = vec4<f32>(clamp(color.rgb + result, vec3<f32>(0.0), vec3<f32>(1.0)), color.a);
+   splatColors[index] = packColor(color);
+}
+
+@compute @workgroup_size(WORKGROUP_SIZE)
+fn cs_calculate_sort_splats(@builtin(global_invocation_id) global_id: vec3<u32>, @builtin(local_invocation_index) local_index: u32) {
+   if (local_index < 3u) {
+      atomicStore(&groupCullCounts[local_index], 0u);
+   }
+   workgroupBarrier();
 
    var splat: SortSplatsData;
-   splat.index = global_id.x;
-   splat.z = viewPosition.z;
+   splat.index = visibleSplatIndex(global_id.x);
+   splat.z = 3.402823e38;
+
+   // Culled splats get the padding index so they sort behind all drawn splats.
+   if (splat.index != INVALID_INDEX) {
+      let source = splats[splat.index];
+      let viewPosition = uUniforms.view * uUniforms.model * source.position;
 
-   sortedSplats[global_id.x] = splat;
+#if SPLAT_CULLING
+      // Same quad size as in vs_main, converted to pixels.
+      let uniformScale = uUniforms.splatScale / -viewPosition.z + source.scale.w;
+      let pixelRadius = uniformScale * uUniforms.projection[1][1] / -viewPosition.z * uUniforms.viewportHeight * 0.5;
+      let alpha = f32(source.color & 0xFFu) / 255.0;
+
+      if (alpha < uUniforms.alphaThreshold) {
+         atomicAdd(&groupCullCounts[1], 1u);
+         splat.index = INVALID_INDEX;
+      } else if (4.0 * pixelRadius * pixelRadius < uUniforms.pixelAreaThreshold) {
+         atomicAdd(&groupCullCounts[2], 1u);
+         splat.index = INVALID_INDEX;
+      } else {
+         atomicAdd(&groupCullCounts[0], 1u);
+         splat.z = viewPosition.z;
+      }
+#else
+      atomicAdd(&groupCullCounts[0], 1u);
+      splat.z = viewPosition.z;
+#endif
+   }
+
+   if (global_id.x < arrayLength(&sortedSplats)) {
+      sortedSplats[global_id.x] = splat;
+   }
+
+   // One global atomic per workgroup and counter.
+   workgroupBarrier();
+   if (local_index < 3u) {
+      let count = atomicLoad(&groupCullCounts[local_index]);
+      if (count > 0u) {
+         atomicAdd(&cullStats[select(local_index + 3u, 1u, local_index == 0u)], count);
+      }
+   }
 }
 
-@compute @workgroup_size(256)
+@compute @workgroup_size(WORKGROUP_SIZE)
 fn cs_sort_splats(@builtin(global_invocation_id) global_id: vec3<u32>) {
    let k: u32 = uSortSplatsParam.x;
    let j: u32 = uSortSplatsParam.y;
@@ -76,7 +208,7 @@ fn cs_sort_splats(@builtin(global_invocation_id) global_id: vec3<u32>) {
    let l: u32 = i ^ j;
 
    var temp: SortSplatsData;
-   if (i < l) {
+   if (i < l && l < arrayLength(&sortedSplats)) {
       if (
          ((i & k) == 0u) && (sortedSplats[i].z > sortedSplats[l].z) ||
          ((i & k) != 0u) && (sortedSplats[i].z < sortedSplats[l].z)
@@ -88,22 +220,97 @@ fn cs_sort_splats(@builtin(global_invocation_id) global_id: vec3<u32>) {
    }
 }
 
+#if SHARED_SORT
+// Keys sorted together in workgroup memory by the block kernels.
+const SORT_BLOCK_SIZE: u32 = WORKGROUP_SIZE * KEYS_PER_THREAD;
+var<workgroup> sortBlock: array<SortSplatsData, SORT_BLOCK_SIZE>;
+
+// Sorts each block of keys completely, the direction alternates per block like in the global steps.
+@compute @workgroup_size(WORKGROUP_SIZE)
+fn cs_sort_block(@builtin(workgroup_id) group_id: vec3<u32>, @builtin(local_invocation_index) local_index: u32) {
+   let base = group_id.x * SORT_BLOCK_SIZE;
+   loadSortBlock(base, local_index);
+   for (var k = 2u; k <= SORT_BLOCK_SIZE; k <<= 1u) {
+      sortBlockSteps(base, local_index, k, k >> 1u);
+   }
+   storeSortBlock(base, local_index);
+}
+
+// Finishes merge k once the compare distance drops below the block size.
+@compute @workgroup_size(WORKGROUP_SIZE)
+fn cs_sort_block_merge(@builtin(workgroup_id) group_id: vec3<u32>, @builtin(local_invocation_index) local_index: u32) {
+   let base = group_id.x * SORT_BLOCK_SIZE;
+   loadSortBlock(base, local_index);
+   sortBlockSteps(base, local_index, uSortSplatsParam.x, SORT_BLOCK_SIZE >> 1u);
+   storeSortBlock(base, local_index);
+}
+
+fn loadSortBlock(base: u32, local_index: u32) {
+   for (var t = 0u; t < KEYS_PER_THREAD; t++) {
+      let i = local_index + t * WORKGROUP_SIZE;
+      sortBlock[i] = sortedSplats[base + i];
+   }
+   workgroupBarrier();
+}
+
+fn storeSortBlock(base: u32, local_index: u32) {
+   for (var t = 0u; t < KEYS_PER_THREAD; t++) {
+      let i = local_index + t * WORKGROUP_SIZE;
+      sortedSplats[base + i] = sortBlock[i];
+   }
+}
+
+// Compare and exchange steps of merge k from distance jStart down to 1, each thread handles
+// KEYS_PER_THREAD / 2 pairs per step.
+fn sortBlockSteps(base: u32, local_index: u32, k: u32, jStart: u32) {
+   for (var j = jStart; j > 0u; j >>= 1u) {
+      for (var p = 0u; p < KEYS_PER_THREAD / 2u; p++) {
+         // Pair q compares element i, which has bit j clear, with element i + j.
+         let q = local_index + p * WORKGROUP_SIZE;
+         let i = ((q & ~(j - 1u)) << 1u) | (q & (j - 1u));
+         let l = i | j;
+         let ascending = ((base + i) & k) == 0u;
+         let a = sortBlock[i];
+         let b = sortBlock[l];
+         if ((ascending && a.z > b.z) || (!ascending && a.z < b.z)) {
+            sortBlock[i] = b;
+            sortBlock[l] = a;
+         }
+      }
+      workgroupBarrier();
+   }
+}
+#endif
+
 @vertex
 fn vs_main(in: VertexInput) -> VertexOutput {
    var index: u32 = sortedSplats[in.instanceIndex].index;
 
    var output: VertexOutput;
 
-   let splat = splats[sortedSplats[in.instanceIndex].index];
+   // Padding slots of partially filled chunks produce a degenerate quad outside the clip volume.
+   if (index == INVALID_INDEX) {
+      output.position = vec4<f32>(0.0, 0.0, 2.0, 1.0);
+      return output;
+   }
+
+   let splat = splats[index];
 
    let splatViewPosition =  uUniforms.view * uUniforms.model * splat.position;
-   let uniformScale = (uUniforms.splatScale / -splatViewPosition.z);
+   // Merged level of detail splats also cover the spread of the splats they replace, stored in scale.w.
+   let uniformScale = (uUniforms.splatScale / -splatViewPosition.z) + splat.scale.w;
    let vertexOffset = quadVertices[in.index] * uniformScale;
 
    output.position = uUniforms.projection * (splatViewPosition + vec4<f32>(vertexOffset, 0.0, 0.0));
    output.offset = quadVertices[in.index];
    output.uniformScale = uniformScale;
+   output.viewDepth = -splatViewPosition.z;
+   output.instance = in.instanceIndex;
+#if SH_DEGREE > 0
+   output.color = splatColors[index];
+#else
    output.color = splat.color;
+#endif
 
    return output;
 }
@@ -121,11 +328,88 @@ fn fs_main(in: VertexOutput) -> @location(0) vec4f {
    return vec4<f32>(color.rgb, alpha);
 }
 
+// Unsorted splats, accumulated with a depth weight so nearer splats dominate (McGuire and Bavoil 2013).
+@fragment
+fn fs_oit(in: VertexOutput) -> OitOutput {
+   let color = unpackColor(in.color);
+   let offset = sqrt(dot(in.offset, in.offset));
+   let alpha = color.a * gaussianF32(offset, in.uniformScale);
+
+   let depth = in.viewDepth;
+   let weight = alpha * clamp(10.0 / (1e-5 + pow(depth / 5.0, 2.0) + pow(depth / 200.0, 6.0)), 1e-2, 3e3);
+
+   var output: OitOutput;
+   output.accum = vec4<f32>(color.rgb * alpha, alpha) * weight;
+   output.reveal = alpha;
+   return output;
+}
+
+// Keeps the fragment with probability alpha and lets the depth test pick the nearest kept splat, so the
+// expected color equals the sorted blend (Enderton et al. 2010). Thresholds differ per pixel, splat and frame.
+@fragment
+fn fs_stochastic(in: VertexOutput) -> @location(0) vec4f {
+   let color = unpackColor(in.color);
+   let offset = sqrt(dot(in.offset, in.offset));
+   let alpha = color.a * gaussianF32(offset, in.uniformScale);
+
+   let pixel = vec2<u32>(in.position.xy);
+   let threshold = hashToUnit(pcgHash(pixel.x ^ pcgHash(pixel.y ^ pcgHash(in.instance ^ pcgHash(uUniforms.frameIndex)))));
+   if (alpha <= threshold) {
+      discard;
+   }
+   return vec4<f32>(color.rgb, 1.0);
+}
+
+// Maps a thread of the transform and SH passes to a splat of the visible chunks.
+fn visibleSplatIndex(id: u32) -> u32 {
+   let chunk = id / CHUNK_SIZE;
+   if (chunk >= uUniforms.visibleChunkCount) {
+      return INVALID_INDEX;
+   }
+
+#if CHUNK_CULLING
+   let index = visibleChunks[chunk] * CHUNK_SIZE + id % CHUNK_SIZE;
+#else
+   // Without culling the visible chunks are all source chunks in order.
+   let index = id;
+#endif
+   return select(INVALID_INDEX, index, index < arrayLength(&splats));
+}
+
 // Calculates gaussian
 fn gaussianF32(x: f32, sigma: f32) -> f32 {
    return exp(-0.5 * x * x * 1 / sigma);
 }
 
+// Reads the RGB triplet of the k-th (k >= 1) SH coefficient from the packed half floats.
+fn shCoefficient(index: u32, k: u32) -> vec3<f32> {
+   let base = index * uUniforms.shWordsPerSplat;
+   let h = (k - 1u) * 3u;
+   return vec3<f32>(shHalf(base, h), shHalf(base, h + 1u), shHalf(base, h + 2u));
+}
+
+fn shHalf(base: u32, h: u32) -> f32 {
+   let pair = unpack2x16float(shCoefficients[base + h / 2u]);
+   return select(pair.x, pair.y, (h & 1u) == 1u);
+}
+
+// PCG hash (Jarzynski and Olano 2020).
+fn pcgHash(value: u32) -> u32 {
+   let state = value * 747796405u + 2891336453u;
+   let word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+   return (word >> 22u) ^ word;
+}
+
+// Uniform value in [0, 1) from the upper 24 bits of a hash.
+fn hashToUnit(hash: u32) -> f32 {
+   return f32(hash >> 8u) / 16777216.0;
+}
+
+fn packColor(color: vec4<f32>) -> u32 {
+   let bytes = vec4<u32>(round(clamp(color, vec4<f32>(0.0), vec4<f32>(1.0)) * 255.0));
+   return (bytes.r << 24) | (bytes.g << 16) | (bytes.b << 8) | bytes.a;
+}
+
 fn unpackColor(packed: u32) -> vec4<f32> {
    return vec4<f32>(
       f32((packed >> 24) & 0xFF) / 255.0,
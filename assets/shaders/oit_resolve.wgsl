@@ -0,0 +1,31 @@
+struct VertexOutput {
+    @builtin(position) position: vec4<f32>
+};
+
+@group(0) @binding(0)
+var accumTexture: texture_2d<f32>;
+
+@group(0) @binding(1)
+var revealTexture: texture_2d<f32>;
+
+// Single triangle covering the whole screen.
+@vertex
+fn vs_main(@builtin(vertex_index) index: u32) -> VertexOutput {
+   let uv = vec2<f32>(f32((index << 1u) & 2u), f32(index & 2u));
+
+   var output: VertexOutput;
+   output.position = vec4<f32>(uv.x * 2.0 - 1.0, 1.0 - uv.y * 2.0, 0.0, 1.0);
+   return output;
+}
+
+// Weighted average color of the splats covering the pixel, blended over the background with the
+// total coverage. The targets have the same size as the scene texture, so pixels map one to one.
+@fragment
+fn fs_main(in: VertexOutput) -> @location(0) vec4f {
+   let pixel = vec2<i32>(in.position.xy);
+   let accum = textureLoad(accumTexture, pixel, 0);
+   let reveal = textureLoad(revealTexture, pixel, 0).r;
+
+   let color = accum.rgb / clamp(accum.a, 1e-4, 5e4);
+   return vec4<f32>(color, 1.0 - reveal);
+}
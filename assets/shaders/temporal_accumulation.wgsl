@@ -0,0 +1,69 @@
+struct TemporalUniforms {
+    reprojection: mat4x4<f32>, // Current NDC to previous clip space
+    renderSize: vec2<f32>,     // Rendered size in pixels
+    movingHistory: f32,        // Frames of history kept for pixels that moved
+    maxHistory: f32,           // Frames of history kept for static pixels
+    reset: u32                 // Discards the history, set when it does not match the view
+};
+
+struct VertexOutput {
+    @builtin(position) position: vec4<f32>
+};
+
+struct TemporalOutput {
+    @location(0) history: vec4<f32>, // Accumulated color and number of accumulated frames
+    @location(1) color: vec4<f32>    // Displayed color
+};
+
+@group(0) @binding(0)
+var currentTexture: texture_2d<f32>;
+
+@group(0) @binding(1)
+var depthTexture: texture_depth_2d;
+
+@group(0) @binding(2)
+var historyTexture: texture_2d<f32>;
+
+@group(1) @binding(0)
+var<uniform> uTemporal: TemporalUniforms;
+
+// Single triangle covering the whole screen.
+@vertex
+fn vs_main(@builtin(vertex_index) index: u32) -> VertexOutput {
+   let uv = vec2<f32>(f32((index << 1u) & 2u), f32(index & 2u));
+
+   var output: VertexOutput;
+   output.position = vec4<f32>(uv.x * 2.0 - 1.0, 1.0 - uv.y * 2.0, 0.0, 1.0);
+   return output;
+}
+
+// Running average of the stochastic frames. The history is reprojected with the depth of the nearest kept
+// splat and limited to a few frames where the view moved, so it converges while the camera is static.
+@fragment
+fn fs_main(in: VertexOutput) -> TemporalOutput {
+   let pixel = vec2<i32>(in.position.xy);
+   let current = textureLoad(currentTexture, pixel, 0).rgb;
+
+   var history = vec4<f32>(0.0);
+   if (uTemporal.reset == 0u) {
+      let uv = in.position.xy / uTemporal.renderSize;
+      let depth = textureLoad(depthTexture, pixel, 0);
+      let previousClip = uTemporal.reprojection * vec4<f32>(uv.x * 2.0 - 1.0, 1.0 - uv.y * 2.0, depth, 1.0);
+      let previousUv = vec2<f32>(previousClip.x, -previousClip.y) / previousClip.w * 0.5 + 0.5;
+
+      // Nearest history pixel, the history is a float target without filtering.
+      if (previousClip.w > 0.0 && all(previousUv >= vec2<f32>(0.0)) && all(previousUv < vec2<f32>(1.0))) {
+         history = textureLoad(historyTexture, vec2<i32>(previousUv * uTemporal.renderSize), 0);
+         let motion = length((previousUv - uv) * uTemporal.renderSize);
+         history.a = min(history.a, select(uTemporal.maxHistory, uTemporal.movingHistory, motion > 0.01));
+      }
+   }
+
+   let count = history.a + 1.0;
+   let color = mix(history.rgb, current, 1.0 / count);
+
+   var output: TemporalOutput;
+   output.history = vec4<f32>(color, count);
+   output.color = vec4<f32>(color, 1.0);
+   return output;
+}
@@ -0,0 +1,34 @@
+struct UpscaleUniforms {
+    uvScale: vec2<f32> // Part of the scene texture covered by the rendered image
+};
+
+struct VertexOutput {
+    @builtin(position) position: vec4<f32>,
+    @location(0) uv: vec2<f32>
+};
+
+@group(0) @binding(0)
+var sceneTexture: texture_2d<f32>;
+
+@group(0) @binding(1)
+var sceneSampler: sampler;
+
+@group(0) @binding(2)
+var<uniform> uUpscale: UpscaleUniforms;
+
+// Single triangle covering the whole screen.
+@vertex
+fn vs_main(@builtin(vertex_index) index: u32) -> VertexOutput {
+   let uv = vec2<f32>(f32((index << 1u) & 2u), f32(index & 2u));
+
+   var output: VertexOutput;
+   output.position = vec4<f32>(uv.x * 2.0 - 1.0, 1.0 - uv.y * 2.0, 0.0, 1.0);
+   output.uv = uv * uUpscale.uvScale;
+   return output;
+}
+
+// Bilinear upscale of the rendered region.
+@fragment
+fn fs_main(in: VertexOutput) -> @location(0) vec4f {
+   return vec4<f32>(textureSample(sceneTexture, sceneSampler, in.uv).rgb, 1.0);
+}
@@ -6,13 +6,23 @@
 #include <Application/Renderer.h>
 #include <Application/Camera.h>
 #include <Application/InputManager.h>
+#include <Application/UiEventQueue.h>
 #include <Utils/FileReader.h>
+#include <Utils/Tracer.h>
 
-#include "imgui.h"
+#include <cstdlib>
 
 bool Application::Initialize() {
    _filename = "../../../assets/splats/nike.splat";
 
+   // Setting GS_TRACE to a file path records the startup and frames and writes a Chrome trace on exit.
+   if (const char* tracePath = std::getenv("GS_TRACE")) {
+      _tracePath = tracePath;
+      Tracer::GetInstance().SetEnabled(true);
+   }
+   Tracer::GetInstance().SetThreadName("Main");
+   TRACE_SCOPE("Application::Initialize");
+
    // Open window.
    if (!glfwInit()) {
       std::cerr << "Could not initialize GLFW!" << std::endl;
@@ -29,6 +39,7 @@ bool Application::Initialize() {
 
    // Initialize input manager.
    InputManager::GetInstance().Initialize(_window);
+   UiEventQueue::GetInstance().Install(_window);
 
    if (!InitializeRenderer())
    {
@@ -51,50 +62,79 @@ void Application::Terminate() const {
    delete _renderer;
    delete _camera;
    glfwDestroyWindow(_window);
+
+   if (!_tracePath.empty()) {
+      Tracer::GetInstance().Export(_tracePath);
+   }
 }
 
 void Application::Run() {
+   _running = true;
+   _cameraSnapshots.Write(*_camera);
+   _renderThread = std::thread(&Application::RenderLoop, this);
+
    double lastTime = glfwGetTime();
-   while (IsRunning()) {
+   while (IsRunning() && _running) {
+      TRACE_SCOPE("Input");
+      // Wakes up for events, or often enough to move the camera smoothly while keys are held.
+      glfwWaitEventsTimeout(InputInterval);
       const double currentTime = glfwGetTime();
       const float dt = static_cast<float>(currentTime - lastTime);
       lastTime = currentTime;
 
-      glfwPollEvents();
-
       InputManager::GetInstance().Update();
-
-      bool imguiMouseCaptured = ImGui::GetIO().WantCaptureMouse;
-      if (!imguiMouseCaptured)
+      CameraPose playbackPose;
+      if (_playbackPoses.Read(playbackPose))
       {
-         if (_renderer->FreeCamera)
+         _camera->SetPose(playbackPose);
+      }
+      if (!UiEventQueue::GetInstance().WantsCaptureMouse())
+      {
+         if (_freeCamera)
          {
-            _camera->UpdateCameraFree(dt);
+            _camera->UpdateCameraFree();
          }
          else
          {
             _camera->UpdateCameraOrbit(dt);
          }
       }
+      _cameraSnapshots.Write(*_camera);
+   }
 
-      _renderer->Render(*_camera);
+   _running = false;
+   _renderThread.join();
+}
+
+void Application::RenderLoop() {
+   Tracer::GetInstance().SetThreadName("Render");
+   Camera camera = *_camera;
+   double lastTime = glfwGetTime();
+   while (_running) {
+      TRACE_SCOPE("Frame");
+      const double currentTime = glfwGetTime();
+      const float dt = static_cast<float>(currentTime - lastTime);
+      lastTime = currentTime;
 
-      // Check if file change.
-      if (_renderer->ChangeSplatsFlag)
+      // Keeps the previous camera when the main thread has not moved it since the last frame.
+      _cameraSnapshots.Read(camera);
+      // Playback ignores the input and steps by a fixed time instead of dt.
+      if (_cameraPath.IsPlaying())
       {
-         _renderer->ChangeSplatsFlag = false;
-         std::string filename = std::string("../../../assets/splats/") + std::string(_renderer->SelectedFile);
-         _filename = filename.c_str();
-         _selectedFileIndex = _renderer->SelectedFileIndex;
-         _renderer->Terminate();
-         delete _renderer;
-         if (!InitializeRenderer())
+         _cameraPath.Advance(camera);
+         // The frame that ends playback is not posed by the path.
+         if (_cameraPath.IsPlaying())
          {
-            return;
+            _playbackPoses.Write(camera.GetPose());
          }
-
-         _renderer->SelectedFileIndex = _selectedFileIndex;
       }
+      else
+      {
+         _cameraPath.Record(dt, camera);
+      }
+
+      _renderer->Render(camera);
+      _freeCamera = _renderer->FreeCamera;
    }
 }
 
@@ -104,8 +144,10 @@ bool Application::IsRunning() const {
 
 bool Application::InitializeRenderer()
 {
+   TRACE_SCOPE("Application::InitializeRenderer");
    // Initialize renderer.
    _renderer = new Renderer();
+   _renderer->Path = &_cameraPath;
    const bool success = _renderer->Initialize(_window, _windowWidth, _windowHeight, _filename);
    if (!success) {
       std::cerr << "Could not initialize renderer!" << std::endl;
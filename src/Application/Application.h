@@ -1,8 +1,15 @@
 #pragma once
 
+#include <Core/Core.h>
+#include <Application/Camera.h>
+#include <Application/CameraPath.h>
+#include <Utils/TripleBuffer.h>
+
+#include <atomic>
+#include <thread>
+
 struct GLFWwindow;
 class Renderer;
-class Camera;
 
 class Application {
 private:
@@ -12,9 +19,22 @@ private:
    GLFWwindow *_window = nullptr;
    Renderer *_renderer = nullptr;
    Camera *_camera = nullptr;
+   // Render thread only. The renderer UI records and plays it.
+   CameraPath _cameraPath;
+
+   // The main thread handles window events and moves the camera, the render thread renders the latest camera
+   // it received and runs the UI. A slow frame never blocks event processing, scenes load in the background.
+   std::thread _renderThread;
+   TripleBuffer<Camera> _cameraSnapshots;
+   // Poses of camera path playback, adopted by the main camera so the view stays where playback left it.
+   TripleBuffer<CameraPose> _playbackPoses;
+   std::atomic<bool> _running = false;
+   // Camera mode selected in the renderer UI, read by the main thread.
+   std::atomic<bool> _freeCamera = false;
 
    const char* _filename = nullptr;
-   int _selectedFileIndex = 0;
+   // Written on exit when tracing was enabled at startup.
+   std::string _tracePath;
 
 public:
    bool Initialize();
@@ -28,4 +48,9 @@ public:
 
 private:
    bool InitializeRenderer();
+
+   // Interval of camera updates on the main thread while no events arrive, in seconds.
+   static constexpr double InputInterval = 1.0 / 240.0;
+
+   void RenderLoop();
 };
@@ -0,0 +1,120 @@
+#include <GaussianSplatting.h>
+#include <Application/Autotuner.h>
+
+#include <iomanip>
+#include <random>
+#include <sstream>
+
+const char* SortAlgorithmNames[SORT_ALGORITHM_COUNT] = { "global", "shared" };
+
+std::vector<TuningConfig> Autotuner::GetCandidates() {
+   std::vector<TuningConfig> candidates;
+   for (u32 workGroupSize : { 64u, 128u, 256u }) {
+      candidates.push_back({ workGroupSize, SORT_ALGORITHM_GLOBAL, 2 });
+      for (u32 keysPerThread : { 2u, 4u }) {
+         candidates.push_back({ workGroupSize, SORT_ALGORITHM_SHARED, keysPerThread });
+      }
+   }
+   return candidates;
+}
+
+AdapterProfile Autotuner::GetAdapterProfile(WGPUAdapter adapter) {
+   WGPUAdapterProperties properties = {};
+   wgpuAdapterGetProperties(adapter, &properties);
+
+   std::ostringstream fileName;
+   fileName << std::hex << std::setfill('0') << std::setw(4) << properties.vendorID << "-" << std::setw(4) << properties.deviceID
+            << "-" << std::dec << static_cast<u32>(properties.backendType) << ".txt";
+
+   AdapterProfile profile;
+   profile.path = std::filesystem::path("../../../assets/profiles") / fileName.str();
+   profile.adapterName = properties.name ? properties.name : "Unknown adapter";
+   return profile;
+}
+
+bool Autotuner::LoadProfile(const AdapterProfile& profile, TuningConfig& config) {
+   std::ifstream file(profile.path);
+   if (!file.is_open()) {
+      return false;
+   }
+
+   TuningConfig loaded;
+   std::string line;
+   while (std::getline(file, line)) {
+      size_t separator = line.find('=');
+      if (line.empty() || line[0] == '#' || separator == std::string::npos) {
+         continue;
+      }
+
+      std::string key = line.substr(0, separator);
+      std::string value = line.substr(separator + 1);
+      if (key == "workGroupSize") {
+         loaded.workGroupSize = static_cast<u32>(std::strtoul(value.c_str(), nullptr, 10));
+      } else if (key == "sortAlgorithm") {
+         loaded.sortAlgorithm = value == SortAlgorithmNames[SORT_ALGORITHM_SHARED] ? SORT_ALGORITHM_SHARED : SORT_ALGORITHM_GLOBAL;
+      } else if (key == "keysPerThread") {
+         loaded.keysPerThread = static_cast<u32>(std::strtoul(value.c_str(), nullptr, 10));
+      }
+   }
+
+   // Only configurations the shader is built for.
+   bool valid = (loaded.workGroupSize == 64 || loaded.workGroupSize == 128 || loaded.workGroupSize == 256) &&
+                (loaded.keysPerThread == 2 || loaded.keysPerThread == 4);
+   if (!valid) {
+      std::cerr << "Ignoring invalid tuning profile: " << profile.path << std::endl;
+      return false;
+   }
+
+   config = loaded;
+   std::cout << "Loaded tuning profile for " << profile.adapterName << ": " << ToString(config) << std::endl;
+   return true;
+}
+
+bool Autotuner::SaveProfile(const AdapterProfile& profile, const TuningConfig& config, const std::vector<TuningResult>& results) {
+   std::error_code error;
+   std::filesystem::create_directories(profile.path.parent_path(), error);
+   std::ofstream file(profile.path, std::ios::trunc);
+   if (!file.is_open()) {
+      std::cerr << "Failed to create tuning profile: " << profile.path << std::endl;
+      return false;
+   }
+
+   file << "# " << profile.adapterName << "\n";
+   file << "workGroupSize=" << config.workGroupSize << "\n";
+   file << "sortAlgorithm=" << SortAlgorithmNames[config.sortAlgorithm] << "\n";
+   file << "keysPerThread=" << config.keysPerThread << "\n";
+   file << std::fixed << std::setprecision(3);
+   for (const TuningResult& result : results) {
+      file << "# " << ToString(result.config) << ": " << result.time << " ms\n";
+   }
+
+   if (!file.good()) {
+      std::cerr << "Failed to write tuning profile: " << profile.path << std::endl;
+      return false;
+   }
+   std::cout << "Wrote tuning profile " << profile.path << std::endl;
+   return true;
+}
+
+std::string Autotuner::ToString(const TuningConfig& config) {
+   std::string text = std::to_string(config.workGroupSize) + " threads, " + SortAlgorithmNames[config.sortAlgorithm] + " sort";
+   if (config.sortAlgorithm == SORT_ALGORITHM_SHARED) {
+      text += ", " + std::to_string(config.keysPerThread) + " keys per thread";
+   }
+   return text;
+}
+
+void Autotuner::CreateSyntheticSplats(u32 count, std::vector<Splat>& splats) {
+   std::mt19937 random(1234);
+   std::uniform_real_distribution<float> position(-0.5f, 0.5f);
+   std::uniform_int_distribution<u32> color(0, 0xFFFFFFFFu);
+
+   splats.resize(count);
+   for (Splat& splat : splats) {
+      splat.position = f32vec4(position(random), position(random), position(random), 1.0f);
+      splat.scale = f32vec4(0.01f, 0.01f, 0.01f, 0.0f);
+      // Opaque enough to pass the default alpha threshold, so every splat is sorted and drawn.
+      splat.color = color(random) | 0x80u;
+      splat.rotation = 0;
+   }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <Core/Core.h>
+#include <Utils/FileReader.h>
+#include <Utils/SortSchedule.h>
+#include <webgpu/webgpu.h>
+
+// Kernel configuration chosen per adapter, selects the shader permutation and the sort schedule.
+struct TuningConfig {
+   u32 workGroupSize = 256; // 64, 128 or 256.
+   ESortAlgorithm sortAlgorithm = SORT_ALGORITHM_GLOBAL;
+   u32 keysPerThread = 2; // 2 or 4, only used by the shared sort.
+
+   bool operator==(const TuningConfig& other) const = default;
+};
+
+// Benchmarked time of the transform, sort and splat passes of one candidate.
+struct TuningResult {
+   TuningConfig config;
+   float time = 0.0f; // Milliseconds per frame, median of the measured runs.
+};
+
+// Tuning profile file of one adapter, identified by vendor, device and backend.
+struct AdapterProfile {
+   std::filesystem::path path;
+   std::string adapterName;
+};
+
+// Candidates and per adapter profiles of the autotuner. The benchmark itself runs in the renderer,
+// which owns the pipelines and buffers of the passes being measured.
+class Autotuner {
+public:
+   // Keys sorted by the synthetic benchmark scene.
+   static constexpr u32 SyntheticSplatCount = 1 << 18;
+   // Largest block of the shared sort, the sort capacity is never below it.
+   static constexpr u32 MaxSortBlockSize = 256 * 4;
+
+   static std::vector<TuningConfig> GetCandidates();
+
+   static AdapterProfile GetAdapterProfile(WGPUAdapter adapter);
+
+   // Returns false when there is no profile or it is malformed, config is left unchanged then.
+   static bool LoadProfile(const AdapterProfile& profile, TuningConfig& config);
+
+   // Writes the winning config followed by the time of every candidate as comments.
+   static bool SaveProfile(const AdapterProfile& profile, const TuningConfig& config, const std::vector<TuningResult>& results);
+
+   static std::string ToString(const TuningConfig& config);
+
+   // Uniformly scattered splats in a unit cube around the origin, seeded so every run sees the same data.
+   static void CreateSyntheticSplats(u32 count, std::vector<Splat>& splats);
+};
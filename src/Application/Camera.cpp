@@ -4,30 +4,17 @@
 #include <Application/InputManager.h>
 #include <Utils/FileReader.h>
 
-void Camera::UpdateCameraFree(float dt) {
-   if (InputManager::IsInputDown(KEY_LEFT_ALT) || InputManager::IsInputDown(MOUSE_BUTTON_RIGHT)) {
+void Camera::UpdateCameraFree() {
+   // Also moves for a modifier released since the last update, its keys were held while it was down.
+   if (InputManager::IsInputDown(KEY_LEFT_ALT) || InputManager::IsInputDown(MOUSE_BUTTON_RIGHT) ||
+       InputManager::GetHeldTime(KEY_LEFT_ALT) > 0.0f || InputManager::GetHeldTime(MOUSE_BUTTON_RIGHT) > 0.0f) {
       vec3 worldUp = vec3(0.0f, 1.0f, 0.0f);
       vec3 right = normalize(cross(worldUp, _forward));
 
-      // Movement
-      if (InputManager::IsInputDown(KEY_W)) {
-         _position += _speed * _forward * dt;
-      }
-      if (InputManager::IsInputDown(KEY_S)) {
-         _position -= _speed * _forward * dt;
-      }
-      if (InputManager::IsInputDown(KEY_A)) {
-         _position -= _speed * right * dt;
-      }
-      if (InputManager::IsInputDown(KEY_D)) {
-         _position += _speed * right * dt;
-      }
-      if (InputManager::IsInputDown(KEY_E)) {
-         _position += _speed * _up * dt;
-      }
-      if (InputManager::IsInputDown(KEY_Q)) {
-         _position -= _speed * _up * dt;
-      }
+      // Movement, by the time each key was held since the last update rather than the whole frame time.
+      _position += _speed * _forward * (InputManager::GetHeldTime(KEY_W) - InputManager::GetHeldTime(KEY_S));
+      _position += _speed * right * (InputManager::GetHeldTime(KEY_D) - InputManager::GetHeldTime(KEY_A));
+      _position += _speed * _up * (InputManager::GetHeldTime(KEY_E) - InputManager::GetHeldTime(KEY_Q));
 
       // Rotation
       // Get pitch and yaw angle
@@ -64,9 +51,9 @@ void Camera::UpdateCameraOrbit(float dt) {
       _position = _target - _forward * _distance;
    }
 
-   float zoomInput = static_cast<float>(InputManager::IsInputDown(KEY_R)) - static_cast<float>(InputManager::IsInputDown(KEY_F));
+   float zoomInput = InputManager::GetHeldTime(KEY_R) - InputManager::GetHeldTime(KEY_F);
    if (zoomInput != 0.0f) {
-      _distance = clamp(_distance - zoomInput * dt * _zoomSpeed, _minDistance, _maxDistance);
+      _distance = clamp(_distance - zoomInput * _zoomSpeed, _minDistance, _maxDistance);
       _position = _target - _forward * _distance;
    }
 }
@@ -89,3 +76,13 @@ void Camera::CalculateOrbit() {
 
    _position = _target - _forward * _distance;
 }
+
+void Camera::SetPose(const CameraPose &pose) {
+   _position = pose.position;
+   _forward = normalize(pose.orientation * vec3(0.0f, 0.0f, -1.0f));
+   _up = normalize(pose.orientation * vec3(0.0f, 1.0f, 0.0f));
+
+   _yaw = atan2(_forward.z, _forward.x);
+   _pitch = asin(clamp(_forward.y, -1.0f, 1.0f));
+   _target = _position + _forward * _distance;
+}
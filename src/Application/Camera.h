@@ -3,6 +3,12 @@
 struct Splat;
 struct GLFWwindow;
 
+// Position and orientation of the camera, the orientation looks down -Z with +Y up.
+struct CameraPose {
+   vec3 position = vec3(0.0f);
+   quat orientation = quat(1.0f, 0.0f, 0.0f, 0.0f);
+};
+
 class Camera {
 private:
    vec3 _position;
@@ -47,7 +53,8 @@ public:
    {
    }
 
-   void UpdateCameraFree(float dt);
+   // Moves by the held time of each key, so it needs no frame time.
+   void UpdateCameraFree();
 
    void UpdateCameraOrbit(float dt);
 
@@ -73,6 +80,13 @@ public:
       CalculateOrbit();
    }
 
+   CameraPose GetPose() const {
+      return { _position, quatLookAt(_forward, _up) };
+   }
+
+   // Moves the camera without input, the orbit continues around the point in front of the pose.
+   void SetPose(const CameraPose &pose);
+
 private:
    void CalculateOrbit();
 };
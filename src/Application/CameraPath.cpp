@@ -0,0 +1,148 @@
+#include <GaussianSplatting.h>
+#include <Application/CameraPath.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+void CameraPath::StartRecording(const Camera& camera) {
+   _playing = false;
+   _recording = true;
+   _recordTime = 0.0f;
+   _keyframes.clear();
+   _keyframes.push_back({ 0.0f, camera.GetPose() });
+}
+
+void CameraPath::Record(float dt, const Camera& camera) {
+   if (!_recording) {
+      return;
+   }
+   _recordTime += dt;
+   if (_recordTime - _keyframes.back().time >= KeyframeInterval) {
+      _keyframes.push_back({ _recordTime, camera.GetPose() });
+   }
+}
+
+void CameraPath::StopRecording(const Camera& camera) {
+   if (!_recording) {
+      return;
+   }
+   _recording = false;
+   if (_recordTime > _keyframes.back().time) {
+      _keyframes.push_back({ _recordTime, camera.GetPose() });
+   }
+}
+
+bool CameraPath::StartPlayback() {
+   if (_keyframes.size() < 2) {
+      return false;
+   }
+   _recording = false;
+   _playing = true;
+   _playbackFrame = 0;
+   return true;
+}
+
+void CameraPath::Advance(Camera& camera) {
+   // Computed from the frame number, accumulating the step would drift between runs of different length.
+   float time = static_cast<float>(_playbackFrame) * FixedTimeStep;
+   if (!_playing || time > GetDuration()) {
+      _playing = false;
+      return;
+   }
+   camera.SetPose(Sample(time));
+   ++_playbackFrame;
+}
+
+CameraPose CameraPath::Sample(float time) const {
+   if (_keyframes.empty()) {
+      return {};
+   }
+   if (time <= _keyframes.front().time) {
+      return _keyframes.front().pose;
+   }
+   if (time >= _keyframes.back().time) {
+      return _keyframes.back().pose;
+   }
+
+   // Segment between keyframes i and i + 1, the neighbours outside the path are clamped to its ends.
+   auto next = std::upper_bound(_keyframes.begin(), _keyframes.end(), time,
+      [](float value, const CameraKeyframe& keyframe) { return value < keyframe.time; });
+   size_t i = static_cast<size_t>(next - _keyframes.begin()) - 1;
+   const CameraKeyframe& k0 = _keyframes[i > 0 ? i - 1 : 0];
+   const CameraKeyframe& k1 = _keyframes[i];
+   const CameraKeyframe& k2 = _keyframes[i + 1];
+   const CameraKeyframe& k3 = _keyframes[std::min(i + 2, _keyframes.size() - 1)];
+   float t = (time - k1.time) / std::max(k2.time - k1.time, 1e-6f);
+   float t2 = t * t;
+   float t3 = t2 * t;
+
+   const vec3& p0 = k0.pose.position;
+   const vec3& p1 = k1.pose.position;
+   const vec3& p2 = k2.pose.position;
+   const vec3& p3 = k3.pose.position;
+   CameraPose pose;
+   pose.position = 0.5f * (2.0f * p1 + (p2 - p0) * t + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 + (3.0f * p1 - p0 - 3.0f * p2 + p3) * t3);
+   pose.orientation = normalize(slerp(k1.pose.orientation, k2.pose.orientation, t));
+   return pose;
+}
+
+bool CameraPath::Save(const std::filesystem::path& path) const {
+   std::error_code error;
+   std::filesystem::create_directories(path.parent_path(), error);
+   std::ofstream file(path, std::ios::trunc);
+   if (!file.is_open()) {
+      std::cerr << "Failed to create camera path: " << path << std::endl;
+      return false;
+   }
+
+   file << "# time px py pz qw qx qy qz\n";
+   file << std::setprecision(9);
+   for (const CameraKeyframe& keyframe : _keyframes) {
+      const vec3& p = keyframe.pose.position;
+      const quat& q = keyframe.pose.orientation;
+      file << keyframe.time << " " << p.x << " " << p.y << " " << p.z << " " << q.w << " " << q.x << " " << q.y << " " << q.z << "\n";
+   }
+
+   if (!file.good()) {
+      std::cerr << "Failed to write camera path: " << path << std::endl;
+      return false;
+   }
+   std::cout << "Wrote camera path " << path << " with " << _keyframes.size() << " keyframes" << std::endl;
+   return true;
+}
+
+bool CameraPath::Load(const std::filesystem::path& path) {
+   std::ifstream file(path);
+   if (!file.is_open()) {
+      std::cerr << "Failed to open camera path: " << path << std::endl;
+      return false;
+   }
+
+   std::vector<CameraKeyframe> keyframes;
+   std::string line;
+   while (std::getline(file, line)) {
+      if (line.empty() || line[0] == '#') {
+         continue;
+      }
+
+      std::istringstream stream(line);
+      CameraKeyframe keyframe;
+      vec3& p = keyframe.pose.position;
+      quat& q = keyframe.pose.orientation;
+      stream >> keyframe.time >> p.x >> p.y >> p.z >> q.w >> q.x >> q.y >> q.z;
+      // Keyframes must be in time order for the segment search.
+      if (stream.fail() || (!keyframes.empty() && keyframe.time <= keyframes.back().time)) {
+         std::cerr << "Invalid camera path keyframe in " << path << ": " << line << std::endl;
+         return false;
+      }
+      q = normalize(q);
+      keyframes.push_back(keyframe);
+   }
+
+   _keyframes = std::move(keyframes);
+   _recording = false;
+   _playing = false;
+   std::cout << "Loaded camera path " << path << " with " << _keyframes.size() << " keyframes" << std::endl;
+   return true;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <Core/Core.h>
+#include <Application/Camera.h>
+
+struct CameraKeyframe {
+   float time = 0.0f; // Seconds since the start of the path.
+   CameraPose pose;
+};
+
+// Recorded camera motion replayed at a fixed timestep. Recording samples the live camera at a fixed
+// interval of wall clock time, playback advances by FixedTimeStep per rendered frame regardless of how
+// long the frame took, so every replay renders the exact same sequence of views.
+class CameraPath {
+public:
+   static constexpr float KeyframeInterval = 0.1f;
+   static constexpr float FixedTimeStep = 1.0f / 60.0f;
+
+private:
+   std::vector<CameraKeyframe> _keyframes;
+   bool _recording = false;
+   bool _playing = false;
+   float _recordTime = 0.0f;
+   u32 _playbackFrame = 0;
+
+public:
+   void StartRecording(const Camera& camera);
+
+   // Adds a keyframe once KeyframeInterval passed since the last one.
+   void Record(float dt, const Camera& camera);
+
+   // The final pose is always kept so the path ends where the recording stopped.
+   void StopRecording(const Camera& camera);
+
+   [[nodiscard]] bool IsRecording() const { return _recording; }
+
+   // Returns false without at least two keyframes.
+   bool StartPlayback();
+
+   void StopPlayback() { _playing = false; }
+
+   [[nodiscard]] bool IsPlaying() const { return _playing; }
+
+   // Poses the camera for the current playback frame and steps to the next one, playback stops after the last keyframe.
+   void Advance(Camera& camera);
+
+   // Catmull-Rom spline through the positions, orientations are interpolated with slerp.
+   [[nodiscard]] CameraPose Sample(float time) const;
+
+   [[nodiscard]] float GetDuration() const { return _keyframes.empty() ? 0.0f : _keyframes.back().time; }
+
+   [[nodiscard]] u32 GetPlaybackFrame() const { return _playbackFrame; }
+
+   [[nodiscard]] u32 GetFrameCount() const { return static_cast<u32>(std::floor(GetDuration() / FixedTimeStep)) + 1; }
+
+   [[nodiscard]] const std::vector<CameraKeyframe>& GetKeyframes() const { return _keyframes; }
+
+   // Text file with one keyframe per line: time, position and orientation quaternion (w x y z).
+   bool Save(const std::filesystem::path& path) const;
+
+   bool Load(const std::filesystem::path& path);
+};
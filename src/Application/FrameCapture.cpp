@@ -0,0 +1,229 @@
+#include <GaussianSplatting.h>
+#include <Application/FrameCapture.h>
+#include <Application/TextureReadback.h>
+#include <Utils/Parallel.h>
+#include <Utils/Tracer.h>
+
+#include "stb_image_write.h"
+
+#include <cstdio>
+#include <string>
+
+FrameCapture::~FrameCapture() {
+   Release();
+}
+
+void FrameCapture::Initialize(WGPUDevice device, u32vec2 maxSize) {
+   _device = device;
+   _maxSize = maxSize;
+   _bytesPerRow = TextureReadback::GetBytesPerRow(maxSize.x);
+   _bufferSize = static_cast<u64>(_bytesPerRow) * maxSize.y;
+
+   for (Slot& slot : _slots) {
+      slot.capture = this;
+      slot.buffer = TextureReadback::CreateBuffer(device, "Frame Capture Buffer", maxSize);
+      slot.state = SLOT_STATE_FREE;
+   }
+
+   // PNG encoding is the slow part, frames are independent so several writers share the queue.
+   _stopWriters = false;
+   size_t writerCount = std::clamp<size_t>(Parallel::GetThreadCount() / 2, 1, 4);
+   for (size_t i = 0; i < writerCount; ++i) {
+      _writers.emplace_back(&FrameCapture::WriterLoop, this);
+   }
+}
+
+void FrameCapture::Release() {
+   _capturing = false;
+   {
+      std::lock_guard lock(_mutex);
+      _stopWriters = true;
+   }
+   _condition.notify_all();
+   for (std::thread& writer : _writers) {
+      writer.join();
+   }
+   _writers.clear();
+
+   for (Slot& slot : _slots) {
+      if (slot.buffer) {
+         wgpuBufferRelease(slot.buffer);
+         slot.buffer = nullptr;
+      }
+      slot.state = SLOT_STATE_FREE;
+   }
+   _freePixels.clear();
+}
+
+bool FrameCapture::Start(const std::filesystem::path& root, ECaptureFormat format) {
+   std::error_code error;
+   for (u32 take = 0; take < 10000; ++take) {
+      char name[32];
+      snprintf(name, sizeof(name), "capture_%04u", take);
+      std::filesystem::path directory = root / name;
+      if (std::filesystem::exists(directory, error)) {
+         continue;
+      }
+      if (!std::filesystem::create_directories(directory, error)) {
+         break;
+      }
+
+      _directory = directory;
+      _format = format;
+      _nextFrame = 0;
+      _droppedFrames = 0;
+      _writtenFrames = 0;
+      _failedFrames = 0;
+      _capturing = true;
+      std::cout << "Capturing frames to " << _directory << std::endl;
+      return true;
+   }
+
+   std::cerr << "Failed to create capture directory in " << root << std::endl;
+   return false;
+}
+
+void FrameCapture::Stop() {
+   if (_capturing) {
+      std::cout << "Captured " << _nextFrame << " frames to " << _directory << ", " << _droppedFrames << " dropped" << std::endl;
+   }
+   _capturing = false;
+}
+
+bool FrameCapture::EncodeCopy(WGPUCommandEncoder encoder, WGPUTexture texture, u32vec2 size, bool wait) {
+   if (!_capturing || size.x > _maxSize.x || size.y > _maxSize.y) {
+      return false;
+   }
+
+   Slot& slot = _slots[_nextSlot];
+   if (wait) {
+      TRACE_SCOPE("FrameCapture::Wait");
+      // The map callbacks of earlier frames free the slot and queue their jobs.
+      while (slot.state == SLOT_STATE_MAPPING) {
+         wgpuDevicePoll(_device, true, nullptr);
+      }
+      std::unique_lock lock(_mutex);
+      _jobTaken.wait(lock, [this]() { return _jobs.size() < MaxQueuedFrames; });
+   }
+
+   // Otherwise dropping here keeps the frame loop from ever waiting on a map or on the writers.
+   bool writersBehind = false;
+   {
+      std::lock_guard lock(_mutex);
+      writersBehind = _jobs.size() >= MaxQueuedFrames;
+   }
+   if (slot.state != SLOT_STATE_FREE || writersBehind) {
+      ++_droppedFrames;
+      return false;
+   }
+
+   TextureReadback::EncodeCopy(encoder, texture, slot.buffer, size, _bytesPerRow);
+
+   slot.state = SLOT_STATE_ENCODED;
+   slot.frameNumber = _nextFrame++;
+   slot.size = size;
+   _nextSlot = (_nextSlot + 1) % SlotCount;
+   return true;
+}
+
+void FrameCapture::ReadBack() {
+   auto onMapped = [](WGPUBufferMapAsyncStatus status, void* userData) {
+      auto* slot = static_cast<Slot*>(userData);
+      slot->capture->OnMapped(*slot, status);
+   };
+   for (Slot& slot : _slots) {
+      if (slot.state == SLOT_STATE_ENCODED) {
+         slot.state = SLOT_STATE_MAPPING;
+         wgpuBufferMapAsync(slot.buffer, WGPUMapMode_Read, 0, _bufferSize, onMapped, &slot);
+      }
+   }
+}
+
+void FrameCapture::OnMapped(Slot& slot, WGPUBufferMapAsyncStatus status) {
+   TRACE_SCOPE("FrameCapture::OnMapped");
+   slot.state = SLOT_STATE_FREE;
+   if (status != WGPUBufferMapAsyncStatus_Success) {
+      _failedFrames.fetch_add(1, std::memory_order_relaxed);
+      return;
+   }
+
+   Job job;
+   {
+      std::lock_guard lock(_mutex);
+      if (!_freePixels.empty()) {
+         job.pixels = std::move(_freePixels.back());
+         _freePixels.pop_back();
+      }
+   }
+
+   // Only the unpadded rows are copied, the staging buffer is unmapped right away.
+   const u8* mapped = static_cast<const u8*>(wgpuBufferGetConstMappedRange(slot.buffer, 0, _bufferSize));
+   if (mapped != nullptr) {
+      TextureReadback::UnpadRows(mapped, _bytesPerRow, slot.size, job.pixels);
+   }
+   wgpuBufferUnmap(slot.buffer);
+   if (mapped == nullptr) {
+      _failedFrames.fetch_add(1, std::memory_order_relaxed);
+      return;
+   }
+
+   char name[64];
+   if (_format == CAPTURE_FORMAT_PNG) {
+      snprintf(name, sizeof(name), "frame_%06u.png", slot.frameNumber);
+   } else {
+      snprintf(name, sizeof(name), "frame_%06u_%ux%u.rgba", slot.frameNumber, slot.size.x, slot.size.y);
+   }
+   job.path = _directory / name;
+   job.format = _format;
+   job.size = slot.size;
+   {
+      std::lock_guard lock(_mutex);
+      _jobs.push_back(std::move(job));
+   }
+   _condition.notify_one();
+}
+
+void FrameCapture::WriterLoop() {
+   Tracer::GetInstance().SetThreadName("Frame Writer");
+   while (true) {
+      Job job;
+      {
+         std::unique_lock lock(_mutex);
+         _condition.wait(lock, [this]() { return _stopWriters || !_jobs.empty(); });
+         // Queued frames are still written when stopping.
+         if (_jobs.empty()) {
+            return;
+         }
+         job = std::move(_jobs.front());
+         _jobs.pop_front();
+      }
+      _jobTaken.notify_one();
+
+      if (WriteFrame(job)) {
+         _writtenFrames.fetch_add(1, std::memory_order_relaxed);
+      } else {
+         _failedFrames.fetch_add(1, std::memory_order_relaxed);
+         std::cerr << "Failed to write frame: " << job.path << std::endl;
+      }
+
+      std::lock_guard lock(_mutex);
+      _freePixels.push_back(std::move(job.pixels));
+   }
+}
+
+bool FrameCapture::WriteFrame(Job& job) {
+   TRACE_SCOPE("FrameCapture::WriteFrame");
+   // The alpha of the scene texture is not shown, frames are written opaque.
+   for (size_t i = 3; i < job.pixels.size(); i += 4) {
+      job.pixels[i] = 255;
+   }
+
+   if (job.format == CAPTURE_FORMAT_PNG) {
+      return stbi_write_png(job.path.string().c_str(), static_cast<int>(job.size.x), static_cast<int>(job.size.y), 4, job.pixels.data(),
+                            static_cast<int>(job.size.x) * 4) != 0;
+   }
+
+   std::ofstream file(job.path, std::ios::binary | std::ios::trunc);
+   file.write(reinterpret_cast<const char*>(job.pixels.data()), static_cast<std::streamsize>(job.pixels.size()));
+   return file.good();
+}
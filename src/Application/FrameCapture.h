@@ -0,0 +1,121 @@
+#pragma once
+
+#include <Core/Core.h>
+#include <webgpu/webgpu.h>
+#include <webgpu/wgpu.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+// File format of captured frames.
+enum ECaptureFormat {
+   CAPTURE_FORMAT_PNG,
+   CAPTURE_FORMAT_RAW, // Tightly packed RGBA8 rows, the size is part of the file name.
+   CAPTURE_FORMAT_COUNT
+};
+
+// Captures rendered frames to an image sequence without stalling the frame loop. Frames are copied into
+// a ring of staging buffers and mapped asynchronously, the map callback hands the pixels to writer
+// threads that encode and write the files. A frame is dropped when every staging buffer is in flight
+// or the writers fall too far behind, unless the caller asks to wait for them instead.
+class FrameCapture {
+public:
+   static constexpr u32 SlotCount = 4;
+   // Frames waiting for a writer, bounds the memory held by the queue.
+   static constexpr u32 MaxQueuedFrames = 8;
+
+private:
+   enum ESlotState {
+      SLOT_STATE_FREE,
+      SLOT_STATE_ENCODED, // Copy recorded, mapped once the command buffer was submitted.
+      SLOT_STATE_MAPPING
+   };
+
+   struct Slot {
+      FrameCapture* capture = nullptr;
+      WGPUBuffer buffer = nullptr;
+      ESlotState state = SLOT_STATE_FREE;
+      u32 frameNumber = 0;
+      u32vec2 size = u32vec2{0, 0};
+   };
+
+   struct Job {
+      std::filesystem::path path;
+      ECaptureFormat format = CAPTURE_FORMAT_PNG;
+      u32vec2 size = u32vec2{0, 0};
+      std::vector<u8> pixels;
+   };
+
+   WGPUDevice _device = nullptr;
+   Slot _slots[SlotCount];
+   u32 _nextSlot = 0;
+   u32vec2 _maxSize = u32vec2{0, 0};
+   u32 _bytesPerRow = 0;
+   u64 _bufferSize = 0;
+
+   bool _capturing = false;
+   std::filesystem::path _directory;
+   ECaptureFormat _format = CAPTURE_FORMAT_PNG;
+   u32 _nextFrame = 0;
+   u32 _droppedFrames = 0;
+
+   // Shared with the writer threads.
+   std::vector<std::thread> _writers;
+   std::mutex _mutex;
+   std::condition_variable _condition;
+   std::condition_variable _jobTaken; // Signaled when a writer takes a job off the queue.
+   std::deque<Job> _jobs;
+   std::vector<std::vector<u8>> _freePixels; // Recycled pixel storage of written frames.
+   bool _stopWriters = false;
+   std::atomic<u32> _writtenFrames = 0;
+   std::atomic<u32> _failedFrames = 0;
+
+public:
+   FrameCapture() = default;
+
+   ~FrameCapture();
+
+   FrameCapture(const FrameCapture&) = delete;
+
+   FrameCapture& operator=(const FrameCapture&) = delete;
+
+   // Staging buffers hold frames up to maxSize.
+   void Initialize(WGPUDevice device, u32vec2 maxSize);
+
+   // Finishes writing queued frames, the device must be idle so no map is pending.
+   void Release();
+
+   // Starts a new sequence in the first unused numbered directory below root.
+   bool Start(const std::filesystem::path& root, ECaptureFormat format);
+
+   void Stop();
+
+   [[nodiscard]] bool IsCapturing() const { return _capturing; }
+
+   // Records a copy of the top left size pixels of an RGBA8 texture. Returns false when the frame is dropped.
+   // With wait set, blocks until a staging buffer and queue space are free instead of dropping the frame.
+   bool EncodeCopy(WGPUCommandEncoder encoder, WGPUTexture texture, u32vec2 size, bool wait = false);
+
+   // Starts mapping the copies recorded this frame, call after the command buffer was submitted.
+   void ReadBack();
+
+   [[nodiscard]] const std::filesystem::path& GetDirectory() const { return _directory; }
+
+   [[nodiscard]] u32 GetCapturedFrames() const { return _nextFrame; }
+
+   [[nodiscard]] u32 GetWrittenFrames() const { return _writtenFrames.load(std::memory_order_relaxed); }
+
+   [[nodiscard]] u32 GetDroppedFrames() const { return _droppedFrames; }
+
+   [[nodiscard]] u32 GetFailedFrames() const { return _failedFrames.load(std::memory_order_relaxed); }
+
+private:
+   void OnMapped(Slot& slot, WGPUBufferMapAsyncStatus status);
+
+   void WriterLoop();
+
+   static bool WriteFrame(Job& job);
+};
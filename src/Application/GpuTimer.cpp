@@ -0,0 +1,117 @@
+#include <GaussianSplatting.h>
+#include <Application/GpuTimer.h>
+
+void GpuTimer::Initialize(WGPUDevice device, u32 sectionCount) {
+   _sectionCount = sectionCount;
+   _durations.assign(sectionCount, 0.0f);
+
+   WGPUQuerySetDescriptor querySetDesc = {};
+   querySetDesc.nextInChain = nullptr;
+   querySetDesc.label = "GPU Timer Query Set";
+   querySetDesc.type = WGPUQueryType_Timestamp;
+   querySetDesc.count = sectionCount * 2;
+   _querySet = wgpuDeviceCreateQuerySet(device, &querySetDesc);
+   if (!_querySet) {
+      return;
+   }
+
+   WGPUBufferDescriptor resolveBufferDesc = {};
+   resolveBufferDesc.nextInChain = nullptr;
+   resolveBufferDesc.label = "GPU Timer Resolve Buffer";
+   resolveBufferDesc.usage = WGPUBufferUsage_QueryResolve | WGPUBufferUsage_CopySrc;
+   resolveBufferDesc.size = sizeof(uint64_t) * sectionCount * 2;
+   _resolveBuffer = wgpuDeviceCreateBuffer(device, &resolveBufferDesc);
+
+   WGPUBufferDescriptor readbackBufferDesc = {};
+   readbackBufferDesc.nextInChain = nullptr;
+   readbackBufferDesc.label = "GPU Timer Readback Buffer";
+   readbackBufferDesc.usage = WGPUBufferUsage_MapRead | WGPUBufferUsage_CopyDst;
+   readbackBufferDesc.size = resolveBufferDesc.size;
+   _readbackBuffer = wgpuDeviceCreateBuffer(device, &readbackBufferDesc);
+}
+
+void GpuTimer::Release() {
+   if (_readbackBuffer) {
+      wgpuBufferRelease(_readbackBuffer);
+      _readbackBuffer = nullptr;
+   }
+   if (_resolveBuffer) {
+      wgpuBufferRelease(_resolveBuffer);
+      _resolveBuffer = nullptr;
+   }
+   if (_querySet) {
+      wgpuQuerySetRelease(_querySet);
+      _querySet = nullptr;
+   }
+}
+
+bool GpuTimer::GetComputePassWrites(u32 section, bool writeBegin, bool writeEnd, WGPUComputePassTimestampWrites& writes) {
+   // A pass needs at least one valid write index.
+   if (!_querySet || _mapPending || (!writeBegin && !writeEnd)) {
+      return false;
+   }
+
+   _writtenSections |= 1u << section;
+   writes.querySet = _querySet;
+   writes.beginningOfPassWriteIndex = writeBegin ? section * 2 : WGPU_QUERY_SET_INDEX_UNDEFINED;
+   writes.endOfPassWriteIndex = writeEnd ? section * 2 + 1 : WGPU_QUERY_SET_INDEX_UNDEFINED;
+   return true;
+}
+
+bool GpuTimer::GetRenderPassWrites(u32 section, WGPURenderPassTimestampWrites& writes) {
+   if (!_querySet || _mapPending) {
+      return false;
+   }
+
+   _writtenSections |= 1u << section;
+   writes.querySet = _querySet;
+   writes.beginningOfPassWriteIndex = section * 2;
+   writes.endOfPassWriteIndex = section * 2 + 1;
+   return true;
+}
+
+void GpuTimer::Resolve(WGPUCommandEncoder encoder) {
+   _resolved = _querySet && !_mapPending;
+   if (!_resolved) {
+      return;
+   }
+
+   _readbackSections = _writtenSections;
+   _writtenSections = 0;
+
+   wgpuCommandEncoderResolveQuerySet(encoder, _querySet, 0, _sectionCount * 2, _resolveBuffer, 0);
+   wgpuCommandEncoderCopyBufferToBuffer(encoder, _resolveBuffer, 0, _readbackBuffer, 0, sizeof(uint64_t) * _sectionCount * 2);
+}
+
+void GpuTimer::ReadBack() {
+   if (!_resolved) {
+      return;
+   }
+
+   _mapPending = true;
+   auto onMapped = [](WGPUBufferMapAsyncStatus status, void* userData) {
+      auto* timer = static_cast<GpuTimer*>(userData);
+      timer->_mapPending = false;
+      if (status != WGPUBufferMapAsyncStatus_Success) {
+         return;
+      }
+
+      // Timestamps are in nanoseconds, sections skipped in the frame report zero.
+      const auto* timestamps = static_cast<const uint64_t*>(wgpuBufferGetConstMappedRange(timer->_readbackBuffer, 0, sizeof(uint64_t) * timer->_sectionCount * 2));
+      for (u32 section = 0; section < timer->_sectionCount; ++section) {
+         uint64_t begin = timestamps[section * 2];
+         uint64_t end = timestamps[section * 2 + 1];
+         bool written = (timer->_readbackSections >> section) & 1u;
+         timer->_durations[section] = written && end > begin ? static_cast<float>(end - begin) / 1e6f : 0.0f;
+      }
+      wgpuBufferUnmap(timer->_readbackBuffer);
+      timer->_hasNewResults = true;
+   };
+   wgpuBufferMapAsync(_readbackBuffer, WGPUMapMode_Read, 0, sizeof(uint64_t) * _sectionCount * 2, onMapped, this);
+}
+
+bool GpuTimer::ConsumeNewResults() {
+   bool hasNewResults = _hasNewResults;
+   _hasNewResults = false;
+   return hasNewResults;
+}
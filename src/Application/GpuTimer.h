@@ -0,0 +1,47 @@
+#pragma once
+
+#include <Core/Core.h>
+#include <webgpu/webgpu.h>
+
+// Measures the GPU duration of passes with timestamp queries. Every section owns a begin and an end
+// timestamp, results are read back asynchronously and lag a few frames behind the rendered frame.
+// Durations stay zero when the device was created without timestamp query support.
+class GpuTimer {
+private:
+   WGPUQuerySet _querySet = nullptr;
+   WGPUBuffer _resolveBuffer = nullptr;
+   WGPUBuffer _readbackBuffer = nullptr;
+   u32 _sectionCount = 0;
+   bool _mapPending = false;
+   bool _resolved = false;
+   bool _hasNewResults = false;
+   u32 _writtenSections = 0; // Bit mask of the sections timed in the current frame.
+   u32 _readbackSections = 0; // Bit mask of the sections in the pending read back.
+   std::vector<float> _durations;
+
+public:
+   // At most 32 sections.
+   void Initialize(WGPUDevice device, u32 sectionCount);
+
+   void Release();
+
+   [[nodiscard]] bool IsEnabled() const { return _querySet != nullptr; }
+
+   // Timestamp writes covering a section, the first and last pass of a multi pass section only
+   // write their own side. Returns false when timing is disabled or neither side is written.
+   bool GetComputePassWrites(u32 section, bool writeBegin, bool writeEnd, WGPUComputePassTimestampWrites& writes);
+
+   bool GetRenderPassWrites(u32 section, WGPURenderPassTimestampWrites& writes);
+
+   // Resolves this frame's timestamps unless the previous results are still being read.
+   void Resolve(WGPUCommandEncoder encoder);
+
+   // Starts reading back the resolved timestamps, call after the command buffer was submitted.
+   void ReadBack();
+
+   // Duration of a section in milliseconds from the latest completed read back.
+   [[nodiscard]] float GetDuration(u32 section) const { return section < _durations.size() ? _durations[section] : 0.0f; }
+
+   // True once after new results have arrived.
+   bool ConsumeNewResults();
+};
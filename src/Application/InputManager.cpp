@@ -3,42 +3,89 @@
 
 #include <GLFW/glfw3.h>
 
-double mouseX;
-double mouseY;
-
 void CursorPositionCallback(GLFWwindow* window, double xpos, double ypos) {
-   mouseX = xpos;
-   mouseY = ypos;
+   InputManager::GetInstance().PushEvent({ INPUT_EVENT_CURSOR, 0, false, vec2(xpos, ypos), glfwGetTime() });
+}
+
+void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+   // Repeats do not change the state.
+   if (action != GLFW_REPEAT) {
+      InputManager::GetInstance().PushEvent({ INPUT_EVENT_BUTTON, key, action == GLFW_PRESS, vec2(0.0f), glfwGetTime() });
+   }
+}
+
+void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
+   InputManager::GetInstance().PushEvent({ INPUT_EVENT_BUTTON, button, action == GLFW_PRESS, vec2(0.0f), glfwGetTime() });
 }
 
 void InputManager::Initialize(GLFWwindow* window) {
    _window = window;
+   _lastUpdate = glfwGetTime();
    glfwSetCursorPosCallback(window, CursorPositionCallback);
+   glfwSetKeyCallback(window, KeyCallback);
+   glfwSetMouseButtonCallback(window, MouseButtonCallback);
 }
 
 void InputManager::Terminate() {
    _window = nullptr;
 }
 
+void InputManager::PushEvent(const InputEvent& event) {
+   if (!_events.Push(event)) {
+      _droppedEvents.fetch_add(1, std::memory_order_relaxed);
+   }
+}
+
 void InputManager::Update() {
-   _moveCursor = vec2(mouseX, mouseY) - _prevCursor;
-   _prevCursor = vec2(mouseX, mouseY);
+   double now = glfwGetTime();
+   double intervalStart = _lastUpdate;
+   for (float& heldTime : _heldTime) {
+      heldTime = 0.0f;
+   }
+   _moveCursor = vec2(0.0f);
+
+   InputEvent event;
+   while (_events.Pop(event)) {
+      // Events are in callback order, clamping keeps late timestamps inside this interval.
+      double time = clamp(event.time, intervalStart, now);
+      if (event.type == INPUT_EVENT_CURSOR) {
+         // The first position only sets the reference, like a cursor that has not moved.
+         if (_hasCursor) {
+            _moveCursor += event.cursor - _cursor;
+         }
+         _cursor = event.cursor;
+         _hasCursor = true;
+         continue;
+      }
+
+      if (event.code < 0 || event.code >= InputCount) {
+         continue;
+      }
+      if (event.down && !_down[event.code]) {
+         _down[event.code] = true;
+         _downTime[event.code] = time;
+      } else if (!event.down && _down[event.code]) {
+         _down[event.code] = false;
+         _heldTime[event.code] += static_cast<float>(time - std::max(_downTime[event.code], intervalStart));
+      }
+   }
+
+   for (int input = 0; input < InputCount; ++input) {
+      if (_down[input]) {
+         _heldTime[input] += static_cast<float>(now - std::max(_downTime[input], intervalStart));
+      }
+   }
+   _lastUpdate = now;
 }
 
 bool InputManager::IsInputDown(EInput key) {
-   GLFWwindow* window = GetInstance()._window;
-   // Check if mouse key.
-   if (key >= 0 && key <= 7) {
-      return glfwGetMouseButton(window, key) == GLFW_PRESS;
-   }
+   return key >= 0 && key < InputCount && GetInstance()._down[key];
+}
 
-   return glfwGetKey(window, key) == GLFW_PRESS;
+float InputManager::GetHeldTime(EInput key) {
+   return key >= 0 && key < InputCount ? GetInstance()._heldTime[key] : 0.0f;
 }
 
 vec2 InputManager::GetCursorMove() {
    return GetInstance()._moveCursor;
 }
-
-
-
-
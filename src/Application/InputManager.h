@@ -1,5 +1,10 @@
 #pragma once
 
+#include <Core/Core.h>
+#include <Utils/SpscRing.h>
+
+#include <atomic>
+
 struct GLFWwindow;
 
 enum EInput {
@@ -137,6 +142,20 @@ enum EInput {
    MOUSE_BUTTON_MIDDLE = MOUSE_BUTTON_3,
 };
 
+enum EInputEventType {
+   INPUT_EVENT_BUTTON, // Key or mouse button, both indexed by EInput.
+   INPUT_EVENT_CURSOR
+};
+
+// Input as it arrived in the GLFW callbacks, time is glfwGetTime at the callback.
+struct InputEvent {
+   EInputEventType type = INPUT_EVENT_BUTTON;
+   int code = 0;
+   bool down = false;
+   vec2 cursor = vec2(0.0f);
+   double time = 0.0;
+};
+
 class InputManager {
 public:
    static InputManager& GetInstance() {
@@ -144,9 +163,22 @@ public:
       return instance;
    }
 
+public:
+   static constexpr int InputCount = KEY_MENU + 1;
+
 private:
-   vec2 _prevCursor;
-   vec2 _moveCursor;
+   // Filled by the callbacks on the main thread, drained by Update on the consumer thread.
+   SpscRing<InputEvent, 4096> _events;
+   std::atomic<u32> _droppedEvents = 0;
+
+   // Consumer state, integrated from the events up to the last Update.
+   bool _down[InputCount] = {};
+   double _downTime[InputCount] = {}; // Time of the press of held inputs.
+   float _heldTime[InputCount] = {}; // Seconds each input was held between the last two updates.
+   vec2 _cursor = vec2(0.0f);
+   vec2 _moveCursor = vec2(0.0f);
+   bool _hasCursor = false;
+   double _lastUpdate = 0.0;
 
    GLFWwindow* _window = nullptr;
 
@@ -163,9 +195,21 @@ public:
 
    void Terminate();
 
+   // Integrates the events received since the previous call, only call from one thread.
    void Update();
 
+   // State as of the last Update, safe on the thread calling Update.
    static bool IsInputDown(EInput key);
 
+   // Part of the interval between the last two updates the input was held, in seconds. Presses and
+   // releases between updates count with the time they happened, so movement does not depend on the update rate.
+   static float GetHeldTime(EInput key);
+
    static vec2 GetCursorMove();
+
+   // Events lost because the consumer fell behind, their inputs may report a stale state.
+   [[nodiscard]] u32 GetDroppedEvents() const { return _droppedEvents.load(std::memory_order_relaxed); }
+
+   // Called by the GLFW callbacks.
+   void PushEvent(const InputEvent& event);
 };
@@ -2,10 +2,11 @@
 #include <Application/Renderer.h>
 
 #include "imgui.h"
-#include "imgui_impl_glfw.h"
 #include "imgui_impl_wgpu.h"
 
+#include <bit>
 #include <chrono>
+#include <future>
 
 #include <webgpu/webgpu.hpp>
 
@@ -16,8 +17,13 @@ using namespace wgpu;
 #endif // WEBGPU_BACKEND_WGPU
 #include <glfw3webgpu.h>
 #include <Utils/FileReader.h>
+#include <Utils/Tracer.h>
+#include <Utils/TiledImageWriter.h>
 
 #include <Application/Camera.h>
+#include <Application/CameraPath.h>
+#include <Application/TextureReadback.h>
+#include <Application/UiEventQueue.h>
 
 void setDefault(WGPUBindGroupLayoutEntry &bindingLayout) {
    bindingLayout.buffer.nextInChain = nullptr;
@@ -73,6 +79,19 @@ void setDefault(WGPULimits &limits) {
    limits.maxComputeWorkgroupsPerDimension = WGPU_LIMIT_U32_UNDEFINED;
 }
 
+// Staging buffer of a tile in flight, the map callback writes it to the image.
+struct TileReadback {
+   WGPUBuffer buffer = nullptr;
+   WGPUWrappedSubmissionIndex submission = {};
+   TiledImageWriter* writer = nullptr;
+   u64 size = 0;
+   u32 bytesPerRow = 0;
+   u32vec2 origin = u32vec2{0, 0};
+   u32vec2 tileSize = u32vec2{0, 0};
+   bool pending = false;
+   bool failed = false;
+};
+
 void SetImGuiStyle() {
    ImGuiStyle& style = ImGui::GetStyle();
    style.WindowRounding = 5.0f;
@@ -93,89 +112,206 @@ void SetImGuiStyle() {
 }
 
 bool Renderer::Initialize(GLFWwindow *window, int windowWidth, int windowHeight, const char* filename) {
+   TRACE_SCOPE("Renderer::Initialize");
    _viewPortSize = vec2{static_cast<float>(windowWidth), static_cast<float>(windowHeight)};
 
-   if (!CreateWGPUInstance())
+   // The scene is read, decoded and processed on a worker thread while the device, layouts and pipelines
+   // are created here. Loading does not touch the GPU, the buffers are created once both are done.
+   _requestedPath = filename;
+   SelectedFile = _requestedPath.filename().string();
+   std::future<std::unique_ptr<ResidentScene>> sceneLoaded = std::async(std::launch::async, [this]() {
+      Tracer::GetInstance().SetThreadName("Scene loader");
+      auto scene = std::make_unique<ResidentScene>();
+      if (!scene->Load(_requestedPath, ProcessingOptions)) {
+         scene.reset();
+      }
+      return scene;
+   });
+   // The scene directory is scanned in the background as well.
+   _catalog.Start(SplatDirectory);
+   _catalogSnapshot = _catalog.GetSnapshot();
+   _thumbnails.Start("../../../assets/cache/thumbnails");
+
    {
-      return false;
+      TRACE_SCOPE("CreateWGPUInstance");
+      if (!CreateWGPUInstance())
+      {
+         return false;
+      }
    }
 
-   if (!CreateWGPUSurface(window))
    {
-      return false;
+      TRACE_SCOPE("CreateWGPUSurface");
+      if (!CreateWGPUSurface(window))
+      {
+         return false;
+      }
    }
 
-   if (!GetAdapterAndDevice())
    {
-      return false;
+      TRACE_SCOPE("GetAdapterAndDevice");
+      if (!GetAdapterAndDevice())
+      {
+         return false;
+      }
    }
 
    RequestQueue();
-   ConfigureSurface();
-
-   // Load splat data.
-   SelectedFile = filename;
-   if (!FileReader::LoadSplatData(SelectedFile, _rawSplatsData)) {
-      std::cerr << "Failed to load splat data!" << std::endl;
-      return false;
-   }
-
-   // Pre compute sort params for data size.
-   for (u32 k = 2; k / 2 <= _rawSplatsData.size(); k *= 2)
    {
-      for (u32 j = k / 2; j > 0; j /= 2) {
-         _sortSplatsParamsData.push_back({ k,j });
-      }
+      TRACE_SCOPE("ConfigureSurface");
+      ConfigureSurface();
    }
 
-   InitializeBuffers();
+   // Kernel configuration benchmarked for this adapter, the defaults are used until the autotuner has run.
+   _adapterProfile = Autotuner::GetAdapterProfile(_wgpuAdapter);
+   Autotuner::LoadProfile(_adapterProfile, _tuning);
 
-   // Load shader source.
-   WGPUShaderModule shaderModule = FileReader::LoadShaderModule("../../../assets/shaders/gaussian_splatting.wgsl", _wgpuDevice);
-   if (shaderModule == nullptr) {
-      std::cerr << "Failed to load shader module!" << std::endl;
+   InitializeBindGroupLayouts();
+   _shaderCache.Initialize(_wgpuDevice);
+
+   // Compile the permutation the first frame most likely needs while the scene loads, only PLY files
+   // carry view dependent color.
+   u32 expectedSHDegree = std::filesystem::path(filename).extension() == ".ply" ? static_cast<u32>(_shDegreeCap) : 0;
+   if (GetPipelineVariant(GetPipelineVariantKey(expectedSHDegree, _tuning)) == nullptr) {
+      std::cerr << "Failed to create the splat pipelines!" << std::endl;
       __debugbreak();
       return false;
    }
-   _performanceData.pointCount = static_cast<uint32>(_rawSplatsData.size());
 
-   // Create a pipeline layout for all pipelines to use.
-   WGPUBindGroupLayout bgLayouts[2] = { _sceneBindGroupLayout, _stateBindGroupLayout };
-
-   WGPUPipelineLayoutDescriptor pipelineLayoutDesc = {};
-   pipelineLayoutDesc.nextInChain = nullptr;
-   pipelineLayoutDesc.label = "WGPU Pipeline Layout";
-   pipelineLayoutDesc.bindGroupLayoutCount = 2;
-   pipelineLayoutDesc.bindGroupLayouts = bgLayouts;
-   _wgpuPipelineLayout = wgpuDeviceCreatePipelineLayout(_wgpuDevice, &pipelineLayoutDesc);
+   // Offscreen target and the pass that upscales it to the surface.
+   InitializeRenderTarget();
+   WGPUShaderModule upscaleShaderModule = _shaderCache.GetModule("../../../assets/shaders/upscale.wgsl");
+   if (upscaleShaderModule == nullptr) {
+      std::cerr << "Failed to load upscale shader module!" << std::endl;
+      __debugbreak();
+      return false;
+   }
+   InitializeUpscalePipeline(upscaleShaderModule);
+   WGPUShaderModule oitResolveShaderModule = _shaderCache.GetModule("../../../assets/shaders/oit_resolve.wgsl");
+   if (oitResolveShaderModule == nullptr) {
+      std::cerr << "Failed to load OIT resolve shader module!" << std::endl;
+      __debugbreak();
+      return false;
+   }
+   InitializeOitResolvePipeline(oitResolveShaderModule);
+   WGPUShaderModule temporalShaderModule = _shaderCache.GetModule("../../../assets/shaders/temporal_accumulation.wgsl");
+   if (temporalShaderModule == nullptr) {
+      std::cerr << "Failed to load temporal accumulation shader module!" << std::endl;
+      __debugbreak();
+      return false;
+   }
+   InitializeTemporalPipeline(temporalShaderModule);
 
-   InitializeComputePipelines(shaderModule);
-   InitializeRenderPipeline(shaderModule);
+   if (_timestampQueriesSupported) {
+      _gpuTimer.Initialize(_wgpuDevice, GPU_PASS_COUNT);
+   }
+   _frameCapture.Initialize(_wgpuDevice, _viewPortSize);
 
    // Release adapter and instance as they are not needed anymore.
    wgpuInstanceRelease(_wgpuInstance);
    wgpuAdapterRelease(_wgpuAdapter);
 
-   InitializeImGui(window);
+   InitializeImGui();
+
+   // Wait for the scene, the first frame needs both the pipelines and the scene buffers.
+   std::unique_ptr<ResidentScene> scene;
+   {
+      TRACE_SCOPE("WaitForSceneLoad");
+      scene = sceneLoaded.get();
+      if (!scene) {
+         std::cerr << "Failed to load splat data!" << std::endl;
+         return false;
+      }
+   }
+
+   InitializeBuffers();
+   _residentScenes.SetBudget(static_cast<u64>(_sceneBudgetMB) * 1024 * 1024);
+   ResidentScene* resident = _residentScenes.Insert(std::move(scene));
+   UploadScene(*resident);
+   ShowScene(resident);
+
+   // Later scenes are loaded in the background, starting with the neighbours of this one.
+   _residentScenes.Start();
+   PrefetchNeighbours();
 
    return true;
 }
 
 void Renderer::Terminate() {
+   // Frames still in flight reference the resources released below.
+   _catalog.Stop();
+   _thumbnails.Stop();
+   _residentScenes.Stop();
+   wgpuDevicePoll(_wgpuDevice, true, nullptr);
    ReleaseImGui();
-   wgpuBindGroupRelease(_stateBindGroup);
+   _gpuTimer.Release();
+   _frameCapture.Release();
+   for (FrameResources& frame : _frames) {
+      wgpuBindGroupRelease(frame.temporalUniformBindGroup);
+      wgpuBufferRelease(frame.temporalUniformBuffer);
+      wgpuBindGroupRelease(frame.upscaleBindGroup);
+      wgpuBufferRelease(frame.upscaleUniformBuffer);
+      ReleaseFrameBuffers(frame);
+   }
+   wgpuBindGroupLayoutRelease(_upscaleBindGroupLayout);
+   wgpuPipelineLayoutRelease(_upscalePipelineLayout);
+   wgpuRenderPipelineRelease(_upscalePipeline);
+   wgpuSamplerRelease(_upscaleSampler);
+   for (u32 i = 0; i < 2; ++i) {
+      wgpuBindGroupRelease(_temporalTextureBindGroups[i]);
+      wgpuTextureViewRelease(_historyTextureViews[i]);
+      wgpuTextureDestroy(_historyTextures[i]);
+      wgpuTextureRelease(_historyTextures[i]);
+   }
+   wgpuBindGroupLayoutRelease(_temporalUniformBindGroupLayout);
+   wgpuBindGroupLayoutRelease(_temporalTextureBindGroupLayout);
+   wgpuPipelineLayoutRelease(_temporalPipelineLayout);
+   wgpuRenderPipelineRelease(_temporalPipeline);
+   wgpuTextureViewRelease(_depthTextureView);
+   wgpuTextureDestroy(_depthTexture);
+   wgpuTextureRelease(_depthTexture);
+   wgpuTextureViewRelease(_stochasticColorTextureView);
+   wgpuTextureDestroy(_stochasticColorTexture);
+   wgpuTextureRelease(_stochasticColorTexture);
+   wgpuBindGroupRelease(_oitResolveBindGroup);
+   wgpuBindGroupLayoutRelease(_oitResolveBindGroupLayout);
+   wgpuPipelineLayoutRelease(_oitResolvePipelineLayout);
+   wgpuRenderPipelineRelease(_oitResolvePipeline);
+   wgpuTextureViewRelease(_oitRevealTextureView);
+   wgpuTextureDestroy(_oitRevealTexture);
+   wgpuTextureRelease(_oitRevealTexture);
+   wgpuTextureViewRelease(_oitAccumTextureView);
+   wgpuTextureDestroy(_oitAccumTexture);
+   wgpuTextureRelease(_oitAccumTexture);
+   wgpuTextureViewRelease(_sceneTextureView);
+   wgpuTextureDestroy(_sceneTexture);
+   wgpuTextureRelease(_sceneTexture);
    wgpuBindGroupLayoutRelease(_stateBindGroupLayout);
-   wgpuBindGroupRelease(_sceneBindGroup);
+   _residentScenes.Clear();
+   for (auto& [name, texture] : _thumbnailTextures) {
+      wgpuTextureViewRelease(texture.view);
+      wgpuTextureDestroy(texture.texture);
+      wgpuTextureRelease(texture.texture);
+   }
    wgpuBindGroupLayoutRelease(_sceneBindGroupLayout);
    wgpuPipelineLayoutRelease(_wgpuPipelineLayout);
-   wgpuBufferRelease(_uniformBuffer);
-   wgpuBufferRelease(_sortSplatsParamsUniform);
    wgpuBufferRelease(_sortSplatsParamsDataBuffer);
-   wgpuBufferRelease(_sortedSplatsBuffer);
-   wgpuBufferRelease(_splatsBuffer);
-   wgpuRenderPipelineRelease(_wgpuRenderPipeline);
-   wgpuComputePipelineRelease(_wgpuSortComputePipeline);
-   wgpuComputePipelineRelease(_wgpuTransformComputePipeline);
+   wgpuBufferRelease(_cullStatsReadbackBuffer);
+   for (auto& [key, variant] : _pipelineVariants) {
+      wgpuRenderPipelineRelease(variant.stochasticRenderPipeline);
+      wgpuRenderPipelineRelease(variant.oitRenderPipeline);
+      wgpuRenderPipelineRelease(variant.renderPipeline);
+      wgpuComputePipelineRelease(variant.sortPipeline);
+      wgpuComputePipelineRelease(variant.transformPipeline);
+      if (variant.shPipeline) {
+         wgpuComputePipelineRelease(variant.shPipeline);
+      }
+      if (variant.blockSortPipeline) {
+         wgpuComputePipelineRelease(variant.blockMergePipeline);
+         wgpuComputePipelineRelease(variant.blockSortPipeline);
+      }
+   }
+   _shaderCache.Release();
    wgpuSurfaceUnconfigure(_wgpuSurface);
    wgpuSurfaceRelease(_wgpuSurface);
    wgpuQueueRelease(_wgpuQueue);
@@ -183,91 +319,436 @@ void Renderer::Terminate() {
 }
 
 void Renderer::Render(const Camera &camera) {
+   TRACE_SCOPE("Renderer::Render");
+
+   std::chrono::high_resolution_clock::time_point start, end, startCull, endCull, startSH, endSH, startSort, endSort, startRender, endRender;
 
-   std::chrono::high_resolution_clock::time_point start, end, startSort, endSort, startRender, endRender;
+   // Uploads scenes the loader finished and switches to the requested one once it is resident.
+   UpdateResidentScenes();
+   UpdateCatalog();
+   UpdateThumbnails();
+
+   // Benchmarks wait for the GPU to be idle, so they run before any work of this frame.
+   if (_autotuneRequested) {
+      _autotuneRequested = false;
+      RunAutotune();
+   }
+   if (_compareRequested) {
+      _compareRequested = false;
+      CompareRenderModes(camera);
+   }
+   if (_tiledRenderRequested) {
+      _tiledRenderRequested = false;
+      RenderTiled(camera, u32vec2(_tiledRenderWidth, _tiledRenderHeight), "../../../assets/renders/tiled.ppm");
+   }
+   // The path stopped before this frame, which repeats its last pose.
+   bool playingPath = Path != nullptr && Path->IsPlaying();
+   if (_playbackActive && !playingPath) {
+      FinishPlayback();
+   }
 
    start = std::chrono::high_resolution_clock::now();
 
-   startSort = std::chrono::high_resolution_clock::now();
+   // Reuse the resources of the oldest frame in flight once the GPU is done with them.
+   FrameResources& frame = _frames[_frameIndex];
+   {
+      TRACE_SCOPE("WaitForFrame");
+      WaitForFrame(frame);
+   }
+   std::chrono::high_resolution_clock::time_point endWait = std::chrono::high_resolution_clock::now();
+
+   UpdateRenderScale();
+
+   // Coarse culling of whole chunks against the camera frustum.
+   startCull = std::chrono::high_resolution_clock::now();
+   {
+      TRACE_SCOPE("UpdateVisibleChunks");
+      UpdateVisibleChunks(camera);
+   }
+   endCull = std::chrono::high_resolution_clock::now();
+
    UpdateUniforms(camera);
 
+   // Reset the draw arguments and cull counters, the transform pass counts the splats that survive culling.
+   CullStats cullStats = { 4, 0, 0, 0, 0, 0 };
+   wgpuQueueWriteBuffer(_wgpuQueue, frame.cullStatsBuffer, 0, &cullStats, sizeof(CullStats));
+
    WGPUCommandEncoder encoder = CreateCommandEncoder();
 
-   int workGroups = (_splatsData.size() + _workGroupSize - 1) / _workGroupSize;
+   // Permutation for the current settings, a new combination compiles once on first use.
+   const PipelineVariant* pipelines = GetPipelineVariant(GetPipelineVariantKey(GetSHDegree(), _tuning));
+   UpdateSortSchedule();
 
-   // Transform compute pass.
-   WGPUComputePassEncoder computePassEncoder = BeginComputePass(encoder);
-   wgpuComputePassEncoderSetPipeline(computePassEncoder, _wgpuTransformComputePipeline);
-   wgpuComputePassEncoderSetBindGroup(computePassEncoder, 0, _sceneBindGroup, 0, nullptr);
-   wgpuComputePassEncoderSetBindGroup(computePassEncoder, 1, _stateBindGroup, 0, nullptr);
-   wgpuComputePassEncoderDispatchWorkgroups(computePassEncoder, workGroups, 1, 1);
-   wgpuComputePassEncoderEnd(computePassEncoder);
-   wgpuComputePassEncoderRelease(computePassEncoder);
+   // Only the visible chunks are transformed and sorted, padded to a power of two for the bitonic sort.
+   u32 visibleSplatSlots = pipelines ? static_cast<u32>(_visibleChunks.size()) * SceneCache::ChunkSize : 0;
 
-   // Sort compute pass.
-   for (uint i = 0; i < _sortSplatsParamsData.size(); ++i)
-   {
-      uint32_t offset = i * sizeof(uvec2);
+   // Spherical harmonics compute pass, evaluates the view dependent color once per visible splat.
+   startSH = std::chrono::high_resolution_clock::now();
+   if (GetSHDegree() > 0 && visibleSplatSlots > 0) {
+      EncodeSHPass(encoder, *pipelines, frame, visibleSplatSlots, true);
+   }
+   endSH = std::chrono::high_resolution_clock::now();
 
-      wgpuCommandEncoderCopyBufferToBuffer(encoder, _sortSplatsParamsDataBuffer, offset, _sortSplatsParamsUniform, 0, sizeof(uvec2));
-      computePassEncoder = BeginComputePass(encoder);
-      wgpuComputePassEncoderSetPipeline(computePassEncoder, _wgpuSortComputePipeline);
-      wgpuComputePassEncoderSetBindGroup(computePassEncoder, 0, _sceneBindGroup, 0, nullptr);
-      wgpuComputePassEncoderSetBindGroup(computePassEncoder, 1, _stateBindGroup, 0, nullptr);
-      wgpuComputePassEncoderDispatchWorkgroups(computePassEncoder, workGroups, 1, 1);
-      wgpuComputePassEncoderEnd(computePassEncoder);
-      wgpuComputePassEncoderRelease(computePassEncoder);
+   startSort = std::chrono::high_resolution_clock::now();
+   if (visibleSplatSlots > 0) {
+      u32 sortCount = std::clamp<u32>(std::bit_ceil(visibleSplatSlots), std::max(_tuning.workGroupSize, _sortSchedule.GetBlockSize()), _sortCapacity);
+      EncodeTransformPass(encoder, *pipelines, _scene->bindGroup, frame, _tuning.workGroupSize, sortCount, true);
+      // Weighted OIT blends in any order, only the culling of the transform pass is needed.
+      if (_renderMode == RENDER_MODE_SORTED) {
+         EncodeSortPasses(encoder, *pipelines, _scene->bindGroup, frame, _sortSplatsParamsDataBuffer, _sortSchedule, _tuning.workGroupSize, sortCount, true);
+      }
    }
    endSort = std::chrono::high_resolution_clock::now();
 
    startRender = std::chrono::high_resolution_clock::now();
-   // Render pass.
+   // Splat render pass into the offscreen target at the current render scale.
+   u32vec2 renderSize = GetRenderSize();
+   EncodeSplatPass(encoder, visibleSplatSlots > 0 ? pipelines : nullptr, _scene->bindGroup, frame, _renderMode, visibleSplatSlots, renderSize, true);
+   // Captured frames exclude the UI. Playback waits for the capture, so every pose of the path is written.
+   _frameCapture.EncodeCopy(encoder, _sceneTexture, renderSize, _playbackCapturing);
+
+   // Upscale pass to the surface, the UI is drawn on top at full resolution.
+   UpscaleUniforms upscaleUniforms;
+   upscaleUniforms.uvScale = vec2(renderSize) / vec2(_viewPortSize);
+   wgpuQueueWriteBuffer(_wgpuQueue, frame.upscaleUniformBuffer, 0, &upscaleUniforms, sizeof(UpscaleUniforms));
+
    WGPUSurfaceTexture surfaceTexture = GetNextSurfaceTexture();
    WGPUTextureView textureView = CreateTextureView(surfaceTexture.texture);
-   WGPURenderPassEncoder renderPassEncoder = BeginRenderPass(encoder, textureView);
-
-   wgpuRenderPassEncoderSetBindGroup(renderPassEncoder, 0, _sceneBindGroup, 0, nullptr);
-   wgpuRenderPassEncoderSetBindGroup(renderPassEncoder, 1, _stateBindGroup, 0, nullptr);
-   wgpuRenderPassEncoderSetPipeline(renderPassEncoder, _wgpuRenderPipeline);
-   wgpuRenderPassEncoderDraw(renderPassEncoder, 4, static_cast<int>(_splatsData.size()), 0, 0);
+   WGPURenderPassTimestampWrites renderWrites = {};
+   bool timed = _gpuTimer.GetRenderPassWrites(GPU_PASS_UPSCALE, renderWrites);
+   WGPURenderPassEncoder renderPassEncoder = BeginRenderPass(encoder, textureView, timed ? &renderWrites : nullptr);
+   wgpuRenderPassEncoderSetPipeline(renderPassEncoder, _upscalePipeline);
+   wgpuRenderPassEncoderSetBindGroup(renderPassEncoder, 0, frame.upscaleBindGroup, 0, nullptr);
+   wgpuRenderPassEncoderDraw(renderPassEncoder, 3, 1, 0, 0);
 
    // Render ImGui UI
-   ImGuiBeginFrame();
-   RenderImGuiUI();
-   ImGuiEndFrame(renderPassEncoder);
+   {
+      TRACE_SCOPE("ImGui");
+      ImGuiBeginFrame();
+      RenderImGuiUI(camera);
+      ImGuiEndFrame(renderPassEncoder);
+   }
 
    wgpuRenderPassEncoderEnd(renderPassEncoder);
    wgpuRenderPassEncoderRelease(renderPassEncoder);
+
+   // Copy the cull stats for the UI unless the previous copy is still being read.
+   bool readCullStats = !_cullStatsMapPending;
+   if (readCullStats) {
+      wgpuCommandEncoderCopyBufferToBuffer(encoder, frame.cullStatsBuffer, 0, _cullStatsReadbackBuffer, 0, sizeof(CullStats));
+   }
+   _gpuTimer.Resolve(encoder);
    // Submit command buffer and release resources.
    WGPUCommandBuffer commandBuffer = FinishAndReleaseCommandEncoder(encoder);
-   wgpuQueueSubmit(_wgpuQueue, 1, &commandBuffer); // Submit command buffer.
+   {
+      TRACE_SCOPE("QueueSubmit");
+      frame.submissionIndex = wgpuQueueSubmitForIndex(_wgpuQueue, 1, &commandBuffer); // Submit command buffer.
+      frame.submitted = true;
+   }
    wgpuCommandBufferRelease(commandBuffer);
+   if (readCullStats) {
+      ReadCullStats();
+   }
+   _gpuTimer.ReadBack();
+   _frameCapture.ReadBack();
    wgpuTextureViewRelease(textureView);
-   wgpuSurfacePresent(_wgpuSurface);
+   {
+      TRACE_SCOPE("SurfacePresent");
+      wgpuSurfacePresent(_wgpuSurface);
+   }
+   // Only fires finished callbacks, waiting happens when the frame resources are reused.
    wgpuDevicePoll(_wgpuDevice, false, nullptr);
    wgpuTextureRelease(surfaceTexture.texture); // Release the surface texture as it was causing a memory leak.
    endRender = std::chrono::high_resolution_clock::now();
    end = std::chrono::high_resolution_clock::now();
 
+   _performanceData.visibleChunkCount = static_cast<uint32>(_visibleChunks.size());
+   _performanceData.visibleLodChunkCount = static_cast<uint32>(std::count_if(_visibleChunks.begin(), _visibleChunks.end(),
+      [this](u32 chunk) { return chunk >= _performanceData.chunkCount; }));
+   _performanceData.cullTime = std::chrono::duration<float, std::milli>(endCull - startCull).count();
+   _performanceData.shTime = std::chrono::duration<float, std::milli>(endSH - startSH).count();
    _performanceData.sortTime = std::chrono::duration<float, std::milli>(endSort - startSort).count();
    _performanceData.renderTime = std::chrono::duration<float, std::milli>(endRender - startRender).count();
    _performanceData.frameTime = std::chrono::duration<float, std::milli>(end - start).count();
+   if (_playbackActive) {
+      _playbackFrameTimes.push_back(_performanceData.frameTime);
+   }
+   for (u32 pass = 0; pass < GPU_PASS_COUNT; ++pass) {
+      _performanceData.gpuTimes[pass] = _gpuTimer.GetDuration(pass);
+   }
+   _performanceData.renderScale = _renderScale;
+
+   // Utilization over the interval since the previous frame started, the CPU is idle while waiting for the GPU.
+   if (_lastFrameStart != std::chrono::high_resolution_clock::time_point()) {
+      _performanceData.frameInterval = std::chrono::duration<float, std::milli>(start - _lastFrameStart).count();
+   }
+   _performanceData.frameWaitTime = std::chrono::duration<float, std::milli>(endWait - start).count();
+   if (_performanceData.frameInterval > 0.0f) {
+      float gpuTime = 0.0f;
+      for (float passTime : _performanceData.gpuTimes) {
+         gpuTime += passTime;
+      }
+      _performanceData.cpuUtilization = std::min((_performanceData.frameTime - _performanceData.frameWaitTime) / _performanceData.frameInterval, 1.0f);
+      _performanceData.gpuUtilization = std::min(gpuTime / _performanceData.frameInterval, 1.0f);
+   }
+   _lastFrameStart = start;
+   _frameIndex = (_frameIndex + 1) % FramesInFlight;
 }
 
-// Calculate avg position of all splats.
-vec4 Renderer::GetModelPosition() const {
-   vec4 avgPosition(0.0f);
-   for (const auto &splat: _rawSplatsData) {
-      avgPosition += _modelMatrix * splat.position;
+void Renderer::WaitForFrame(FrameResources& frame)
+{
+   if (!frame.submitted) {
+      return;
+   }
+
+   WGPUWrappedSubmissionIndex submission = {};
+   submission.queue = _wgpuQueue;
+   submission.submissionIndex = frame.submissionIndex;
+   wgpuDevicePoll(_wgpuDevice, true, &submission);
+   frame.submitted = false;
+}
+
+void Renderer::EncodeSHPass(WGPUCommandEncoder encoder, const PipelineVariant& pipelines, const FrameResources& frame, u32 visibleSplatSlots, bool timed)
+{
+   WGPUComputePassTimestampWrites computeWrites = {};
+   bool passTimed = timed && _gpuTimer.GetComputePassWrites(GPU_PASS_SH, true, true, computeWrites);
+   WGPUComputePassEncoder computePassEncoder = BeginComputePass(encoder, passTimed ? &computeWrites : nullptr);
+   wgpuComputePassEncoderSetPipeline(computePassEncoder, pipelines.shPipeline);
+   wgpuComputePassEncoderSetBindGroup(computePassEncoder, 0, _scene->bindGroup, 0, nullptr);
+   wgpuComputePassEncoderSetBindGroup(computePassEncoder, 1, frame.stateBindGroup, 0, nullptr);
+   wgpuComputePassEncoderDispatchWorkgroups(computePassEncoder, visibleSplatSlots / _tuning.workGroupSize, 1, 1);
+   wgpuComputePassEncoderEnd(computePassEncoder);
+   wgpuComputePassEncoderRelease(computePassEncoder);
+}
+
+void Renderer::EncodeTransformPass(WGPUCommandEncoder encoder, const PipelineVariant& pipelines, WGPUBindGroup sceneBindGroup, const FrameResources& frame,
+                                   u32 workGroupSize, u32 sortCount, bool timed)
+{
+   WGPUComputePassTimestampWrites computeWrites = {};
+   bool passTimed = timed && _gpuTimer.GetComputePassWrites(GPU_PASS_TRANSFORM, true, true, computeWrites);
+   WGPUComputePassEncoder computePassEncoder = BeginComputePass(encoder, passTimed ? &computeWrites : nullptr);
+   wgpuComputePassEncoderSetPipeline(computePassEncoder, pipelines.transformPipeline);
+   wgpuComputePassEncoderSetBindGroup(computePassEncoder, 0, sceneBindGroup, 0, nullptr);
+   wgpuComputePassEncoderSetBindGroup(computePassEncoder, 1, frame.stateBindGroup, 0, nullptr);
+   wgpuComputePassEncoderDispatchWorkgroups(computePassEncoder, sortCount / workGroupSize, 1, 1);
+   wgpuComputePassEncoderEnd(computePassEncoder);
+   wgpuComputePassEncoderRelease(computePassEncoder);
+}
+
+void Renderer::EncodeSortPasses(WGPUCommandEncoder encoder, const PipelineVariant& pipelines, WGPUBindGroup sceneBindGroup, const FrameResources& frame,
+                                WGPUBuffer sortParamsDataBuffer, const SortSchedule& schedule, u32 workGroupSize, u32 sortCount, bool timed)
+{
+   // Sort compute passes, global steps run one thread per key and block passes one workgroup per block.
+   WGPUComputePassTimestampWrites computeWrites = {};
+   u32 sortSteps = schedule.GetStepCount(sortCount);
+   for (u32 i = 0; i < sortSteps; ++i)
+   {
+      const SortStep& step = schedule.GetSteps()[i];
+      uint32_t offset = i * sizeof(uvec2);
+
+      wgpuCommandEncoderCopyBufferToBuffer(encoder, sortParamsDataBuffer, offset, frame.sortSplatsParamsUniform, 0, sizeof(uvec2));
+      // The sort is timed from the start of its first pass to the end of its last pass, passes in between write no timestamps.
+      bool boundaryPass = i == 0 || i + 1 == sortSteps;
+      bool passTimed = timed && boundaryPass && _gpuTimer.GetComputePassWrites(GPU_PASS_SORT, i == 0, i + 1 == sortSteps, computeWrites);
+      WGPUComputePassEncoder computePassEncoder = BeginComputePass(encoder, passTimed ? &computeWrites : nullptr);
+      if (step.pass == SORT_PASS_GLOBAL) {
+         wgpuComputePassEncoderSetPipeline(computePassEncoder, pipelines.sortPipeline);
+      } else {
+         wgpuComputePassEncoderSetPipeline(computePassEncoder, step.pass == SORT_PASS_BLOCK_SORT ? pipelines.blockSortPipeline : pipelines.blockMergePipeline);
+      }
+      wgpuComputePassEncoderSetBindGroup(computePassEncoder, 0, sceneBindGroup, 0, nullptr);
+      wgpuComputePassEncoderSetBindGroup(computePassEncoder, 1, frame.stateBindGroup, 0, nullptr);
+      u32 keysPerGroup = step.pass == SORT_PASS_GLOBAL ? workGroupSize : schedule.GetBlockSize();
+      wgpuComputePassEncoderDispatchWorkgroups(computePassEncoder, sortCount / keysPerGroup, 1, 1);
+      wgpuComputePassEncoderEnd(computePassEncoder);
+      wgpuComputePassEncoderRelease(computePassEncoder);
+   }
+}
+
+void Renderer::EncodeSplatPass(WGPUCommandEncoder encoder, const PipelineVariant* pipelines, WGPUBindGroup sceneBindGroup, const FrameResources& frame,
+                               ERenderMode mode, u32 splatSlots, u32vec2 renderSize, bool timed)
+{
+   WGPURenderPassTimestampWrites renderWrites = {};
+   bool passTimed = timed && _gpuTimer.GetRenderPassWrites(GPU_PASS_SPLATS, renderWrites);
+
+   if (mode == RENDER_MODE_WEIGHTED_OIT) {
+      // Accumulation pass, starts from no coverage: zero color and full revealage.
+      WGPURenderPassColorAttachment oitAttachments[2] = {};
+      oitAttachments[0].view = _oitAccumTextureView;
+      oitAttachments[0].resolveTarget = nullptr;
+      oitAttachments[0].loadOp = WGPULoadOp_Clear;
+      oitAttachments[0].storeOp = WGPUStoreOp_Store;
+      oitAttachments[0].clearValue = WGPUColor{ 0.0, 0.0, 0.0, 0.0 };
+      oitAttachments[1].view = _oitRevealTextureView;
+      oitAttachments[1].resolveTarget = nullptr;
+      oitAttachments[1].loadOp = WGPULoadOp_Clear;
+      oitAttachments[1].storeOp = WGPUStoreOp_Store;
+      oitAttachments[1].clearValue = WGPUColor{ 1.0, 1.0, 1.0, 1.0 };
+
+      WGPURenderPassDescriptor oitPassDesc = {};
+      oitPassDesc.nextInChain = nullptr;
+      oitPassDesc.label = "OIT Accumulation Pass";
+      oitPassDesc.colorAttachmentCount = 2;
+      oitPassDesc.colorAttachments = oitAttachments;
+      oitPassDesc.depthStencilAttachment = nullptr;
+      oitPassDesc.timestampWrites = passTimed ? &renderWrites : nullptr;
+      WGPURenderPassEncoder oitPassEncoder = wgpuCommandEncoderBeginRenderPass(encoder, &oitPassDesc);
+      wgpuRenderPassEncoderSetViewport(oitPassEncoder, 0.0f, 0.0f, static_cast<float>(renderSize.x), static_cast<float>(renderSize.y), 0.0f, 1.0f);
+      wgpuRenderPassEncoderSetScissorRect(oitPassEncoder, 0, 0, renderSize.x, renderSize.y);
+      if (pipelines != nullptr) {
+         wgpuRenderPassEncoderSetBindGroup(oitPassEncoder, 0, sceneBindGroup, 0, nullptr);
+         wgpuRenderPassEncoderSetBindGroup(oitPassEncoder, 1, frame.stateBindGroup, 0, nullptr);
+         wgpuRenderPassEncoderSetPipeline(oitPassEncoder, pipelines->oitRenderPipeline);
+         // Culled splats are interleaved with the drawn ones without the sort, they produce degenerate quads.
+         wgpuRenderPassEncoderDraw(oitPassEncoder, 4, splatSlots, 0, 0);
+      }
+      wgpuRenderPassEncoderEnd(oitPassEncoder);
+      wgpuRenderPassEncoderRelease(oitPassEncoder);
+
+      // Resolve over the background of the scene texture.
+      WGPURenderPassEncoder resolvePassEncoder = BeginRenderPass(encoder, _sceneTextureView);
+      wgpuRenderPassEncoderSetViewport(resolvePassEncoder, 0.0f, 0.0f, static_cast<float>(renderSize.x), static_cast<float>(renderSize.y), 0.0f, 1.0f);
+      wgpuRenderPassEncoderSetScissorRect(resolvePassEncoder, 0, 0, renderSize.x, renderSize.y);
+      wgpuRenderPassEncoderSetPipeline(resolvePassEncoder, _oitResolvePipeline);
+      wgpuRenderPassEncoderSetBindGroup(resolvePassEncoder, 0, _oitResolveBindGroup, 0, nullptr);
+      wgpuRenderPassEncoderDraw(resolvePassEncoder, 3, 1, 0, 0);
+      wgpuRenderPassEncoderEnd(resolvePassEncoder);
+      wgpuRenderPassEncoderRelease(resolvePassEncoder);
+      return;
+   }
+
+   if (mode == RENDER_MODE_STOCHASTIC) {
+      EncodeStochasticPasses(encoder, pipelines, sceneBindGroup, frame, splatSlots, renderSize, passTimed ? &renderWrites : nullptr);
+      return;
+   }
+
+   // The history only follows consecutive stochastic frames.
+   _historyValid = false;
+
+   // The state bind group writes the cull stats, so the pass draws from a copy of their draw arguments.
+   if (pipelines != nullptr) {
+      wgpuCommandEncoderCopyBufferToBuffer(encoder, frame.cullStatsBuffer, 0, frame.drawArgsBuffer, 0, DrawArgsSize);
+   }
+
+   WGPURenderPassEncoder renderPassEncoder = BeginRenderPass(encoder, _sceneTextureView, passTimed ? &renderWrites : nullptr);
+   wgpuRenderPassEncoderSetViewport(renderPassEncoder, 0.0f, 0.0f, static_cast<float>(renderSize.x), static_cast<float>(renderSize.y), 0.0f, 1.0f);
+   wgpuRenderPassEncoderSetScissorRect(renderPassEncoder, 0, 0, renderSize.x, renderSize.y);
+
+   // Only clears the target without pipelines or visible splats.
+   if (pipelines != nullptr) {
+      wgpuRenderPassEncoderSetBindGroup(renderPassEncoder, 0, sceneBindGroup, 0, nullptr);
+      wgpuRenderPassEncoderSetBindGroup(renderPassEncoder, 1, frame.stateBindGroup, 0, nullptr);
+      wgpuRenderPassEncoderSetPipeline(renderPassEncoder, pipelines->renderPipeline);
+      // Culled splats sort behind the surviving ones, so drawing the surviving count skips them.
+      wgpuRenderPassEncoderDrawIndirect(renderPassEncoder, frame.drawArgsBuffer, 0);
+   }
+
+   wgpuRenderPassEncoderEnd(renderPassEncoder);
+   wgpuRenderPassEncoderRelease(renderPassEncoder);
+}
+
+void Renderer::EncodeStochasticPasses(WGPUCommandEncoder encoder, const PipelineVariant* pipelines, WGPUBindGroup sceneBindGroup, const FrameResources& frame,
+                                      u32 splatSlots, u32vec2 renderSize, const WGPURenderPassTimestampWrites* timestampWrites)
+{
+   // Hashed alpha test, the nearest kept fragment of each pixel wins the depth test.
+   WGPURenderPassColorAttachment colorAttachment = {};
+   colorAttachment.view = _stochasticColorTextureView;
+   colorAttachment.resolveTarget = nullptr;
+   colorAttachment.loadOp = WGPULoadOp_Clear;
+   colorAttachment.storeOp = WGPUStoreOp_Store;
+   colorAttachment.clearValue = WGPUColor{ 1.0, 1.0, 1.0, 1.0 };
+
+   WGPURenderPassDepthStencilAttachment depthAttachment = {};
+   depthAttachment.view = _depthTextureView;
+   depthAttachment.depthLoadOp = WGPULoadOp_Clear;
+   depthAttachment.depthStoreOp = WGPUStoreOp_Store;
+   depthAttachment.depthClearValue = 1.0f;
+   depthAttachment.depthReadOnly = false;
+   depthAttachment.stencilLoadOp = WGPULoadOp_Undefined;
+   depthAttachment.stencilStoreOp = WGPUStoreOp_Undefined;
+   depthAttachment.stencilClearValue = 0;
+   depthAttachment.stencilReadOnly = true;
+
+   WGPURenderPassDescriptor stochasticPassDesc = {};
+   stochasticPassDesc.nextInChain = nullptr;
+   stochasticPassDesc.label = "Stochastic Pass";
+   stochasticPassDesc.colorAttachmentCount = 1;
+   stochasticPassDesc.colorAttachments = &colorAttachment;
+   stochasticPassDesc.depthStencilAttachment = &depthAttachment;
+   stochasticPassDesc.timestampWrites = timestampWrites;
+   WGPURenderPassEncoder stochasticPassEncoder = wgpuCommandEncoderBeginRenderPass(encoder, &stochasticPassDesc);
+   wgpuRenderPassEncoderSetViewport(stochasticPassEncoder, 0.0f, 0.0f, static_cast<float>(renderSize.x), static_cast<float>(renderSize.y), 0.0f, 1.0f);
+   wgpuRenderPassEncoderSetScissorRect(stochasticPassEncoder, 0, 0, renderSize.x, renderSize.y);
+   if (pipelines != nullptr) {
+      wgpuRenderPassEncoderSetBindGroup(stochasticPassEncoder, 0, sceneBindGroup, 0, nullptr);
+      wgpuRenderPassEncoderSetBindGroup(stochasticPassEncoder, 1, frame.stateBindGroup, 0, nullptr);
+      wgpuRenderPassEncoderSetPipeline(stochasticPassEncoder, pipelines->stochasticRenderPipeline);
+      wgpuRenderPassEncoderDraw(stochasticPassEncoder, 4, splatSlots, 0, 0);
    }
-   avgPosition /= static_cast<float>(_rawSplatsData.size());
-   return avgPosition;
+   wgpuRenderPassEncoderEnd(stochasticPassEncoder);
+   wgpuRenderPassEncoderRelease(stochasticPassEncoder);
+
+   // Reprojects from the current depth to the view of the last accumulated frame.
+   TemporalUniforms temporalUniforms;
+   temporalUniforms.reprojection = _previousViewProjection * glm::inverse(_viewProjection);
+   temporalUniforms.renderSize = vec2(renderSize);
+   temporalUniforms.movingHistory = _stochasticMovingHistory;
+   temporalUniforms.maxHistory = StochasticMaxHistory;
+   temporalUniforms.reset = !_historyValid || _historyRenderSize != renderSize;
+   wgpuQueueWriteBuffer(_wgpuQueue, frame.temporalUniformBuffer, 0, &temporalUniforms, sizeof(TemporalUniforms));
+
+   // Reads one history texture and writes the other along with the displayed color.
+   WGPURenderPassColorAttachment temporalAttachments[2] = {};
+   temporalAttachments[0].view = _historyTextureViews[1 - _historyIndex];
+   temporalAttachments[0].resolveTarget = nullptr;
+   temporalAttachments[0].loadOp = WGPULoadOp_Clear;
+   temporalAttachments[0].storeOp = WGPUStoreOp_Store;
+   temporalAttachments[0].clearValue = WGPUColor{ 0.0, 0.0, 0.0, 0.0 };
+   temporalAttachments[1].view = _sceneTextureView;
+   temporalAttachments[1].resolveTarget = nullptr;
+   temporalAttachments[1].loadOp = WGPULoadOp_Clear;
+   temporalAttachments[1].storeOp = WGPUStoreOp_Store;
+   temporalAttachments[1].clearValue = WGPUColor{ 1.0, 1.0, 1.0, 1.0 };
+
+   WGPURenderPassDescriptor temporalPassDesc = {};
+   temporalPassDesc.nextInChain = nullptr;
+   temporalPassDesc.label = "Temporal Accumulation Pass";
+   temporalPassDesc.colorAttachmentCount = 2;
+   temporalPassDesc.colorAttachments = temporalAttachments;
+   temporalPassDesc.depthStencilAttachment = nullptr;
+   temporalPassDesc.timestampWrites = nullptr;
+   WGPURenderPassEncoder temporalPassEncoder = wgpuCommandEncoderBeginRenderPass(encoder, &temporalPassDesc);
+   wgpuRenderPassEncoderSetViewport(temporalPassEncoder, 0.0f, 0.0f, static_cast<float>(renderSize.x), static_cast<float>(renderSize.y), 0.0f, 1.0f);
+   wgpuRenderPassEncoderSetScissorRect(temporalPassEncoder, 0, 0, renderSize.x, renderSize.y);
+   wgpuRenderPassEncoderSetPipeline(temporalPassEncoder, _temporalPipeline);
+   wgpuRenderPassEncoderSetBindGroup(temporalPassEncoder, 0, _temporalTextureBindGroups[_historyIndex], 0, nullptr);
+   wgpuRenderPassEncoderSetBindGroup(temporalPassEncoder, 1, frame.temporalUniformBindGroup, 0, nullptr);
+   wgpuRenderPassEncoderDraw(temporalPassEncoder, 3, 1, 0, 0);
+   wgpuRenderPassEncoderEnd(temporalPassEncoder);
+   wgpuRenderPassEncoderRelease(temporalPassEncoder);
+
+   _historyIndex = 1 - _historyIndex;
+   _historyValid = true;
+   _historyRenderSize = renderSize;
+   _previousViewProjection = _viewProjection;
+   ++_stochasticFrame;
+}
+
+// Avg position of all splats, precomputed in the scene cache.
+vec4 Renderer::GetModelPosition() const {
+   return _modelMatrix * _scene->cache.GetHeader().centroid;
+}
+
+u32 Renderer::GetSHDegree() const {
+   return std::min(static_cast<u32>(std::max(_shDegreeCap, 0)), _scene->cache.GetHeader().shDegree);
 }
 
-bool Renderer::InitializeImGui(GLFWwindow* window)
+bool Renderer::InitializeImGui()
 {
+   TRACE_SCOPE("Renderer::InitializeImGui");
+   // No platform backend, GLFW is only called from the main thread and its input arrives through the UI event queue.
    ImGui::CreateContext();
-   ImGui_ImplGlfw_InitForOther(window, true);
+   ImGui::GetIO().BackendPlatformName = "UiEventQueue";
    ImGui::StyleColorsDark();
 
    WGPUMultisampleState multiSampleState = {};
@@ -291,27 +772,132 @@ bool Renderer::InitializeImGui(GLFWwindow* window)
 void Renderer::ReleaseImGui()
 {
    ImGui_ImplWGPU_Shutdown();
-   ImGui_ImplGlfw_Shutdown();
    ImGui::DestroyContext();
 }
 
 void Renderer::ImGuiBeginFrame()
 {
    ImGui_ImplWGPU_NewFrame();
-   ImGui_ImplGlfw_NewFrame();
+
+   // The window has a fixed size, only the input and the time step change between frames.
+   ImGuiIO& io = ImGui::GetIO();
+   UiEventQueue::GetInstance().Apply(io);
+   io.DisplaySize = ImVec2(static_cast<float>(_viewPortSize.x), static_cast<float>(_viewPortSize.y));
+   std::chrono::high_resolution_clock::time_point now = std::chrono::high_resolution_clock::now();
+   float deltaTime = std::chrono::duration<float>(now - _lastUiFrame).count();
+   io.DeltaTime = _lastUiFrame != std::chrono::high_resolution_clock::time_point() && deltaTime > 0.0f ? deltaTime : 1.0f / 60.0f;
+   _lastUiFrame = now;
    ImGui::NewFrame();
 }
 
+void Renderer::RenderCameraPathUI(const Camera& camera)
+{
+   if (Path == nullptr) {
+      return;
+   }
+
+   const std::filesystem::path pathFile = "../../../assets/paths/camera_path.txt";
+   if (Path->IsRecording()) {
+      if (ImGui::Button("Stop recording"))
+      {
+         Path->StopRecording(camera);
+      }
+      ImGui::SameLine();
+      ImGui::Text("%zu keyframes", Path->GetKeyframes().size());
+      return;
+   }
+   if (Path->IsPlaying()) {
+      if (ImGui::Button("Stop playback"))
+      {
+         Path->StopPlayback();
+      }
+      ImGui::SameLine();
+      ImGui::Text("Frame %u / %u", Path->GetPlaybackFrame(), Path->GetFrameCount());
+      return;
+   }
+
+   if (ImGui::Button("Record path"))
+   {
+      Path->StartRecording(camera);
+   }
+   ImGui::SameLine();
+   // Fixed timestep and render scale, so every playback renders the same frames.
+   if (ImGui::Button("Play path") && Path->StartPlayback())
+   {
+      _dynamicResolution = false;
+      _playbackActive = true;
+      _playbackFrameTimes.clear();
+      _playbackCapturing = _capturePlayback && !_frameCapture.IsCapturing() && _frameCapture.Start("../../../assets/captures", _captureFormat);
+   }
+   ImGui::SameLine();
+   if (ImGui::Button("Save path"))
+   {
+      Path->Save(pathFile);
+   }
+   ImGui::SameLine();
+   if (ImGui::Button("Load path"))
+   {
+      Path->Load(pathFile);
+   }
+   ImGui::Checkbox("Capture playback", &_capturePlayback);
+   if (!Path->GetKeyframes().empty())
+   {
+      ImGui::Text("Path: %zu keyframes, %.1f s", Path->GetKeyframes().size(), Path->GetDuration());
+   }
+   if (_playbackSummary.valid)
+   {
+      ImGui::Text("Playback: %.2f ms mean, %.2f p95, %.2f max", _playbackSummary.meanFrameTime, _playbackSummary.p95FrameTime, _playbackSummary.maxFrameTime);
+   }
+   if (_playbackSummary.missingFrames > 0)
+   {
+      ImGui::Text("Capture incomplete: %u frames missing", _playbackSummary.missingFrames);
+   }
+}
+
+void Renderer::FinishPlayback()
+{
+   _playbackActive = false;
+   _playbackSummary = {};
+   if (_playbackCapturing) {
+      _playbackCapturing = false;
+      _frameCapture.Stop();
+      // The sequence is only a replay of the path when it holds every frame.
+      _playbackSummary.missingFrames = _frameCapture.GetDroppedFrames() + _frameCapture.GetFailedFrames();
+      if (_playbackSummary.missingFrames > 0) {
+         std::cerr << "Playback capture is incomplete, " << _playbackSummary.missingFrames << " frames are missing from " << _frameCapture.GetDirectory() << std::endl;
+      }
+   }
+
+   if (_playbackFrameTimes.empty()) {
+      return;
+   }
+   std::vector<float> frameTimes = _playbackFrameTimes;
+   std::sort(frameTimes.begin(), frameTimes.end());
+   float totalTime = 0.0f;
+   for (float frameTime : frameTimes) {
+      totalTime += frameTime;
+   }
+   _playbackSummary.frameCount = static_cast<u32>(frameTimes.size());
+   _playbackSummary.meanFrameTime = totalTime / static_cast<float>(frameTimes.size());
+   _playbackSummary.p95FrameTime = frameTimes[(frameTimes.size() - 1) * 95 / 100];
+   _playbackSummary.maxFrameTime = frameTimes.back();
+   _playbackSummary.valid = true;
+   std::cout << "Camera path playback: " << _playbackSummary.frameCount << " frames, " << _playbackSummary.meanFrameTime << " ms mean, "
+             << _playbackSummary.p95FrameTime << " ms p95, " << _playbackSummary.maxFrameTime << " ms max" << std::endl;
+}
+
 void Renderer::ImGuiEndFrame(WGPURenderPassEncoder encoder)
 {
    ImGui::Render();
    ImGui_ImplWGPU_RenderDrawData(ImGui::GetDrawData(), encoder);
+   // Read by the main thread to keep the camera still while the UI is used.
+   UiEventQueue::GetInstance().SetWantCaptureMouse(ImGui::GetIO().WantCaptureMouse);
 }
 
-void Renderer::RenderImGuiUI()
+void Renderer::RenderImGuiUI(const Camera& camera)
 {
    ImVec2 screenSize = ImGui::GetIO().DisplaySize;
-   ImVec2 panelSize(250, 150);
+   ImVec2 panelSize(250, 410);
 
    ImGui::SetNextWindowPos(ImVec2(screenSize.x - panelSize.x - 10, 10), ImGuiCond_Always);
    ImGui::SetNextWindowSize(panelSize, ImGuiCond_Always);
@@ -319,34 +905,242 @@ void Renderer::RenderImGuiUI()
    ImGui::Begin("Performance Stats", nullptr, ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoCollapse);
 
    ImGui::Text("Point count: %d", static_cast<int>(_performanceData.pointCount));
+   ImGui::Text("Visible chunks: %d / %d (%d LOD)", static_cast<int>(_performanceData.visibleChunkCount), static_cast<int>(_performanceData.chunkCount), static_cast<int>(_performanceData.visibleLodChunkCount));
 
    ImGui::Separator();
 
    ImGui::Text("FPS: %.1f", ImGui::GetIO().Framerate);
    ImGui::Text("Frame time: %.2f ms", _performanceData.frameTime);
+   ImGui::Text("Drawn splats: %d", static_cast<int>(_performanceData.drawnSplatCount));
+   ImGui::Text("Culled: %d alpha, %d size", static_cast<int>(_performanceData.alphaCulledCount), static_cast<int>(_performanceData.sizeCulledCount));
+   ImGui::Text("Cull time: %.2f ms", _performanceData.cullTime);
+   ImGui::Text("Frame wait: %.2f ms", _performanceData.frameWaitTime);
+   if (_gpuTimer.IsEnabled()) {
+      ImGui::Text("CPU busy: %.0f%%, GPU busy: %.0f%%", _performanceData.cpuUtilization * 100.0f, _performanceData.gpuUtilization * 100.0f);
+   } else {
+      ImGui::Text("CPU busy: %.0f%%", _performanceData.cpuUtilization * 100.0f);
+   }
+   ImGui::Text("GPU SH: %.2f ms", _performanceData.gpuTimes[GPU_PASS_SH]);
+   ImGui::Text("GPU sort: %.2f ms", _performanceData.gpuTimes[GPU_PASS_TRANSFORM] + _performanceData.gpuTimes[GPU_PASS_SORT]);
+   ImGui::Text("GPU splats: %.2f ms", _performanceData.gpuTimes[GPU_PASS_SPLATS]);
+   ImGui::Text("Render scale: %.0f%%", _performanceData.renderScale * 100.0f);
+   ImGui::Text("Shader permutations: %d", static_cast<int>(_pipelineVariants.size()));
+   ImGui::Text("SH time: %.2f ms", _performanceData.shTime);
    ImGui::Text("Sort time: %.2f ms", _performanceData.sortTime);
    ImGui::Text("Render time: %.2f ms", _performanceData.renderTime);
-
+   ImGui::Text("Load time: %.0f ms (%.0f MB/s%s)", _performanceData.loadTime, _performanceData.loadThroughput, _performanceData.loadedFromCache ? ", cached" : "");
 
    ImGui::End();
 
-   ImGui::SetNextWindowPos(ImVec2(screenSize.x - panelSize.x - 10, 170), ImGuiCond_Always);
-   ImGui::SetNextWindowSize(panelSize, ImGuiCond_Always);
+   // The settings fill the rest of the window height and scroll when they do not fit.
+   ImVec2 settingsPanelSize(panelSize.x, std::max(screenSize.y - panelSize.y - 30, 100.0f));
+   ImGui::SetNextWindowPos(ImVec2(screenSize.x - panelSize.x - 10, panelSize.y + 20), ImGuiCond_Always);
+   ImGui::SetNextWindowSize(settingsPanelSize, ImGuiCond_Always);
 
    ImGui::Begin("Renderer Settings", nullptr, ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoCollapse);
 
-   // Get files in directory ../../../assets/.
-   std::vector<char*> files;
-   FileReader::GetFilesInDirectory("../../../assets/splats", files);
-
-   if (ImGui::Combo("Splat file name:", &SelectedFileIndex, files.data(), static_cast<int>(files.size())))
+   // Scene files from the catalog snapshot, the directory is only scanned when it changes.
+   const SceneCatalogSnapshot& catalog = *_catalogSnapshot;
+   bool selectionValid = SelectedFileIndex >= 0 && SelectedFileIndex < static_cast<int>(catalog.entries.size());
+   if (ImGui::BeginCombo("Splat file name:", selectionValid ? catalog.entries[SelectedFileIndex].name.c_str() : ""))
+   {
+      // Each entry shows its thumbnail once it was rendered.
+      for (int i = 0; i < static_cast<int>(catalog.entries.size()); ++i)
+      {
+         const SceneCatalogEntry& entry = catalog.entries[i];
+         ImGui::PushID(i);
+         bool selected = i == SelectedFileIndex;
+         if (ImGui::Selectable("##scene", selected, 0, ImVec2(0.0f, ThumbnailListSize)))
+         {
+            SelectedFileIndex = i;
+            SelectedFile = entry.name;
+            RequestScene(entry.path);
+         }
+         ImGui::SameLine();
+         ShowThumbnail(entry, ThumbnailListSize);
+         ImGui::SameLine();
+         ImGui::TextUnformatted(entry.name.c_str());
+         if (selected)
+         {
+            ImGui::SetItemDefaultFocus();
+         }
+         ImGui::PopID();
+      }
+      ImGui::EndCombo();
+   }
+   if (selectionValid)
+   {
+      const SceneCatalogEntry& entry = catalog.entries[SelectedFileIndex];
+      ShowThumbnail(entry, static_cast<float>(ThumbnailCache::Size));
+      ImGui::SameLine();
+      ImGui::BeginGroup();
+      if (entry.valid)
+      {
+         vec3 extent = entry.boundsMax - entry.boundsMin;
+         ImGui::Text("%s, %.2fM splats", SceneFormatNames[entry.format], static_cast<double>(entry.splatCount) / 1e6);
+         ImGui::Text("SH %u, %.0f MB", entry.shDegree, static_cast<double>(entry.fileSize) / (1024.0 * 1024.0));
+         ImGui::Text("Extent: %.1f x %.1f x %.1f", extent.x, extent.y, extent.z);
+      }
+      else
+      {
+         ImGui::Text("Unreadable %s file", SceneFormatNames[entry.format]);
+      }
+      ImGui::EndGroup();
+   }
+   if (_requestedScene != SceneCache::InvalidHash)
    {
-      ChangeSplatsFlag = true;
-      SelectedFile = files[SelectedFileIndex];
+      ImGui::Text("Loading scene...");
    }
+   // Recently shown scenes stay on the GPU up to the budget, applied when enter is pressed.
+   ImGui::InputInt("Scene budget (MB)", &_sceneBudgetMB, 0, 0, ImGuiInputTextFlags_EnterReturnsTrue);
+   ImGui::Text("Resident scenes: %u (%.0f MB)", _residentScenes.GetResidentCount(),
+               static_cast<float>(_residentScenes.GetResidentSize()) / (1024.0f * 1024.0f));
 
    ImGui::SliderFloat("Splat Size", &_splatScale, 0.02f, 1.2f, "%.2f");
+   ImGui::SliderInt("SH degree", &_shDegreeCap, 0, 3);
+   // Each workgroup size and sort variant is a separate shader permutation.
+   const char* workGroupSizes[] = { "64", "128", "256" };
+   int workGroupSizeIndex = std::countr_zero(_tuning.workGroupSize) - 6;
+   if (ImGui::Combo("Workgroup size", &workGroupSizeIndex, workGroupSizes, 3))
+   {
+      _tuning.workGroupSize = 64u << workGroupSizeIndex;
+   }
+   const char* sortAlgorithms[] = { "Global", "Shared" };
+   int sortAlgorithm = _tuning.sortAlgorithm;
+   if (ImGui::Combo("Sort", &sortAlgorithm, sortAlgorithms, SORT_ALGORITHM_COUNT))
+   {
+      _tuning.sortAlgorithm = static_cast<ESortAlgorithm>(sortAlgorithm);
+   }
+   if (_tuning.sortAlgorithm == SORT_ALGORITHM_SHARED)
+   {
+      const char* keysPerThread[] = { "2", "4" };
+      int keysPerThreadIndex = _tuning.keysPerThread == 4 ? 1 : 0;
+      if (ImGui::Combo("Keys per thread", &keysPerThreadIndex, keysPerThread, 2))
+      {
+         _tuning.keysPerThread = 2u << keysPerThreadIndex;
+      }
+   }
+   // Benchmarks all candidates on the next frame and saves the fastest for this adapter.
+   if (ImGui::Button("Autotune"))
+   {
+      _autotuneRequested = true;
+   }
+   if (!_tuningResults.empty())
+   {
+      ImGui::SameLine();
+      ImGui::Text("%.2f ms", std::min_element(_tuningResults.begin(), _tuningResults.end(),
+         [](const TuningResult& a, const TuningResult& b) { return a.time < b.time; })->time);
+   }
    ImGui::Checkbox("Free camera", &FreeCamera);
+   ImGui::Checkbox("Chunk culling", &_chunkCulling);
+   ImGui::Checkbox("Level of detail", &_lodEnabled);
+   ImGui::SliderFloat("LOD error (px)", &_lodPixelError, 0.25f, 8.0f);
+   ImGui::SliderFloat("Min alpha", &_alphaThreshold, 0.0f, 0.2f, "%.3f");
+   ImGui::SliderFloat("Min pixel area", &_pixelAreaThreshold, 0.0f, 4.0f, "%.2f");
+   // The unsorted modes skip the sort, the comparison renders the current view in every mode.
+   const char* renderModes[] = { "Sorted", "Weighted OIT", "Stochastic" };
+   int renderMode = _renderMode;
+   if (ImGui::Combo("Compositing", &renderMode, renderModes, RENDER_MODE_COUNT))
+   {
+      _renderMode = static_cast<ERenderMode>(renderMode);
+   }
+   if (_renderMode == RENDER_MODE_STOCHASTIC) {
+      ImGui::SliderFloat("Moving history", &_stochasticMovingHistory, 1.0f, 32.0f, "%.0f frames");
+   }
+   if (ImGui::Button("Compare modes"))
+   {
+      _compareRequested = true;
+   }
+   if (_modeComparison.valid)
+   {
+      ImGui::Text("Sorted: %.2f ms", _modeComparison.times[RENDER_MODE_SORTED]);
+      ImGui::Text("OIT: %.2f ms, %.1f dB", _modeComparison.times[RENDER_MODE_WEIGHTED_OIT], _modeComparison.psnr[RENDER_MODE_WEIGHTED_OIT]);
+      ImGui::Text("OIT error: %.2f mean, %.0f max", _modeComparison.meanError[RENDER_MODE_WEIGHTED_OIT], _modeComparison.maxError[RENDER_MODE_WEIGHTED_OIT]);
+      ImGui::Text("Stochastic: %.2f ms, %.1f dB", _modeComparison.times[RENDER_MODE_STOCHASTIC], _modeComparison.psnr[RENDER_MODE_STOCHASTIC]);
+      ImGui::Text("Stochastic error: %.2f mean, %.0f max", _modeComparison.meanError[RENDER_MODE_STOCHASTIC], _modeComparison.maxError[RENDER_MODE_STOCHASTIC]);
+   }
+
+   // Image sequence of the displayed frames, written while rendering continues.
+   const char* captureFormats[] = { "PNG", "Raw RGBA" };
+   int captureFormat = _captureFormat;
+   if (ImGui::Combo("Capture format", &captureFormat, captureFormats, CAPTURE_FORMAT_COUNT))
+   {
+      _captureFormat = static_cast<ECaptureFormat>(captureFormat);
+   }
+   if (!_frameCapture.IsCapturing())
+   {
+      // A fixed render scale keeps every frame of the sequence the same size.
+      if (ImGui::Button("Start capture") && _frameCapture.Start("../../../assets/captures", _captureFormat))
+      {
+         _dynamicResolution = false;
+      }
+   }
+   else if (ImGui::Button("Stop capture"))
+   {
+      _frameCapture.Stop();
+   }
+   if (_frameCapture.GetCapturedFrames() > 0)
+   {
+      ImGui::Text("Frames: %u captured, %u written, %u dropped", _frameCapture.GetCapturedFrames(), _frameCapture.GetWrittenFrames(),
+                  _frameCapture.GetDroppedFrames() + _frameCapture.GetFailedFrames());
+   }
+
+   RenderCameraPathUI(camera);
+
+   // Offline render of the current view at any size, written next to the scene cache.
+   ImGui::InputInt("Tiled width", &_tiledRenderWidth, 1024);
+   ImGui::InputInt("Tiled height", &_tiledRenderHeight, 1024);
+   _tiledRenderWidth = std::clamp(_tiledRenderWidth, 1, 65536);
+   _tiledRenderHeight = std::clamp(_tiledRenderHeight, 1, 65536);
+   if (ImGui::Button("Render tiled"))
+   {
+      _tiledRenderRequested = true;
+   }
+   ImGui::Checkbox("Dynamic resolution", &_dynamicResolution);
+   if (_dynamicResolution) {
+      ImGui::SliderFloat("Target FPS", &_targetFps, 30.0f, 144.0f, "%.0f");
+   } else {
+      ImGui::SliderFloat("Render scale", &_renderScale, _minRenderScale, 1.0f, "%.2f");
+   }
+
+   // Traces are written next to the scene cache.
+   bool tracing = Tracer::GetInstance().IsEnabled();
+   if (ImGui::Checkbox("Record trace", &tracing))
+   {
+      Tracer::GetInstance().SetEnabled(tracing);
+   }
+   if (tracing)
+   {
+      ImGui::SameLine();
+      if (ImGui::Button("Save"))
+      {
+         Tracer::GetInstance().Export("../../../assets/traces/trace.json");
+      }
+   }
+
+   // Load-time options load the current scene again, each set of options is a separate resident scene.
+   if (ImGui::Checkbox("Spatial reorder", &ProcessingOptions.spatialReorder))
+   {
+      RequestScene(_requestedPath);
+   }
+   if (ImGui::Checkbox("Prune splats", &ProcessingOptions.prune))
+   {
+      RequestScene(_requestedPath);
+   }
+   // Pruning threshold on opacity times volume^(2/3), applied when enter is pressed.
+   if (ImGui::InputFloat("Min importance", &ProcessingOptions.minImportance, 0.0f, 0.0f, "%.2e", ImGuiInputTextFlags_EnterReturnsTrue))
+   {
+      ProcessingOptions.minImportance = std::max(ProcessingOptions.minImportance, 0.0f);
+      RequestScene(_requestedPath);
+   }
+
+   // Budget in thousands of splats, applied when enter is pressed.
+   int splatBudget = static_cast<int>(ProcessingOptions.splatBudget / 1000);
+   if (ImGui::InputInt("Splat budget (k)", &splatBudget, 0, 0, ImGuiInputTextFlags_EnterReturnsTrue))
+   {
+      ProcessingOptions.splatBudget = static_cast<u32>(std::max(splatBudget, 0)) * 1000;
+      RequestScene(_requestedPath);
+   }
 
    ImGui::End();
 }
@@ -421,7 +1215,7 @@ bool Renderer::GetAdapterAndDevice() {
       data.requestEnded = true;
    };
 
-   WGPUFeatureName requiredFeatures[] = { (WGPUFeatureName)WGPUNativeFeature_VertexWritableStorage };
+   std::vector<WGPUFeatureName> requiredFeatures = { (WGPUFeatureName)WGPUNativeFeature_VertexWritableStorage };
    for (auto feature : requiredFeatures) {
       if (!wgpuAdapterHasFeature(_wgpuAdapter, feature)) {
          std::cerr << "Adapter does not support required feature!" << std::endl;
@@ -429,6 +1223,12 @@ bool Renderer::GetAdapterAndDevice() {
       }
    }
 
+   // Optional, GPU pass timings are only available with timestamp queries.
+   _timestampQueriesSupported = wgpuAdapterHasFeature(_wgpuAdapter, WGPUFeatureName_TimestampQuery);
+   if (_timestampQueriesSupported) {
+      requiredFeatures.push_back(WGPUFeatureName_TimestampQuery);
+   }
+
    auto deviceLostCallback = [](WGPUDeviceLostReason reason, char const* message, void*) {
       std::cout << "Device lost: reason " << reason;
       if (message) std::cout << " (" << message << ")";
@@ -442,8 +1242,8 @@ bool Renderer::GetAdapterAndDevice() {
    WGPUDeviceDescriptor deviceDesc = {};
    deviceDesc.nextInChain = nullptr;
    deviceDesc.label = "WGPU Device";
-   deviceDesc.requiredFeatureCount = 1;
-   deviceDesc.requiredFeatures = requiredFeatures;
+   deviceDesc.requiredFeatureCount = requiredFeatures.size();
+   deviceDesc.requiredFeatures = requiredFeatures.data();
    deviceDesc.defaultQueue.nextInChain = nullptr;
    deviceDesc.defaultQueue.label = "Default queue";
    deviceDesc.deviceLostCallback = deviceLostCallback;
@@ -509,100 +1309,43 @@ void Renderer::ConfigureSurface()
    wgpuSurfaceConfigure(_wgpuSurface, &surfaceConfig);
 }
 
-void Renderer::InitializeBuffers()
+// Layouts only use per-element binding sizes, so they and the pipelines can be created before the scene is loaded.
+void Renderer::InitializeBindGroupLayouts()
 {
-   _splatsData = _rawSplatsData;
-
-   // Splat buffer.
-   WGPUBufferDescriptor splatsBufferDesc = {};
-   splatsBufferDesc.nextInChain = nullptr;
-   splatsBufferDesc.label = "Splat Buffer";
-   splatsBufferDesc.usage = WGPUBufferUsage_Storage | WGPUBufferUsage_CopyDst;
-   splatsBufferDesc.size = sizeof(Splat) * _splatsData.size();
-   _splatsBuffer = wgpuDeviceCreateBuffer(_wgpuDevice, &splatsBufferDesc);
-   wgpuQueueWriteBuffer(_wgpuQueue, _splatsBuffer, 0, _splatsData.data(), splatsBufferDesc.size);
+   // Scene bind group layout entries.
+   WGPUBindGroupLayoutEntry sceneBGLEntries[3] = {};
+   setDefault(sceneBGLEntries[0]);
+   sceneBGLEntries[0].binding = 0;
+   sceneBGLEntries[0].visibility = WGPUShaderStage_Compute | WGPUShaderStage_Vertex;
+   sceneBGLEntries[0].buffer.type = WGPUBufferBindingType_ReadOnlyStorage;
+   sceneBGLEntries[0].buffer.minBindingSize = sizeof(Splat);
+   sceneBGLEntries[0].buffer.hasDynamicOffset = false;
+   setDefault(sceneBGLEntries[1]);
+   sceneBGLEntries[1].binding = 1;
+   sceneBGLEntries[1].visibility = WGPUShaderStage_Compute;
+   sceneBGLEntries[1].buffer.type = WGPUBufferBindingType_ReadOnlyStorage;
+   sceneBGLEntries[1].buffer.minBindingSize = sizeof(u32);
+   setDefault(sceneBGLEntries[2]);
+   sceneBGLEntries[2].binding = 2;
+   sceneBGLEntries[2].visibility = WGPUShaderStage_Compute | WGPUShaderStage_Vertex;
+   sceneBGLEntries[2].buffer.type = WGPUBufferBindingType_Storage;
+   sceneBGLEntries[2].buffer.minBindingSize = sizeof(u32);
 
-   // Sorted splat buffer.
-   WGPUBufferDescriptor sortedSplatsBufferDesc = {};
-   sortedSplatsBufferDesc.nextInChain = nullptr;
-   sortedSplatsBufferDesc.label = "Sorted Splat Buffer";
-   sortedSplatsBufferDesc.usage = WGPUBufferUsage_Storage | WGPUBufferUsage_CopyDst;
-   sortedSplatsBufferDesc.size = sizeof(SortSplatsData) * _splatsData.size();
-   _sortedSplatsBuffer = wgpuDeviceCreateBuffer(_wgpuDevice, &sortedSplatsBufferDesc);
-   wgpuQueueWriteBuffer(_wgpuQueue, _sortedSplatsBuffer, 0, _splatsData.data(), sortedSplatsBufferDesc.size);
-
-   // Sort splats params data.
-   WGPUBufferDescriptor sortSplatsParamsBufferDesc = {};
-   sortSplatsParamsBufferDesc.label = "Sort Splats params array";
-   sortSplatsParamsBufferDesc.size = _sortSplatsParamsData.size() * sizeof(uvec2);
-   sortSplatsParamsBufferDesc.usage = WGPUBufferUsage_Storage | WGPUBufferUsage_CopySrc | WGPUBufferUsage_CopyDst;
-   sortSplatsParamsBufferDesc.mappedAtCreation = false;
-   _sortSplatsParamsDataBuffer = wgpuDeviceCreateBuffer(_wgpuDevice, &sortSplatsParamsBufferDesc);
-   wgpuQueueWriteBuffer(_wgpuQueue, _sortSplatsParamsDataBuffer, 0, _sortSplatsParamsData.data(), _sortSplatsParamsData.size() * sizeof(uvec2));
-
-   // Sort splats params uniform.
-   WGPUBufferDescriptor sortSplatsParamsUniformBufferDesc = {};
-   sortSplatsParamsUniformBufferDesc.label = "Sort Splats params uniform";
-   sortSplatsParamsUniformBufferDesc.size = sizeof(uvec2);
-   sortSplatsParamsUniformBufferDesc.usage = WGPUBufferUsage_Uniform | WGPUBufferUsage_CopyDst;
-   sortSplatsParamsUniformBufferDesc.mappedAtCreation = false;
-   _sortSplatsParamsUniform = wgpuDeviceCreateBuffer(_wgpuDevice, &sortSplatsParamsUniformBufferDesc);
-
-   // Uniform buffer.
-   WGPUBufferDescriptor uniformBufferDesc = {};
-   uniformBufferDesc.label = "WGPU Uniform Buffer";
-   uniformBufferDesc.size = sizeof(ShaderUniforms);
-   uniformBufferDesc.usage = WGPUBufferUsage_Uniform | WGPUBufferUsage_CopyDst;
-   uniformBufferDesc.mappedAtCreation = false;
-   _uniformBuffer = wgpuDeviceCreateBuffer(_wgpuDevice, &uniformBufferDesc);
-   ShaderUniforms uniforms = {};
-   uniforms.model = _modelMatrix;
-   uniforms.view = mat4x4(1.0f);
-   uniforms.projection = mat4x4(1.0f);
-   uniforms.splatScale = _splatScale;
-   wgpuQueueWriteBuffer(_wgpuQueue, _uniformBuffer, 0, &uniforms, uniformBufferDesc.size);
-
-   // Scene bind group layout entries.
-   WGPUBindGroupLayoutEntry sceneBGLEntries = {};
-   setDefault(sceneBGLEntries);
-   sceneBGLEntries.binding = 0;
-   sceneBGLEntries.visibility = WGPUShaderStage_Compute | WGPUShaderStage_Vertex;
-   sceneBGLEntries.buffer.type = WGPUBufferBindingType_ReadOnlyStorage;
-   sceneBGLEntries.buffer.minBindingSize = sizeof(Splat) * _splatsData.size();
-   sceneBGLEntries.buffer.hasDynamicOffset = false;
-
-   // Scene bind group layout.
-   WGPUBindGroupLayoutDescriptor sceneBGLDesc = {};
-   sceneBGLDesc.nextInChain = nullptr;
-   sceneBGLDesc.label = "Scene Bind Group Layout";
-   sceneBGLDesc.entryCount = 1;
-   sceneBGLDesc.entries = &sceneBGLEntries;
-   _sceneBindGroupLayout = wgpuDeviceCreateBindGroupLayout(_wgpuDevice, &sceneBGLDesc);
-
-   // Scene binding.
-   WGPUBindGroupEntry sceneBGEntries = {};
-   sceneBGLEntries.nextInChain = nullptr;
-   sceneBGEntries.binding = 0;
-   sceneBGEntries.buffer = _splatsBuffer;
-   sceneBGEntries.offset = 0;
-   sceneBGEntries.size = sizeof(Splat) * _splatsData.size();
-
-   // Scene bind group.
-   WGPUBindGroupDescriptor sceneBGDesc = {};
-   sceneBGDesc.nextInChain = nullptr;
-   sceneBGDesc.label = "Scene Bind Group";
-   sceneBGDesc.layout = _sceneBindGroupLayout;
-   sceneBGDesc.entryCount = 1;
-   sceneBGDesc.entries = &sceneBGEntries;
-   _sceneBindGroup = wgpuDeviceCreateBindGroup(_wgpuDevice, &sceneBGDesc);
+   // Scene bind group layout.
+   WGPUBindGroupLayoutDescriptor sceneBGLDesc = {};
+   sceneBGLDesc.nextInChain = nullptr;
+   sceneBGLDesc.label = "Scene Bind Group Layout";
+   sceneBGLDesc.entryCount = 3;
+   sceneBGLDesc.entries = sceneBGLEntries;
+   _sceneBindGroupLayout = wgpuDeviceCreateBindGroupLayout(_wgpuDevice, &sceneBGLDesc);
 
    // State bind group layout entries.
-   WGPUBindGroupLayoutEntry stateBGLEntries[4] = {};
+   WGPUBindGroupLayoutEntry stateBGLEntries[6] = {};
    setDefault(stateBGLEntries[0]);
    stateBGLEntries[0].binding = 0;
    stateBGLEntries[0].visibility = WGPUShaderStage_Compute | WGPUShaderStage_Vertex;
    stateBGLEntries[0].buffer.type = WGPUBufferBindingType_Storage;
-   stateBGLEntries[0].buffer.minBindingSize = sizeof(SortSplatsData) * _splatsData.size();
+   stateBGLEntries[0].buffer.minBindingSize = sizeof(SortSplatsData);
    stateBGLEntries[0].buffer.hasDynamicOffset = false;
    setDefault(stateBGLEntries[1]);
    stateBGLEntries[1].binding = 1;
@@ -613,64 +1356,448 @@ void Renderer::InitializeBuffers()
    stateBGLEntries[2].binding = 2;
    stateBGLEntries[2].visibility = WGPUShaderStage_Compute;
    stateBGLEntries[2].buffer.type = WGPUBufferBindingType_ReadOnlyStorage;
-   stateBGLEntries[2].buffer.minBindingSize = _sortSplatsParamsData.size() * sizeof(uvec2);
+   stateBGLEntries[2].buffer.minBindingSize = sizeof(uvec2);
    setDefault(stateBGLEntries[3]);
    stateBGLEntries[3].binding = 3;
    stateBGLEntries[3].visibility = WGPUShaderStage_Compute;
    stateBGLEntries[3].buffer.type = WGPUBufferBindingType_Uniform;
    stateBGLEntries[3].buffer.minBindingSize = sizeof(uvec2);
+   setDefault(stateBGLEntries[4]);
+   stateBGLEntries[4].binding = 4;
+   stateBGLEntries[4].visibility = WGPUShaderStage_Compute;
+   stateBGLEntries[4].buffer.type = WGPUBufferBindingType_ReadOnlyStorage;
+   stateBGLEntries[4].buffer.minBindingSize = sizeof(u32);
+   setDefault(stateBGLEntries[5]);
+   stateBGLEntries[5].binding = 5;
+   stateBGLEntries[5].visibility = WGPUShaderStage_Compute;
+   stateBGLEntries[5].buffer.type = WGPUBufferBindingType_Storage;
+   stateBGLEntries[5].buffer.minBindingSize = sizeof(CullStats);
 
    // State bind group layout.
    WGPUBindGroupLayoutDescriptor stateBGLDesc = {};
    stateBGLDesc.nextInChain = nullptr;
    stateBGLDesc.label = "State Bind Group Layout";
-   stateBGLDesc.entryCount = 4;
+   stateBGLDesc.entryCount = 6;
    stateBGLDesc.entries = stateBGLEntries;
    _stateBindGroupLayout = wgpuDeviceCreateBindGroupLayout(_wgpuDevice, &stateBGLDesc);
 
-   // State binding.
-   WGPUBindGroupEntry stateBGEntries[4] = {};
+   // Create a pipeline layout for all pipelines to use.
+   WGPUBindGroupLayout bgLayouts[2] = { _sceneBindGroupLayout, _stateBindGroupLayout };
+
+   WGPUPipelineLayoutDescriptor pipelineLayoutDesc = {};
+   pipelineLayoutDesc.nextInChain = nullptr;
+   pipelineLayoutDesc.label = "WGPU Pipeline Layout";
+   pipelineLayoutDesc.bindGroupLayoutCount = 2;
+   pipelineLayoutDesc.bindGroupLayouts = bgLayouts;
+   _wgpuPipelineLayout = wgpuDeviceCreatePipelineLayout(_wgpuDevice, &pipelineLayoutDesc);
+}
+
+void Renderer::InitializeBuffers()
+{
+   TRACE_SCOPE("Renderer::InitializeBuffers");
+   WGPUBufferDescriptor cullStatsReadbackBufferDesc = {};
+   cullStatsReadbackBufferDesc.nextInChain = nullptr;
+   cullStatsReadbackBufferDesc.label = "Cull Stats Readback Buffer";
+   cullStatsReadbackBufferDesc.usage = WGPUBufferUsage_MapRead | WGPUBufferUsage_CopyDst;
+   cullStatsReadbackBufferDesc.size = sizeof(CullStats);
+   _cullStatsReadbackBuffer = wgpuDeviceCreateBuffer(_wgpuDevice, &cullStatsReadbackBufferDesc);
+}
+
+void Renderer::ReserveFrameBuffers(u32 sortCapacity, u32 chunkCount)
+{
+   if (sortCapacity <= _sortCapacity && chunkCount <= _chunkCapacity) {
+      return;
+   }
+
+   TRACE_SCOPE("Renderer::ReserveFrameBuffers");
+   if (_sortSplatsParamsDataBuffer) {
+      // Frames still in flight use the buffers replaced below.
+      wgpuDevicePoll(_wgpuDevice, true, nullptr);
+      for (FrameResources& frame : _frames) {
+         ReleaseFrameBuffers(frame);
+         frame.submitted = false;
+      }
+      wgpuBufferRelease(_sortSplatsParamsDataBuffer);
+   }
+   _sortCapacity = std::max(_sortCapacity, sortCapacity);
+   _chunkCapacity = std::max(_chunkCapacity, chunkCount);
+
+   // Sort splats params data, sized for the longest schedule and rewritten when the schedule changes.
+   WGPUBufferDescriptor sortSplatsParamsBufferDesc = {};
+   sortSplatsParamsBufferDesc.label = "Sort Splats params array";
+   sortSplatsParamsBufferDesc.size = SortSchedule::GetMaxStepCount(_sortCapacity) * sizeof(uvec2);
+   sortSplatsParamsBufferDesc.usage = WGPUBufferUsage_Storage | WGPUBufferUsage_CopySrc | WGPUBufferUsage_CopyDst;
+   sortSplatsParamsBufferDesc.mappedAtCreation = false;
+   _sortSplatsParamsDataBuffer = wgpuDeviceCreateBuffer(_wgpuDevice, &sortSplatsParamsBufferDesc);
+   _sortSchedule = SortSchedule();
+   UpdateSortSchedule();
+
+   // Buffers and state bind groups, one set per frame in flight.
+   for (FrameResources& frame : _frames) {
+      InitializeFrameBuffers(frame, _sortCapacity, _chunkCapacity, _sortSplatsParamsDataBuffer);
+   }
+}
+
+void Renderer::UploadScene(ResidentScene& scene) const
+{
+   TRACE_SCOPE("Renderer::UploadScene");
+   const SceneCacheHeader& sceneHeader = scene.cache.GetHeader();
+
+   // Splat buffer, uploaded straight from the scene cache.
+   WGPUBufferDescriptor splatsBufferDesc = {};
+   splatsBufferDesc.nextInChain = nullptr;
+   splatsBufferDesc.label = "Splat Buffer";
+   splatsBufferDesc.usage = WGPUBufferUsage_Storage | WGPUBufferUsage_CopyDst;
+   splatsBufferDesc.size = sizeof(Splat) * sceneHeader.splatRecordCount;
+   scene.splatsBuffer = wgpuDeviceCreateBuffer(_wgpuDevice, &splatsBufferDesc);
+   wgpuQueueWriteBuffer(_wgpuQueue, scene.splatsBuffer, 0, scene.cache.GetSplats(), splatsBufferDesc.size);
+
+   // SH coefficients buffer, kept at a minimal size when the scene has no view dependent color.
+   WGPUBufferDescriptor shCoefficientsBufferDesc = {};
+   shCoefficientsBufferDesc.nextInChain = nullptr;
+   shCoefficientsBufferDesc.label = "SH Coefficients Buffer";
+   shCoefficientsBufferDesc.usage = WGPUBufferUsage_Storage | WGPUBufferUsage_CopyDst;
+   shCoefficientsBufferDesc.size = std::max<size_t>(sizeof(u32) * sceneHeader.shWordsPerSplat * sceneHeader.splatRecordCount, sizeof(u32));
+   scene.shCoefficientsBuffer = wgpuDeviceCreateBuffer(_wgpuDevice, &shCoefficientsBufferDesc);
+   if (sceneHeader.shDegree > 0) {
+      wgpuQueueWriteBuffer(_wgpuQueue, scene.shCoefficientsBuffer, 0, scene.cache.GetSHCoefficients(), shCoefficientsBufferDesc.size);
+   }
+
+   // Splat colors evaluated by the SH pass.
+   WGPUBufferDescriptor splatColorsBufferDesc = {};
+   splatColorsBufferDesc.nextInChain = nullptr;
+   splatColorsBufferDesc.label = "Splat Colors Buffer";
+   splatColorsBufferDesc.usage = WGPUBufferUsage_Storage;
+   splatColorsBufferDesc.size = sceneHeader.shDegree > 0 ? sizeof(u32) * sceneHeader.splatRecordCount : sizeof(u32);
+   scene.splatColorsBuffer = wgpuDeviceCreateBuffer(_wgpuDevice, &splatColorsBufferDesc);
+
+   scene.bindGroup = CreateSceneBindGroup(scene.splatsBuffer, scene.shCoefficientsBuffer, scene.splatColorsBuffer);
+   scene.gpuSize = scene.GetGpuSize();
+}
+
+void Renderer::ShowScene(ResidentScene* scene)
+{
+   TRACE_SCOPE("Renderer::ShowScene");
+   _scene = scene;
+   _scene->lastUsed = ++_sceneUseCount;
+   const SceneCacheHeader& header = _scene->cache.GetHeader();
+   _performanceData.pointCount = static_cast<uint32>(header.splatCount);
+   _performanceData.chunkCount = header.chunkCount;
+   _performanceData.loadTime = _scene->loadTime;
+   _performanceData.loadThroughput = _scene->loadThroughput;
+   _performanceData.loadedFromCache = _scene->loadedFromCache;
+   _visibleChunks.reserve(header.chunkCount);
+
+   // Frames only run the sort steps needed for the visible splats, the capacity fits every tuning candidate.
+   // The frame buffers only grow, switching to a smaller scene keeps them.
+   u32 sortCapacity = std::max<u32>(std::bit_ceil(static_cast<u32>(header.splatCount)), Autotuner::MaxSortBlockSize);
+   ReserveFrameBuffers(sortCapacity, std::max<u32>(header.chunkCount, 1));
+
+   // The accumulated history shows the previous scene.
+   _historyValid = false;
+}
+
+void Renderer::RequestScene(const std::filesystem::path& path)
+{
+   u64 key = ResidentSceneCache::GetKey(path, ProcessingOptions);
+   if (key == SceneCache::InvalidHash) {
+      // Keep showing the current scene.
+      std::cerr << "Failed to read scene file: " << path << std::endl;
+      return;
+   }
+   _requestedPath = path;
+   _requestedScene = key;
+   if (_scene != nullptr && _scene->key == _requestedScene) {
+      _requestedScene = SceneCache::InvalidHash;
+      return;
+   }
+   _residentScenes.Request(path, ProcessingOptions, false);
+}
+
+void Renderer::UpdateResidentScenes()
+{
+   TRACE_SCOPE("Renderer::UpdateResidentScenes");
+   _residentScenes.SetBudget(static_cast<u64>(std::max(_sceneBudgetMB, 0)) * 1024 * 1024);
+   for (LoadedScene& loaded : _residentScenes.TakeLoaded()) {
+      bool requested = loaded.key == _requestedScene;
+      if (!loaded.scene) {
+         // The loader reported the error, keep showing the current scene.
+         if (requested) {
+            _requestedScene = SceneCache::InvalidHash;
+            _requestedPath = _scene->path;
+         }
+         continue;
+      }
+
+      // Prefetched scenes only use free budget, the requested one evicts the least recently shown scenes.
+      if (!_residentScenes.MakeRoom(loaded.scene->GetGpuSize(), _scene, !requested) && !requested) {
+         continue;
+      }
+      UploadScene(*_residentScenes.Insert(std::move(loaded.scene)));
+   }
+
+   if (_requestedScene != SceneCache::InvalidHash) {
+      if (ResidentScene* scene = _residentScenes.Find(_requestedScene)) {
+         _requestedScene = SceneCache::InvalidHash;
+         ShowScene(scene);
+         PrefetchNeighbours();
+      }
+   }
+
+   // Also applies a lowered budget, the shown scene is kept even when it alone exceeds it.
+   _residentScenes.MakeRoom(0, _scene, false);
+}
+
+void Renderer::UpdateCatalog()
+{
+   u32 version = _catalog.GetVersion();
+   if (version == _catalogVersion) {
+      return;
+   }
+   _catalogVersion = version;
+   _catalogSnapshot = _catalog.GetSnapshot();
+   PrefetchNeighbours();
+
+   // Only new or changed files are rendered, the others come from the thumbnail cache.
+   for (const SceneCatalogEntry& entry : _catalogSnapshot->entries) {
+      if (entry.valid) {
+         _thumbnails.Request(entry.path, entry.modified);
+      }
+   }
+}
+
+void Renderer::UpdateThumbnails()
+{
+   for (Thumbnail& thumbnail : _thumbnails.TakeReady()) {
+      ThumbnailTexture& texture = _thumbnailTextures[thumbnail.name];
+      if (texture.texture == nullptr) {
+         WGPUTextureDescriptor textureDesc = {};
+         textureDesc.nextInChain = nullptr;
+         textureDesc.label = "Thumbnail Texture";
+         textureDesc.usage = WGPUTextureUsage_TextureBinding | WGPUTextureUsage_CopyDst;
+         textureDesc.dimension = WGPUTextureDimension_2D;
+         textureDesc.size = { ThumbnailCache::Size, ThumbnailCache::Size, 1 };
+         textureDesc.format = WGPUTextureFormat_RGBA8Unorm;
+         textureDesc.mipLevelCount = 1;
+         textureDesc.sampleCount = 1;
+         textureDesc.viewFormatCount = 0;
+         textureDesc.viewFormats = nullptr;
+         texture.texture = wgpuDeviceCreateTexture(_wgpuDevice, &textureDesc);
+         texture.view = CreateTextureView(texture.texture);
+      }
+      texture.modified = thumbnail.modified;
+
+      // A changed file overwrites the preview of its previous contents in place.
+      WGPUImageCopyTexture destination = {};
+      destination.texture = texture.texture;
+      destination.mipLevel = 0;
+      destination.origin = { 0, 0, 0 };
+      destination.aspect = WGPUTextureAspect_All;
+      WGPUTextureDataLayout layout = {};
+      layout.offset = 0;
+      layout.bytesPerRow = ThumbnailCache::Size * 4;
+      layout.rowsPerImage = ThumbnailCache::Size;
+      WGPUExtent3D size = { ThumbnailCache::Size, ThumbnailCache::Size, 1 };
+      wgpuQueueWriteTexture(_wgpuQueue, &destination, thumbnail.pixels.data(), thumbnail.pixels.size(), &layout, &size);
+   }
+}
+
+void Renderer::ShowThumbnail(const SceneCatalogEntry& entry, float size) const
+{
+   auto texture = _thumbnailTextures.find(entry.name);
+   if (texture != _thumbnailTextures.end() && texture->second.modified == entry.modified) {
+      ImGui::Image(reinterpret_cast<ImTextureID>(texture->second.view), ImVec2(size, size));
+   } else {
+      ImGui::Dummy(ImVec2(size, size));
+   }
+}
+
+void Renderer::PrefetchNeighbours()
+{
+   const std::vector<SceneCatalogEntry>& entries = _catalogSnapshot->entries;
+   int index = _catalogSnapshot->Find(_scene->path.filename().string());
+   if (index < 0) {
+      return;
+   }
+
+   // Keeps the file combo in sync with the shown scene.
+   SelectedFileIndex = index;
+   SelectedFile = entries[index].name;
+   if (index > 0 && entries[index - 1].valid) {
+      _residentScenes.Request(entries[index - 1].path, ProcessingOptions, true);
+   }
+   if (index + 1 < static_cast<int>(entries.size()) && entries[index + 1].valid) {
+      _residentScenes.Request(entries[index + 1].path, ProcessingOptions, true);
+   }
+}
+
+void Renderer::InitializeFrameBuffers(FrameResources& frame, u32 sortCapacity, u32 chunkCount, WGPUBuffer sortParamsDataBuffer)
+{
+   // Sorted splat buffer, the sort keys and indices.
+   WGPUBufferDescriptor sortedSplatsBufferDesc = {};
+   sortedSplatsBufferDesc.nextInChain = nullptr;
+   sortedSplatsBufferDesc.label = "Sorted Splat Buffer";
+   sortedSplatsBufferDesc.usage = WGPUBufferUsage_Storage | WGPUBufferUsage_CopyDst;
+   sortedSplatsBufferDesc.size = sizeof(SortSplatsData) * sortCapacity;
+   frame.sortedSplatsBuffer = wgpuDeviceCreateBuffer(_wgpuDevice, &sortedSplatsBufferDesc);
+
+   // Indices of the chunks that passed culling this frame.
+   WGPUBufferDescriptor visibleChunksBufferDesc = {};
+   visibleChunksBufferDesc.nextInChain = nullptr;
+   visibleChunksBufferDesc.label = "Visible Chunks Buffer";
+   visibleChunksBufferDesc.usage = WGPUBufferUsage_Storage | WGPUBufferUsage_CopyDst;
+   visibleChunksBufferDesc.size = sizeof(u32) * chunkCount;
+   frame.visibleChunksBuffer = wgpuDeviceCreateBuffer(_wgpuDevice, &visibleChunksBufferDesc);
+
+   // Indirect draw arguments and cull counters.
+   WGPUBufferDescriptor cullStatsBufferDesc = {};
+   cullStatsBufferDesc.nextInChain = nullptr;
+   cullStatsBufferDesc.label = "Cull Stats Buffer";
+   cullStatsBufferDesc.usage = WGPUBufferUsage_Storage | WGPUBufferUsage_CopySrc | WGPUBufferUsage_CopyDst;
+   cullStatsBufferDesc.size = sizeof(CullStats);
+   frame.cullStatsBuffer = wgpuDeviceCreateBuffer(_wgpuDevice, &cullStatsBufferDesc);
+
+   // Draw arguments copied out of the cull stats, a buffer cannot be indirect and writable storage in one pass.
+   WGPUBufferDescriptor drawArgsBufferDesc = {};
+   drawArgsBufferDesc.nextInChain = nullptr;
+   drawArgsBufferDesc.label = "Draw Args Buffer";
+   drawArgsBufferDesc.usage = WGPUBufferUsage_Indirect | WGPUBufferUsage_CopyDst;
+   drawArgsBufferDesc.size = DrawArgsSize;
+   frame.drawArgsBuffer = wgpuDeviceCreateBuffer(_wgpuDevice, &drawArgsBufferDesc);
+
+   // Sort splats params uniform.
+   WGPUBufferDescriptor sortSplatsParamsUniformBufferDesc = {};
+   sortSplatsParamsUniformBufferDesc.label = "Sort Splats params uniform";
+   sortSplatsParamsUniformBufferDesc.size = sizeof(uvec2);
+   sortSplatsParamsUniformBufferDesc.usage = WGPUBufferUsage_Uniform | WGPUBufferUsage_CopyDst;
+   sortSplatsParamsUniformBufferDesc.mappedAtCreation = false;
+   frame.sortSplatsParamsUniform = wgpuDeviceCreateBuffer(_wgpuDevice, &sortSplatsParamsUniformBufferDesc);
+
+   // Uniform buffer, written every frame.
+   WGPUBufferDescriptor uniformBufferDesc = {};
+   uniformBufferDesc.label = "WGPU Uniform Buffer";
+   uniformBufferDesc.size = sizeof(ShaderUniforms);
+   uniformBufferDesc.usage = WGPUBufferUsage_Uniform | WGPUBufferUsage_CopyDst;
+   uniformBufferDesc.mappedAtCreation = false;
+   ShaderUniforms uniforms = {};
+   uniforms.model = _modelMatrix;
+   uniforms.view = mat4x4(1.0f);
+   uniforms.projection = mat4x4(1.0f);
+   uniforms.splatScale = _splatScale;
+   uniforms.cameraPosition = vec4(0.0f, 0.0f, 0.0f, 1.0f);
+   uniforms.shDegree = 0;
+   uniforms.shWordsPerSplat = _scene->cache.GetHeader().shWordsPerSplat;
+   uniforms.visibleChunkCount = 0;
+   uniforms.alphaThreshold = _alphaThreshold;
+   uniforms.pixelAreaThreshold = _pixelAreaThreshold;
+   uniforms.viewportHeight = static_cast<float>(GetRenderSize().y);
+   frame.uniformBuffer = wgpuDeviceCreateBuffer(_wgpuDevice, &uniformBufferDesc);
+   wgpuQueueWriteBuffer(_wgpuQueue, frame.uniformBuffer, 0, &uniforms, uniformBufferDesc.size);
+
+   // State bind group.
+   WGPUBindGroupEntry stateBGEntries[6] = {};
    stateBGEntries[0].nextInChain = nullptr;
    stateBGEntries[0].binding = 0;
-   stateBGEntries[0].buffer = _sortedSplatsBuffer;
+   stateBGEntries[0].buffer = frame.sortedSplatsBuffer;
    stateBGEntries[0].offset = 0;
-   stateBGEntries[0].size = sizeof(SortSplatsData) * _splatsData.size();
+   stateBGEntries[0].size = sortedSplatsBufferDesc.size;
    stateBGEntries[1].nextInChain = nullptr;
    stateBGEntries[1].binding = 1;
-   stateBGEntries[1].buffer = _uniformBuffer;
+   stateBGEntries[1].buffer = frame.uniformBuffer;
    stateBGEntries[1].offset = 0;
    stateBGEntries[1].size = sizeof(ShaderUniforms);
    stateBGEntries[2].nextInChain = nullptr;
    stateBGEntries[2].binding = 2;
-   stateBGEntries[2].buffer = _sortSplatsParamsDataBuffer;
+   stateBGEntries[2].buffer = sortParamsDataBuffer;
    stateBGEntries[2].offset = 0;
-   stateBGEntries[2].size = _sortSplatsParamsData.size() * sizeof(uvec2);
+   stateBGEntries[2].size = wgpuBufferGetSize(sortParamsDataBuffer);
    stateBGEntries[3].nextInChain = nullptr;
    stateBGEntries[3].binding = 3;
-   stateBGEntries[3].buffer = _sortSplatsParamsUniform;
+   stateBGEntries[3].buffer = frame.sortSplatsParamsUniform;
    stateBGEntries[3].offset = 0;
    stateBGEntries[3].size = sizeof(uvec2);
+   stateBGEntries[4].nextInChain = nullptr;
+   stateBGEntries[4].binding = 4;
+   stateBGEntries[4].buffer = frame.visibleChunksBuffer;
+   stateBGEntries[4].offset = 0;
+   stateBGEntries[4].size = visibleChunksBufferDesc.size;
+   stateBGEntries[5].nextInChain = nullptr;
+   stateBGEntries[5].binding = 5;
+   stateBGEntries[5].buffer = frame.cullStatsBuffer;
+   stateBGEntries[5].offset = 0;
+   stateBGEntries[5].size = sizeof(CullStats);
 
-   // State bind group.
    WGPUBindGroupDescriptor stateBGDesc = {};
    stateBGDesc.nextInChain = nullptr;
    stateBGDesc.label = "State Bind Group";
    stateBGDesc.layout = _stateBindGroupLayout;
-   stateBGDesc.entryCount = 4;
+   stateBGDesc.entryCount = 6;
    stateBGDesc.entries = stateBGEntries;
-   _stateBindGroup = wgpuDeviceCreateBindGroup(_wgpuDevice, &stateBGDesc);
+   frame.stateBindGroup = wgpuDeviceCreateBindGroup(_wgpuDevice, &stateBGDesc);
 }
 
-void Renderer::InitializeComputePipelines(WGPUShaderModule shaderModule)
+void Renderer::ReleaseFrameBuffers(FrameResources& frame)
 {
-   // Compute pipeline layout for transform.
+   wgpuBindGroupRelease(frame.stateBindGroup);
+   wgpuBufferRelease(frame.drawArgsBuffer);
+   wgpuBufferRelease(frame.cullStatsBuffer);
+   wgpuBufferRelease(frame.visibleChunksBuffer);
+   wgpuBufferRelease(frame.sortSplatsParamsUniform);
+   wgpuBufferRelease(frame.sortedSplatsBuffer);
+   wgpuBufferRelease(frame.uniformBuffer);
+}
+
+WGPUBindGroup Renderer::CreateSceneBindGroup(WGPUBuffer splatsBuffer, WGPUBuffer shCoefficientsBuffer, WGPUBuffer splatColorsBuffer) const
+{
+   // Scene binding.
+   WGPUBindGroupEntry sceneBGEntries[3] = {};
+   sceneBGEntries[0].nextInChain = nullptr;
+   sceneBGEntries[0].binding = 0;
+   sceneBGEntries[0].buffer = splatsBuffer;
+   sceneBGEntries[0].offset = 0;
+   sceneBGEntries[0].size = wgpuBufferGetSize(splatsBuffer);
+   sceneBGEntries[1].nextInChain = nullptr;
+   sceneBGEntries[1].binding = 1;
+   sceneBGEntries[1].buffer = shCoefficientsBuffer;
+   sceneBGEntries[1].offset = 0;
+   sceneBGEntries[1].size = wgpuBufferGetSize(shCoefficientsBuffer);
+   sceneBGEntries[2].nextInChain = nullptr;
+   sceneBGEntries[2].binding = 2;
+   sceneBGEntries[2].buffer = splatColorsBuffer;
+   sceneBGEntries[2].offset = 0;
+   sceneBGEntries[2].size = wgpuBufferGetSize(splatColorsBuffer);
+
+   // Scene bind group.
+   WGPUBindGroupDescriptor sceneBGDesc = {};
+   sceneBGDesc.nextInChain = nullptr;
+   sceneBGDesc.label = "Scene Bind Group";
+   sceneBGDesc.layout = _sceneBindGroupLayout;
+   sceneBGDesc.entryCount = 3;
+   sceneBGDesc.entries = sceneBGEntries;
+   return wgpuDeviceCreateBindGroup(_wgpuDevice, &sceneBGDesc);
+}
+
+void Renderer::InitializeComputePipelines(WGPUShaderModule shaderModule, bool evaluateSH, bool sharedSort, PipelineVariant& variant)
+{
+   TRACE_SCOPE("Renderer::InitializeComputePipelines");
+   // Compute pipeline layout for evaluating spherical harmonics.
    WGPUComputePipelineDescriptor computePipelineDesc = {};
+   if (evaluateSH) {
+      computePipelineDesc.nextInChain = nullptr;
+      computePipelineDesc.label = "SH Compute Pipeline";
+      computePipelineDesc.layout = _wgpuPipelineLayout;
+      computePipelineDesc.compute.module = shaderModule;
+      computePipelineDesc.compute.entryPoint = "cs_evaluate_sh";
+      variant.shPipeline = wgpuDeviceCreateComputePipeline(_wgpuDevice, &computePipelineDesc);
+   }
+
+   // Compute pipeline layout for transform.
    computePipelineDesc.nextInChain = nullptr;
    computePipelineDesc.label = "Transform Compute Pipeline";
    computePipelineDesc.layout = _wgpuPipelineLayout;
    computePipelineDesc.compute.module = shaderModule;
    computePipelineDesc.compute.entryPoint = "cs_calculate_sort_splats";
-   _wgpuTransformComputePipeline = wgpuDeviceCreateComputePipeline(_wgpuDevice, &computePipelineDesc);
+   variant.transformPipeline = wgpuDeviceCreateComputePipeline(_wgpuDevice, &computePipelineDesc);
 
    // Compute pipeline layout for sorting splats.
    computePipelineDesc.nextInChain = nullptr;
@@ -678,11 +1805,23 @@ void Renderer::InitializeComputePipelines(WGPUShaderModule shaderModule)
    computePipelineDesc.layout = _wgpuPipelineLayout;
    computePipelineDesc.compute.module = shaderModule;
    computePipelineDesc.compute.entryPoint = "cs_sort_splats";
-   _wgpuSortComputePipeline = wgpuDeviceCreateComputePipeline(_wgpuDevice, &computePipelineDesc);
+   variant.sortPipeline = wgpuDeviceCreateComputePipeline(_wgpuDevice, &computePipelineDesc);
+
+   // Block sort pipelines of the shared sort.
+   if (sharedSort) {
+      computePipelineDesc.label = "Block Sort Compute Pipeline";
+      computePipelineDesc.compute.entryPoint = "cs_sort_block";
+      variant.blockSortPipeline = wgpuDeviceCreateComputePipeline(_wgpuDevice, &computePipelineDesc);
+
+      computePipelineDesc.label = "Block Merge Compute Pipeline";
+      computePipelineDesc.compute.entryPoint = "cs_sort_block_merge";
+      variant.blockMergePipeline = wgpuDeviceCreateComputePipeline(_wgpuDevice, &computePipelineDesc);
+   }
 }
 
-void Renderer::InitializeRenderPipeline(WGPUShaderModule shaderModule)
+void Renderer::InitializeRenderPipeline(WGPUShaderModule shaderModule, PipelineVariant& variant)
 {
+   TRACE_SCOPE("Renderer::InitializeRenderPipeline");
    // Blend state
    WGPUBlendState blendState = {};
    blendState.color.operation = WGPUBlendOperation_Add;
@@ -726,19 +1865,933 @@ void Renderer::InitializeRenderPipeline(WGPUShaderModule shaderModule)
    pipelineDesc.multisample.mask = ~0u; // Default value for the mask, meaning "all bits on"
    pipelineDesc.multisample.alphaToCoverageEnabled = false; // Default value as well (irrelevant for count = 1 anyways)
    pipelineDesc.layout = _wgpuPipelineLayout;
-   _wgpuRenderPipeline = wgpuDeviceCreateRenderPipeline(_wgpuDevice, &pipelineDesc);
+   variant.renderPipeline = wgpuDeviceCreateRenderPipeline(_wgpuDevice, &pipelineDesc);
+
+   // Weighted OIT accumulation, color and weight add up while the revealage is multiplied by (1 - alpha).
+   WGPUBlendState accumBlendState = {};
+   accumBlendState.color.operation = WGPUBlendOperation_Add;
+   accumBlendState.color.srcFactor = WGPUBlendFactor_One;
+   accumBlendState.color.dstFactor = WGPUBlendFactor_One;
+   accumBlendState.alpha = accumBlendState.color;
+   WGPUBlendState revealBlendState = {};
+   revealBlendState.color.operation = WGPUBlendOperation_Add;
+   revealBlendState.color.srcFactor = WGPUBlendFactor_Zero;
+   revealBlendState.color.dstFactor = WGPUBlendFactor_OneMinusSrc;
+   revealBlendState.alpha = revealBlendState.color;
+
+   WGPUColorTargetState oitTargetStates[2] = {};
+   oitTargetStates[0].format = OitAccumFormat;
+   oitTargetStates[0].blend = &accumBlendState;
+   oitTargetStates[0].writeMask = WGPUColorWriteMask_All;
+   oitTargetStates[1].format = OitRevealFormat;
+   oitTargetStates[1].blend = &revealBlendState;
+   oitTargetStates[1].writeMask = WGPUColorWriteMask_Red;
+
+   fragmentState.entryPoint = "fs_oit";
+   fragmentState.targetCount = 2;
+   fragmentState.targets = oitTargetStates;
+   pipelineDesc.label = "OIT Render Pipeline";
+   variant.oitRenderPipeline = wgpuDeviceCreateRenderPipeline(_wgpuDevice, &pipelineDesc);
+
+   // Stochastic transparency, opaque fragments resolved by the depth test instead of blending.
+   WGPUColorTargetState stochasticTargetState = {};
+   stochasticTargetState.format = StochasticColorFormat;
+   stochasticTargetState.blend = nullptr;
+   stochasticTargetState.writeMask = WGPUColorWriteMask_All;
+
+   WGPUStencilFaceState stencilFaceState = {};
+   stencilFaceState.compare = WGPUCompareFunction_Always;
+   stencilFaceState.failOp = WGPUStencilOperation_Keep;
+   stencilFaceState.depthFailOp = WGPUStencilOperation_Keep;
+   stencilFaceState.passOp = WGPUStencilOperation_Keep;
+   WGPUDepthStencilState depthStencilState = {};
+   depthStencilState.format = DepthFormat;
+   depthStencilState.depthWriteEnabled = true;
+   depthStencilState.depthCompare = WGPUCompareFunction_Less;
+   depthStencilState.stencilFront = stencilFaceState;
+   depthStencilState.stencilBack = stencilFaceState;
+   depthStencilState.stencilReadMask = 0;
+   depthStencilState.stencilWriteMask = 0;
+   depthStencilState.depthBias = 0;
+   depthStencilState.depthBiasSlopeScale = 0.0f;
+   depthStencilState.depthBiasClamp = 0.0f;
+
+   fragmentState.entryPoint = "fs_stochastic";
+   fragmentState.targetCount = 1;
+   fragmentState.targets = &stochasticTargetState;
+   pipelineDesc.label = "Stochastic Render Pipeline";
+   pipelineDesc.depthStencil = &depthStencilState;
+   variant.stochasticRenderPipeline = wgpuDeviceCreateRenderPipeline(_wgpuDevice, &pipelineDesc);
+}
+
+void Renderer::InitializeRenderTarget()
+{
+   WGPUTextureDescriptor textureDesc = {};
+   textureDesc.nextInChain = nullptr;
+   textureDesc.label = "Scene Texture";
+   // Copied to the CPU by the render mode comparison.
+   textureDesc.usage = WGPUTextureUsage_RenderAttachment | WGPUTextureUsage_TextureBinding | WGPUTextureUsage_CopySrc;
+   textureDesc.dimension = WGPUTextureDimension_2D;
+   textureDesc.size = { _viewPortSize.x, _viewPortSize.y, 1 };
+   textureDesc.format = _surfaceFormat;
+   textureDesc.mipLevelCount = 1;
+   textureDesc.sampleCount = 1;
+   textureDesc.viewFormatCount = 0;
+   textureDesc.viewFormats = nullptr;
+   _sceneTexture = wgpuDeviceCreateTexture(_wgpuDevice, &textureDesc);
+   _sceneTextureView = CreateTextureView(_sceneTexture);
+
+   // Weighted OIT targets, same size as the scene texture so the resolve maps pixels one to one.
+   textureDesc.label = "OIT Accumulation Texture";
+   textureDesc.usage = WGPUTextureUsage_RenderAttachment | WGPUTextureUsage_TextureBinding;
+   textureDesc.format = OitAccumFormat;
+   _oitAccumTexture = wgpuDeviceCreateTexture(_wgpuDevice, &textureDesc);
+   _oitAccumTextureView = CreateTextureView(_oitAccumTexture);
+   textureDesc.label = "OIT Revealage Texture";
+   textureDesc.format = OitRevealFormat;
+   _oitRevealTexture = wgpuDeviceCreateTexture(_wgpuDevice, &textureDesc);
+   _oitRevealTextureView = CreateTextureView(_oitRevealTexture);
+
+   WGPUBindGroupLayoutEntry oitResolveBGLEntries[2] = {};
+   for (u32 i = 0; i < 2; ++i) {
+      setDefault(oitResolveBGLEntries[i]);
+      oitResolveBGLEntries[i].binding = i;
+      oitResolveBGLEntries[i].visibility = WGPUShaderStage_Fragment;
+      oitResolveBGLEntries[i].texture.sampleType = WGPUTextureSampleType_UnfilterableFloat;
+      oitResolveBGLEntries[i].texture.viewDimension = WGPUTextureViewDimension_2D;
+   }
+   WGPUBindGroupLayoutDescriptor oitResolveBGLDesc = {};
+   oitResolveBGLDesc.nextInChain = nullptr;
+   oitResolveBGLDesc.label = "OIT Resolve Bind Group Layout";
+   oitResolveBGLDesc.entryCount = 2;
+   oitResolveBGLDesc.entries = oitResolveBGLEntries;
+   _oitResolveBindGroupLayout = wgpuDeviceCreateBindGroupLayout(_wgpuDevice, &oitResolveBGLDesc);
+
+   WGPUBindGroupEntry oitResolveBGEntries[2] = {};
+   oitResolveBGEntries[0].nextInChain = nullptr;
+   oitResolveBGEntries[0].binding = 0;
+   oitResolveBGEntries[0].textureView = _oitAccumTextureView;
+   oitResolveBGEntries[1].nextInChain = nullptr;
+   oitResolveBGEntries[1].binding = 1;
+   oitResolveBGEntries[1].textureView = _oitRevealTextureView;
+   WGPUBindGroupDescriptor oitResolveBGDesc = {};
+   oitResolveBGDesc.nextInChain = nullptr;
+   oitResolveBGDesc.label = "OIT Resolve Bind Group";
+   oitResolveBGDesc.layout = _oitResolveBindGroupLayout;
+   oitResolveBGDesc.entryCount = 2;
+   oitResolveBGDesc.entries = oitResolveBGEntries;
+   _oitResolveBindGroup = wgpuDeviceCreateBindGroup(_wgpuDevice, &oitResolveBGDesc);
+
+   // Stochastic transparency targets, read by the temporal accumulation.
+   textureDesc.label = "Stochastic Color Texture";
+   textureDesc.format = StochasticColorFormat;
+   _stochasticColorTexture = wgpuDeviceCreateTexture(_wgpuDevice, &textureDesc);
+   _stochasticColorTextureView = CreateTextureView(_stochasticColorTexture);
+   textureDesc.label = "Depth Texture";
+   textureDesc.format = DepthFormat;
+   _depthTexture = wgpuDeviceCreateTexture(_wgpuDevice, &textureDesc);
+   _depthTextureView = CreateTextureView(_depthTexture);
+   textureDesc.label = "History Texture";
+   textureDesc.format = HistoryFormat;
+   for (u32 i = 0; i < 2; ++i) {
+      _historyTextures[i] = wgpuDeviceCreateTexture(_wgpuDevice, &textureDesc);
+      _historyTextureViews[i] = CreateTextureView(_historyTextures[i]);
+   }
+
+   WGPUBindGroupLayoutEntry temporalTextureBGLEntries[3] = {};
+   for (u32 i = 0; i < 3; ++i) {
+      setDefault(temporalTextureBGLEntries[i]);
+      temporalTextureBGLEntries[i].binding = i;
+      temporalTextureBGLEntries[i].visibility = WGPUShaderStage_Fragment;
+      temporalTextureBGLEntries[i].texture.sampleType = WGPUTextureSampleType_UnfilterableFloat;
+      temporalTextureBGLEntries[i].texture.viewDimension = WGPUTextureViewDimension_2D;
+   }
+   temporalTextureBGLEntries[1].texture.sampleType = WGPUTextureSampleType_Depth;
+   WGPUBindGroupLayoutDescriptor temporalTextureBGLDesc = {};
+   temporalTextureBGLDesc.nextInChain = nullptr;
+   temporalTextureBGLDesc.label = "Temporal Texture Bind Group Layout";
+   temporalTextureBGLDesc.entryCount = 3;
+   temporalTextureBGLDesc.entries = temporalTextureBGLEntries;
+   _temporalTextureBindGroupLayout = wgpuDeviceCreateBindGroupLayout(_wgpuDevice, &temporalTextureBGLDesc);
+
+   for (u32 i = 0; i < 2; ++i) {
+      WGPUBindGroupEntry temporalTextureBGEntries[3] = {};
+      temporalTextureBGEntries[0].nextInChain = nullptr;
+      temporalTextureBGEntries[0].binding = 0;
+      temporalTextureBGEntries[0].textureView = _stochasticColorTextureView;
+      temporalTextureBGEntries[1].nextInChain = nullptr;
+      temporalTextureBGEntries[1].binding = 1;
+      temporalTextureBGEntries[1].textureView = _depthTextureView;
+      temporalTextureBGEntries[2].nextInChain = nullptr;
+      temporalTextureBGEntries[2].binding = 2;
+      temporalTextureBGEntries[2].textureView = _historyTextureViews[i];
+
+      WGPUBindGroupDescriptor temporalTextureBGDesc = {};
+      temporalTextureBGDesc.nextInChain = nullptr;
+      temporalTextureBGDesc.label = "Temporal Texture Bind Group";
+      temporalTextureBGDesc.layout = _temporalTextureBindGroupLayout;
+      temporalTextureBGDesc.entryCount = 3;
+      temporalTextureBGDesc.entries = temporalTextureBGEntries;
+      _temporalTextureBindGroups[i] = wgpuDeviceCreateBindGroup(_wgpuDevice, &temporalTextureBGDesc);
+   }
+
+   // Temporal uniforms, one per frame in flight.
+   WGPUBindGroupLayoutEntry temporalUniformBGLEntry = {};
+   setDefault(temporalUniformBGLEntry);
+   temporalUniformBGLEntry.binding = 0;
+   temporalUniformBGLEntry.visibility = WGPUShaderStage_Fragment;
+   temporalUniformBGLEntry.buffer.type = WGPUBufferBindingType_Uniform;
+   temporalUniformBGLEntry.buffer.minBindingSize = sizeof(TemporalUniforms);
+   WGPUBindGroupLayoutDescriptor temporalUniformBGLDesc = {};
+   temporalUniformBGLDesc.nextInChain = nullptr;
+   temporalUniformBGLDesc.label = "Temporal Uniform Bind Group Layout";
+   temporalUniformBGLDesc.entryCount = 1;
+   temporalUniformBGLDesc.entries = &temporalUniformBGLEntry;
+   _temporalUniformBindGroupLayout = wgpuDeviceCreateBindGroupLayout(_wgpuDevice, &temporalUniformBGLDesc);
+
+   WGPUBufferDescriptor temporalUniformBufferDesc = {};
+   temporalUniformBufferDesc.nextInChain = nullptr;
+   temporalUniformBufferDesc.label = "Temporal Uniform Buffer";
+   temporalUniformBufferDesc.usage = WGPUBufferUsage_Uniform | WGPUBufferUsage_CopyDst;
+   temporalUniformBufferDesc.size = sizeof(TemporalUniforms);
+   for (FrameResources& frame : _frames) {
+      frame.temporalUniformBuffer = wgpuDeviceCreateBuffer(_wgpuDevice, &temporalUniformBufferDesc);
+
+      WGPUBindGroupEntry temporalUniformBGEntry = {};
+      temporalUniformBGEntry.nextInChain = nullptr;
+      temporalUniformBGEntry.binding = 0;
+      temporalUniformBGEntry.buffer = frame.temporalUniformBuffer;
+      temporalUniformBGEntry.offset = 0;
+      temporalUniformBGEntry.size = sizeof(TemporalUniforms);
+      WGPUBindGroupDescriptor temporalUniformBGDesc = {};
+      temporalUniformBGDesc.nextInChain = nullptr;
+      temporalUniformBGDesc.label = "Temporal Uniform Bind Group";
+      temporalUniformBGDesc.layout = _temporalUniformBindGroupLayout;
+      temporalUniformBGDesc.entryCount = 1;
+      temporalUniformBGDesc.entries = &temporalUniformBGEntry;
+      frame.temporalUniformBindGroup = wgpuDeviceCreateBindGroup(_wgpuDevice, &temporalUniformBGDesc);
+   }
+
+   WGPUSamplerDescriptor samplerDesc = {};
+   samplerDesc.nextInChain = nullptr;
+   samplerDesc.label = "Upscale Sampler";
+   samplerDesc.addressModeU = WGPUAddressMode_ClampToEdge;
+   samplerDesc.addressModeV = WGPUAddressMode_ClampToEdge;
+   samplerDesc.addressModeW = WGPUAddressMode_ClampToEdge;
+   samplerDesc.magFilter = WGPUFilterMode_Linear;
+   samplerDesc.minFilter = WGPUFilterMode_Linear;
+   samplerDesc.mipmapFilter = WGPUMipmapFilterMode_Nearest;
+   samplerDesc.lodMinClamp = 0.0f;
+   samplerDesc.lodMaxClamp = 1.0f;
+   samplerDesc.compare = WGPUCompareFunction_Undefined;
+   samplerDesc.maxAnisotropy = 1;
+   _upscaleSampler = wgpuDeviceCreateSampler(_wgpuDevice, &samplerDesc);
+
+   WGPUBufferDescriptor upscaleUniformBufferDesc = {};
+   upscaleUniformBufferDesc.nextInChain = nullptr;
+   upscaleUniformBufferDesc.label = "Upscale Uniform Buffer";
+   upscaleUniformBufferDesc.usage = WGPUBufferUsage_Uniform | WGPUBufferUsage_CopyDst;
+   upscaleUniformBufferDesc.size = sizeof(UpscaleUniforms);
+   for (FrameResources& frame : _frames) {
+      frame.upscaleUniformBuffer = wgpuDeviceCreateBuffer(_wgpuDevice, &upscaleUniformBufferDesc);
+   }
+
+   // Upscale bind group layout entries.
+   WGPUBindGroupLayoutEntry upscaleBGLEntries[3] = {};
+   setDefault(upscaleBGLEntries[0]);
+   upscaleBGLEntries[0].binding = 0;
+   upscaleBGLEntries[0].visibility = WGPUShaderStage_Fragment;
+   upscaleBGLEntries[0].texture.sampleType = WGPUTextureSampleType_Float;
+   upscaleBGLEntries[0].texture.viewDimension = WGPUTextureViewDimension_2D;
+   setDefault(upscaleBGLEntries[1]);
+   upscaleBGLEntries[1].binding = 1;
+   upscaleBGLEntries[1].visibility = WGPUShaderStage_Fragment;
+   upscaleBGLEntries[1].sampler.type = WGPUSamplerBindingType_Filtering;
+   setDefault(upscaleBGLEntries[2]);
+   upscaleBGLEntries[2].binding = 2;
+   upscaleBGLEntries[2].visibility = WGPUShaderStage_Vertex;
+   upscaleBGLEntries[2].buffer.type = WGPUBufferBindingType_Uniform;
+   upscaleBGLEntries[2].buffer.minBindingSize = sizeof(UpscaleUniforms);
+
+   WGPUBindGroupLayoutDescriptor upscaleBGLDesc = {};
+   upscaleBGLDesc.nextInChain = nullptr;
+   upscaleBGLDesc.label = "Upscale Bind Group Layout";
+   upscaleBGLDesc.entryCount = 3;
+   upscaleBGLDesc.entries = upscaleBGLEntries;
+   _upscaleBindGroupLayout = wgpuDeviceCreateBindGroupLayout(_wgpuDevice, &upscaleBGLDesc);
+
+   for (FrameResources& frame : _frames) {
+      WGPUBindGroupEntry upscaleBGEntries[3] = {};
+      upscaleBGEntries[0].nextInChain = nullptr;
+      upscaleBGEntries[0].binding = 0;
+      upscaleBGEntries[0].textureView = _sceneTextureView;
+      upscaleBGEntries[1].nextInChain = nullptr;
+      upscaleBGEntries[1].binding = 1;
+      upscaleBGEntries[1].sampler = _upscaleSampler;
+      upscaleBGEntries[2].nextInChain = nullptr;
+      upscaleBGEntries[2].binding = 2;
+      upscaleBGEntries[2].buffer = frame.upscaleUniformBuffer;
+      upscaleBGEntries[2].offset = 0;
+      upscaleBGEntries[2].size = sizeof(UpscaleUniforms);
+
+      WGPUBindGroupDescriptor upscaleBGDesc = {};
+      upscaleBGDesc.nextInChain = nullptr;
+      upscaleBGDesc.label = "Upscale Bind Group";
+      upscaleBGDesc.layout = _upscaleBindGroupLayout;
+      upscaleBGDesc.entryCount = 3;
+      upscaleBGDesc.entries = upscaleBGEntries;
+      frame.upscaleBindGroup = wgpuDeviceCreateBindGroup(_wgpuDevice, &upscaleBGDesc);
+   }
+}
+
+void Renderer::InitializeOitResolvePipeline(WGPUShaderModule shaderModule)
+{
+   TRACE_SCOPE("Renderer::InitializeOitResolvePipeline");
+   WGPUPipelineLayoutDescriptor pipelineLayoutDesc = {};
+   pipelineLayoutDesc.nextInChain = nullptr;
+   pipelineLayoutDesc.label = "OIT Resolve Pipeline Layout";
+   pipelineLayoutDesc.bindGroupLayoutCount = 1;
+   pipelineLayoutDesc.bindGroupLayouts = &_oitResolveBindGroupLayout;
+   _oitResolvePipelineLayout = wgpuDeviceCreatePipelineLayout(_wgpuDevice, &pipelineLayoutDesc);
+
+   // Blended over the background like the sorted splats.
+   WGPUBlendState blendState = {};
+   blendState.color.operation = WGPUBlendOperation_Add;
+   blendState.color.srcFactor = WGPUBlendFactor_SrcAlpha;
+   blendState.color.dstFactor = WGPUBlendFactor_OneMinusSrcAlpha;
+   blendState.alpha.operation = WGPUBlendOperation_Add;
+   blendState.alpha.srcFactor = WGPUBlendFactor_One;
+   blendState.alpha.dstFactor = WGPUBlendFactor_OneMinusSrcAlpha;
+
+   WGPUColorTargetState colorTargetState = {};
+   colorTargetState.format = _surfaceFormat;
+   colorTargetState.blend = &blendState;
+   colorTargetState.writeMask = WGPUColorWriteMask_All;
+
+   WGPUFragmentState fragmentState = {};
+   fragmentState.module = shaderModule;
+   fragmentState.entryPoint = "fs_main";
+   fragmentState.constantCount = 0;
+   fragmentState.constants = nullptr;
+   fragmentState.targetCount = 1;
+   fragmentState.targets = &colorTargetState;
+
+   WGPURenderPipelineDescriptor pipelineDesc = {};
+   pipelineDesc.nextInChain = nullptr;
+   pipelineDesc.label = "OIT Resolve Render Pipeline";
+   pipelineDesc.vertex.module = shaderModule;
+   pipelineDesc.vertex.entryPoint = "vs_main";
+   pipelineDesc.vertex.bufferCount = 0;
+   pipelineDesc.vertex.constantCount = 0;
+   pipelineDesc.vertex.constants = nullptr;
+   pipelineDesc.primitive.topology = WGPUPrimitiveTopology_TriangleList;
+   pipelineDesc.primitive.stripIndexFormat = WGPUIndexFormat_Undefined;
+   pipelineDesc.primitive.frontFace = WGPUFrontFace_CCW;
+   pipelineDesc.primitive.cullMode = WGPUCullMode_None;
+   pipelineDesc.fragment = &fragmentState;
+   pipelineDesc.depthStencil = nullptr;
+   pipelineDesc.multisample.count = 1;
+   pipelineDesc.multisample.mask = ~0u;
+   pipelineDesc.multisample.alphaToCoverageEnabled = false;
+   pipelineDesc.layout = _oitResolvePipelineLayout;
+   _oitResolvePipeline = wgpuDeviceCreateRenderPipeline(_wgpuDevice, &pipelineDesc);
+}
+
+void Renderer::InitializeTemporalPipeline(WGPUShaderModule shaderModule)
+{
+   TRACE_SCOPE("Renderer::InitializeTemporalPipeline");
+   WGPUBindGroupLayout bgLayouts[2] = { _temporalTextureBindGroupLayout, _temporalUniformBindGroupLayout };
+   WGPUPipelineLayoutDescriptor pipelineLayoutDesc = {};
+   pipelineLayoutDesc.nextInChain = nullptr;
+   pipelineLayoutDesc.label = "Temporal Pipeline Layout";
+   pipelineLayoutDesc.bindGroupLayoutCount = 2;
+   pipelineLayoutDesc.bindGroupLayouts = bgLayouts;
+   _temporalPipelineLayout = wgpuDeviceCreatePipelineLayout(_wgpuDevice, &pipelineLayoutDesc);
+
+   // Writes the new history and the displayed color, both replace the target contents.
+   WGPUColorTargetState colorTargetStates[2] = {};
+   colorTargetStates[0].format = HistoryFormat;
+   colorTargetStates[0].blend = nullptr;
+   colorTargetStates[0].writeMask = WGPUColorWriteMask_All;
+   colorTargetStates[1].format = _surfaceFormat;
+   colorTargetStates[1].blend = nullptr;
+   colorTargetStates[1].writeMask = WGPUColorWriteMask_All;
+
+   WGPUFragmentState fragmentState = {};
+   fragmentState.module = shaderModule;
+   fragmentState.entryPoint = "fs_main";
+   fragmentState.constantCount = 0;
+   fragmentState.constants = nullptr;
+   fragmentState.targetCount = 2;
+   fragmentState.targets = colorTargetStates;
+
+   WGPURenderPipelineDescriptor pipelineDesc = {};
+   pipelineDesc.nextInChain = nullptr;
+   pipelineDesc.label = "Temporal Render Pipeline";
+   pipelineDesc.vertex.module = shaderModule;
+   pipelineDesc.vertex.entryPoint = "vs_main";
+   pipelineDesc.vertex.bufferCount = 0;
+   pipelineDesc.vertex.constantCount = 0;
+   pipelineDesc.vertex.constants = nullptr;
+   pipelineDesc.primitive.topology = WGPUPrimitiveTopology_TriangleList;
+   pipelineDesc.primitive.stripIndexFormat = WGPUIndexFormat_Undefined;
+   pipelineDesc.primitive.frontFace = WGPUFrontFace_CCW;
+   pipelineDesc.primitive.cullMode = WGPUCullMode_None;
+   pipelineDesc.fragment = &fragmentState;
+   pipelineDesc.depthStencil = nullptr;
+   pipelineDesc.multisample.count = 1;
+   pipelineDesc.multisample.mask = ~0u;
+   pipelineDesc.multisample.alphaToCoverageEnabled = false;
+   pipelineDesc.layout = _temporalPipelineLayout;
+   _temporalPipeline = wgpuDeviceCreateRenderPipeline(_wgpuDevice, &pipelineDesc);
+}
+
+void Renderer::InitializeUpscalePipeline(WGPUShaderModule shaderModule)
+{
+   TRACE_SCOPE("Renderer::InitializeUpscalePipeline");
+   WGPUPipelineLayoutDescriptor pipelineLayoutDesc = {};
+   pipelineLayoutDesc.nextInChain = nullptr;
+   pipelineLayoutDesc.label = "Upscale Pipeline Layout";
+   pipelineLayoutDesc.bindGroupLayoutCount = 1;
+   pipelineLayoutDesc.bindGroupLayouts = &_upscaleBindGroupLayout;
+   _upscalePipelineLayout = wgpuDeviceCreatePipelineLayout(_wgpuDevice, &pipelineLayoutDesc);
+
+   // The upscaled image replaces the surface contents, no blending.
+   WGPUColorTargetState colorTargetState = {};
+   colorTargetState.format = _surfaceFormat;
+   colorTargetState.blend = nullptr;
+   colorTargetState.writeMask = WGPUColorWriteMask_All;
+
+   WGPUFragmentState fragmentState = {};
+   fragmentState.module = shaderModule;
+   fragmentState.entryPoint = "fs_main";
+   fragmentState.constantCount = 0;
+   fragmentState.constants = nullptr;
+   fragmentState.targetCount = 1;
+   fragmentState.targets = &colorTargetState;
+
+   WGPURenderPipelineDescriptor pipelineDesc = {};
+   pipelineDesc.nextInChain = nullptr;
+   pipelineDesc.label = "Upscale Render Pipeline";
+   pipelineDesc.vertex.module = shaderModule;
+   pipelineDesc.vertex.entryPoint = "vs_main";
+   pipelineDesc.vertex.bufferCount = 0;
+   pipelineDesc.vertex.constantCount = 0;
+   pipelineDesc.vertex.constants = nullptr;
+   pipelineDesc.primitive.topology = WGPUPrimitiveTopology_TriangleList;
+   pipelineDesc.primitive.stripIndexFormat = WGPUIndexFormat_Undefined;
+   pipelineDesc.primitive.frontFace = WGPUFrontFace_CCW;
+   pipelineDesc.primitive.cullMode = WGPUCullMode_None;
+   pipelineDesc.fragment = &fragmentState;
+   pipelineDesc.depthStencil = nullptr;
+   pipelineDesc.multisample.count = 1;
+   pipelineDesc.multisample.mask = ~0u;
+   pipelineDesc.multisample.alphaToCoverageEnabled = false;
+   pipelineDesc.layout = _upscalePipelineLayout;
+   _upscalePipeline = wgpuDeviceCreateRenderPipeline(_wgpuDevice, &pipelineDesc);
+}
+
+// Packs the permutation: bits 0-15 workgroup size, 16-17 SH degree, 18 chunk culling, 19 splat culling,
+// 20 shared sort, 21 four keys per thread.
+u32 Renderer::GetPipelineVariantKey(u32 shDegree, const TuningConfig& tuning) const
+{
+   bool splatCulling = _alphaThreshold > 0.0f || _pixelAreaThreshold > 0.0f;
+   bool sharedSort = tuning.sortAlgorithm == SORT_ALGORITHM_SHARED;
+   return tuning.workGroupSize | (std::min(shDegree, 3u) << 16) | (_chunkCulling ? 1u << 18 : 0u) | (splatCulling ? 1u << 19 : 0u) |
+          (sharedSort ? 1u << 20 : 0u) | (sharedSort && tuning.keysPerThread == 4 ? 1u << 21 : 0u);
+}
+
+const PipelineVariant* Renderer::GetPipelineVariant(u32 key)
+{
+   auto found = _pipelineVariants.find(key);
+   if (found != _pipelineVariants.end()) {
+      return &found->second;
+   }
+
+   TRACE_SCOPE("Renderer::CompilePipelineVariant");
+   u32 shDegree = (key >> 16) & 3u;
+   bool sharedSort = (key & (1u << 20)) != 0;
+   ShaderDefines defines = {
+      { "WORKGROUP_SIZE", std::to_string(key & 0xFFFFu) },
+      { "SH_DEGREE", std::to_string(shDegree) },
+      { "CHUNK_CULLING", (key & (1u << 18)) ? "1" : "0" },
+      { "SPLAT_CULLING", (key & (1u << 19)) ? "1" : "0" },
+      { "SHARED_SORT", sharedSort ? "1" : "0" },
+      { "KEYS_PER_THREAD", (key & (1u << 21)) ? "4" : "2" },
+   };
+   WGPUShaderModule shaderModule = _shaderCache.GetModule("../../../assets/shaders/gaussian_splatting.wgsl", defines);
+   if (shaderModule == nullptr) {
+      return nullptr;
+   }
+
+   PipelineVariant variant;
+   InitializeComputePipelines(shaderModule, shDegree > 0, sharedSort, variant);
+   InitializeRenderPipeline(shaderModule, variant);
+   return &_pipelineVariants.emplace(key, variant).first->second;
+}
 
-   wgpuShaderModuleRelease(shaderModule);
+void Renderer::UpdateSortSchedule()
+{
+   if (_sortSchedule.GetSteps().empty() || !(_scheduledTuning == _tuning)) {
+      _sortSchedule.Build(_sortCapacity, _tuning.sortAlgorithm, _tuning.workGroupSize, _tuning.keysPerThread);
+      _scheduledTuning = _tuning;
+      // Frames already submitted keep reading the previous steps, queue writes are ordered after them.
+      std::vector<uvec2> params;
+      for (const SortStep& step : _sortSchedule.GetSteps()) {
+         params.push_back(step.params);
+      }
+      wgpuQueueWriteBuffer(_wgpuQueue, _sortSplatsParamsDataBuffer, 0, params.data(), params.size() * sizeof(uvec2));
+   }
+}
+
+void Renderer::RunAutotune()
+{
+   TRACE_SCOPE("Renderer::RunAutotune");
+   // The measured submissions must not overlap frames in flight.
+   wgpuDevicePoll(_wgpuDevice, true, nullptr);
+
+   // Synthetic scene in front of a fixed camera, every chunk is visible.
+   const u32 splatCount = Autotuner::SyntheticSplatCount;
+   const u32 chunkCount = splatCount / SceneCache::ChunkSize;
+   std::vector<Splat> splats;
+   Autotuner::CreateSyntheticSplats(splatCount, splats);
+
+   WGPUBufferDescriptor bufferDesc = {};
+   bufferDesc.nextInChain = nullptr;
+   bufferDesc.label = "Autotune Splat Buffer";
+   bufferDesc.usage = WGPUBufferUsage_Storage | WGPUBufferUsage_CopyDst;
+   bufferDesc.size = sizeof(Splat) * splatCount;
+   WGPUBuffer splatsBuffer = wgpuDeviceCreateBuffer(_wgpuDevice, &bufferDesc);
+   wgpuQueueWriteBuffer(_wgpuQueue, splatsBuffer, 0, splats.data(), bufferDesc.size);
+   // Candidates are measured without view dependent color.
+   bufferDesc.label = "Autotune SH Buffer";
+   bufferDesc.size = sizeof(u32);
+   WGPUBuffer shCoefficientsBuffer = wgpuDeviceCreateBuffer(_wgpuDevice, &bufferDesc);
+   bufferDesc.label = "Autotune Colors Buffer";
+   WGPUBuffer splatColorsBuffer = wgpuDeviceCreateBuffer(_wgpuDevice, &bufferDesc);
+   bufferDesc.label = "Autotune Sort params array";
+   bufferDesc.usage = WGPUBufferUsage_Storage | WGPUBufferUsage_CopySrc | WGPUBufferUsage_CopyDst;
+   bufferDesc.size = SortSchedule::GetMaxStepCount(splatCount) * sizeof(uvec2);
+   WGPUBuffer sortParamsDataBuffer = wgpuDeviceCreateBuffer(_wgpuDevice, &bufferDesc);
+
+   WGPUBindGroup sceneBindGroup = CreateSceneBindGroup(splatsBuffer, shCoefficientsBuffer, splatColorsBuffer);
+   FrameResources frame;
+   InitializeFrameBuffers(frame, splatCount, chunkCount, sortParamsDataBuffer);
+
+   std::vector<u32> visibleChunks(chunkCount);
+   for (u32 c = 0; c < chunkCount; ++c) {
+      visibleChunks[c] = c;
+   }
+   wgpuQueueWriteBuffer(_wgpuQueue, frame.visibleChunksBuffer, 0, visibleChunks.data(), sizeof(u32) * chunkCount);
+
+   ShaderUniforms uniforms = {};
+   uniforms.model = identity<mat4x4>();
+   uniforms.view = lookAt(vec3(0.0f, 0.0f, 2.0f), vec3(0.0f), vec3(0.0f, 1.0f, 0.0f));
+   uniforms.projection = perspective(radians(60.0f), static_cast<float>(_viewPortSize.x) / static_cast<float>(_viewPortSize.y), 0.1f, 100.0f);
+   uniforms.splatScale = _splatScale;
+   uniforms.cameraPosition = vec4(0.0f, 0.0f, 2.0f, 1.0f);
+   uniforms.shDegree = 0;
+   uniforms.shWordsPerSplat = 0;
+   uniforms.visibleChunkCount = chunkCount;
+   uniforms.alphaThreshold = _alphaThreshold;
+   uniforms.pixelAreaThreshold = _pixelAreaThreshold;
+   uniforms.viewportHeight = static_cast<float>(_viewPortSize.y);
+   wgpuQueueWriteBuffer(_wgpuQueue, frame.uniformBuffer, 0, &uniforms, sizeof(ShaderUniforms));
+
+   // Each candidate runs a few warm up frames, then the median wall time of blocking submissions is kept.
+   // Wall time works without timestamp queries and includes the encoding cost of the extra sort passes.
+   const u32 warmupRuns = 2;
+   const u32 measuredRuns = 5;
+   _tuningResults.clear();
+   for (const TuningConfig& candidate : Autotuner::GetCandidates()) {
+      const PipelineVariant* pipelines = GetPipelineVariant(GetPipelineVariantKey(0, candidate));
+      if (pipelines == nullptr) {
+         continue;
+      }
+
+      SortSchedule schedule;
+      schedule.Build(splatCount, candidate.sortAlgorithm, candidate.workGroupSize, candidate.keysPerThread);
+      std::vector<uvec2> params;
+      for (const SortStep& step : schedule.GetSteps()) {
+         params.push_back(step.params);
+      }
+      wgpuQueueWriteBuffer(_wgpuQueue, sortParamsDataBuffer, 0, params.data(), params.size() * sizeof(uvec2));
+
+      std::vector<float> times;
+      for (u32 run = 0; run < warmupRuns + measuredRuns; ++run) {
+         CullStats cullStats = { 4, 0, 0, 0, 0, 0 };
+         wgpuQueueWriteBuffer(_wgpuQueue, frame.cullStatsBuffer, 0, &cullStats, sizeof(CullStats));
+
+         std::chrono::high_resolution_clock::time_point runStart = std::chrono::high_resolution_clock::now();
+         WGPUCommandEncoder encoder = CreateCommandEncoder();
+         EncodeTransformPass(encoder, *pipelines, sceneBindGroup, frame, candidate.workGroupSize, splatCount, false);
+         EncodeSortPasses(encoder, *pipelines, sceneBindGroup, frame, sortParamsDataBuffer, schedule, candidate.workGroupSize, splatCount, false);
+         EncodeSplatPass(encoder, pipelines, sceneBindGroup, frame, RENDER_MODE_SORTED, splatCount, _viewPortSize, false);
+         WGPUCommandBuffer commandBuffer = FinishAndReleaseCommandEncoder(encoder);
+         WGPUWrappedSubmissionIndex submission = {};
+         submission.queue = _wgpuQueue;
+         submission.submissionIndex = wgpuQueueSubmitForIndex(_wgpuQueue, 1, &commandBuffer);
+         wgpuCommandBufferRelease(commandBuffer);
+         wgpuDevicePoll(_wgpuDevice, true, &submission);
+         if (run >= warmupRuns) {
+            times.push_back(std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - runStart).count());
+         }
+      }
+
+      std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+      _tuningResults.push_back({ candidate, times[times.size() / 2] });
+      std::cout << "Autotune " << Autotuner::ToString(candidate) << ": " << _tuningResults.back().time << " ms" << std::endl;
+   }
+
+   ReleaseFrameBuffers(frame);
+   wgpuBindGroupRelease(sceneBindGroup);
+   wgpuBufferRelease(sortParamsDataBuffer);
+   wgpuBufferRelease(splatColorsBuffer);
+   wgpuBufferRelease(shCoefficientsBuffer);
+   wgpuBufferRelease(splatsBuffer);
+
+   if (_tuningResults.empty()) {
+      std::cerr << "Autotune failed, no candidate could be compiled." << std::endl;
+      return;
+   }
+   auto best = std::min_element(_tuningResults.begin(), _tuningResults.end(),
+      [](const TuningResult& a, const TuningResult& b) { return a.time < b.time; });
+   _tuning = best->config;
+   Autotuner::SaveProfile(_adapterProfile, _tuning, _tuningResults);
+}
+
+void Renderer::CompareRenderModes(const Camera& camera)
+{
+   TRACE_SCOPE("Renderer::CompareRenderModes");
+   // The measured submissions must not overlap frames in flight.
+   wgpuDevicePoll(_wgpuDevice, true, nullptr);
+
+   FrameResources& frame = _frames[_frameIndex];
+   UpdateVisibleChunks(camera);
+   UpdateUniforms(camera);
+   const PipelineVariant* pipelines = GetPipelineVariant(GetPipelineVariantKey(GetSHDegree(), _tuning));
+   UpdateSortSchedule();
+   u32 visibleSplatSlots = pipelines ? static_cast<u32>(_visibleChunks.size()) * SceneCache::ChunkSize : 0;
+   u32vec2 renderSize = GetRenderSize();
+
+   u32 bytesPerRow = TextureReadback::GetBytesPerRow(renderSize.x);
+   WGPUBuffer readbackBuffer = TextureReadback::CreateBuffer(_wgpuDevice, "Render Mode Readback Buffer", renderSize);
+
+   std::vector<u8> images[RENDER_MODE_COUNT];
+   for (u32 mode = 0; mode < RENDER_MODE_COUNT; ++mode) {
+      // Stochastic transparency is compared once it converged, its time is per accumulated frame.
+      u32 frameCount = mode == RENDER_MODE_STOCHASTIC ? StochasticCompareFrames : 1;
+      _historyValid = false;
+      float totalTime = 0.0f;
+      for (u32 frameRun = 0; frameRun < frameCount; ++frameRun) {
+         UpdateUniforms(camera);
+         CullStats cullStats = { 4, 0, 0, 0, 0, 0 };
+         wgpuQueueWriteBuffer(_wgpuQueue, frame.cullStatsBuffer, 0, &cullStats, sizeof(CullStats));
+
+         std::chrono::high_resolution_clock::time_point runStart = std::chrono::high_resolution_clock::now();
+         WGPUCommandEncoder encoder = CreateCommandEncoder();
+         EncodeOffscreenFrame(encoder, pipelines, frame, static_cast<ERenderMode>(mode), visibleSplatSlots, renderSize);
+         WGPUCommandBuffer commandBuffer = FinishAndReleaseCommandEncoder(encoder);
+         WGPUWrappedSubmissionIndex submission = {};
+         submission.queue = _wgpuQueue;
+         submission.submissionIndex = wgpuQueueSubmitForIndex(_wgpuQueue, 1, &commandBuffer);
+         wgpuCommandBufferRelease(commandBuffer);
+         wgpuDevicePoll(_wgpuDevice, true, &submission);
+         totalTime += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - runStart).count();
+      }
+      _modeComparison.times[mode] = totalTime / static_cast<float>(frameCount);
+
+      // Copy the rendered region outside of the measured time.
+      WGPUCommandEncoder encoder = CreateCommandEncoder();
+      TextureReadback::EncodeCopy(encoder, _sceneTexture, readbackBuffer, renderSize, bytesPerRow);
+      WGPUCommandBuffer commandBuffer = FinishAndReleaseCommandEncoder(encoder);
+      wgpuQueueSubmit(_wgpuQueue, 1, &commandBuffer);
+      wgpuCommandBufferRelease(commandBuffer);
+
+      // Without the image of every mode there is nothing to compare.
+      if (!TextureReadback::ReadBlocking(_wgpuDevice, readbackBuffer, bytesPerRow, renderSize, images[mode])) {
+         std::cerr << "Failed to read back the render mode comparison" << std::endl;
+         wgpuBufferRelease(readbackBuffer);
+         _modeComparison.valid = false;
+         return;
+      }
+   }
+   wgpuBufferRelease(readbackBuffer);
+
+   // Color channels only, the alpha of the scene texture is not shown.
+   _modeComparison.valid = !images[RENDER_MODE_SORTED].empty();
+   for (u32 mode = 0; mode < RENDER_MODE_COUNT && _modeComparison.valid; ++mode) {
+      if (images[mode].size() != images[RENDER_MODE_SORTED].size()) {
+         _modeComparison.valid = false;
+         break;
+      }
+      double absoluteSum = 0.0;
+      double squaredSum = 0.0;
+      int maxDifference = 0;
+      for (size_t i = 0; i < images[mode].size(); ++i) {
+         if (i % 4 == 3) {
+            continue;
+         }
+         int difference = std::abs(static_cast<int>(images[mode][i]) - static_cast<int>(images[RENDER_MODE_SORTED][i]));
+         absoluteSum += difference;
+         squaredSum += static_cast<double>(difference) * difference;
+         maxDifference = std::max(maxDifference, difference);
+      }
+      double channelCount = static_cast<double>(images[mode].size()) * 3.0 / 4.0;
+      double meanSquared = squaredSum / channelCount;
+      _modeComparison.meanError[mode] = static_cast<float>(absoluteSum / channelCount);
+      _modeComparison.maxError[mode] = static_cast<float>(maxDifference);
+      _modeComparison.psnr[mode] = meanSquared > 0.0 ? static_cast<float>(10.0 * std::log10(255.0 * 255.0 / meanSquared)) : std::numeric_limits<float>::infinity();
+   }
+}
+
+void Renderer::EncodeOffscreenFrame(WGPUCommandEncoder encoder, const PipelineVariant* pipelines, const FrameResources& frame, ERenderMode mode,
+                                    u32 visibleSplatSlots, u32vec2 renderSize)
+{
+   if (pipelines != nullptr && visibleSplatSlots > 0) {
+      if (GetSHDegree() > 0) {
+         EncodeSHPass(encoder, *pipelines, frame, visibleSplatSlots, false);
+      }
+      u32 sortCount = std::clamp<u32>(std::bit_ceil(visibleSplatSlots), std::max(_tuning.workGroupSize, _sortSchedule.GetBlockSize()), _sortCapacity);
+      EncodeTransformPass(encoder, *pipelines, _scene->bindGroup, frame, _tuning.workGroupSize, sortCount, false);
+      if (mode == RENDER_MODE_SORTED) {
+         EncodeSortPasses(encoder, *pipelines, _scene->bindGroup, frame, _sortSplatsParamsDataBuffer, _sortSchedule, _tuning.workGroupSize, sortCount, false);
+      }
+   }
+   EncodeSplatPass(encoder, visibleSplatSlots > 0 ? pipelines : nullptr, _scene->bindGroup, frame, mode, visibleSplatSlots, renderSize, false);
+}
+
+bool Renderer::RenderTiled(const Camera& camera, u32vec2 imageSize, const std::filesystem::path& path)
+{
+   TRACE_SCOPE("Renderer::RenderTiled");
+   // Tiles reuse the resources of the current frame, nothing else may be in flight.
+   wgpuDevicePoll(_wgpuDevice, true, nullptr);
+   std::chrono::high_resolution_clock::time_point renderStart = std::chrono::high_resolution_clock::now();
+
+   TiledImageWriter writer;
+   if (imageSize.x == 0 || imageSize.y == 0 || !writer.Open(path, imageSize)) {
+      return false;
+   }
+
+   FrameResources& frame = _frames[_frameIndex];
+   const PipelineVariant* pipelines = GetPipelineVariant(GetPipelineVariantKey(GetSHDegree(), _tuning));
+   UpdateSortSchedule();
+
+   // The image keeps the vertical field of view of the camera, the aspect ratio follows the image.
+   Camera imageCamera = camera;
+   imageCamera.SetAspectRatio(static_cast<float>(imageSize.x) / static_cast<float>(imageSize.y));
+   mat4x4 view = imageCamera.GetViewMatrix();
+   mat4x4 projection = imageCamera.GetProjectionMatrix();
+
+   // Tiles are as large as the scene texture, the last row and column may be smaller.
+   u32vec2 tileSize = _viewPortSize;
+   u32vec2 tileCount = (imageSize + tileSize - 1u) / tileSize;
+   u32 bytesPerRow = TextureReadback::GetBytesPerRow(tileSize.x);
+   u64 readbackSize = static_cast<u64>(bytesPerRow) * tileSize.y;
+
+   TileReadback readbacks[TileReadbackCount];
+   for (TileReadback& readback : readbacks) {
+      readback.buffer = TextureReadback::CreateBuffer(_wgpuDevice, "Tile Readback Buffer", tileSize);
+      readback.writer = &writer;
+      readback.bytesPerRow = bytesPerRow;
+      readback.size = readbackSize;
+   }
+
+   // Runs during a device poll once the copy of the tile finished.
+   auto onMapped = [](WGPUBufferMapAsyncStatus status, void* userData) {
+      auto* readback = static_cast<TileReadback*>(userData);
+      readback->pending = false;
+      if (status != WGPUBufferMapAsyncStatus_Success) {
+         readback->failed = true;
+         return;
+      }
+      const u8* pixels = static_cast<const u8*>(wgpuBufferGetConstMappedRange(readback->buffer, 0, readback->size));
+      if (pixels == nullptr || !readback->writer->WriteTile(readback->origin, readback->tileSize, pixels, readback->bytesPerRow)) {
+         readback->failed = true;
+      }
+      wgpuBufferUnmap(readback->buffer);
+   };
+
+   u32 tileIndex = 0;
+   for (u32 tileY = 0; tileY < tileCount.y; ++tileY) {
+      for (u32 tileX = 0; tileX < tileCount.x; ++tileX, ++tileIndex) {
+         TRACE_SCOPE("Tile");
+         // Only waits when the staging buffer still holds a tile that was not written yet.
+         TileReadback& readback = readbacks[tileIndex % TileReadbackCount];
+         while (readback.pending) {
+            wgpuDevicePoll(_wgpuDevice, true, &readback.submission);
+         }
+
+         u32vec2 origin = u32vec2(tileX, tileY) * tileSize;
+         u32vec2 size = min(tileSize, imageSize - origin);
+
+         // Off-axis projection, scales and offsets the part of the image covered by the tile to the whole clip space.
+         vec2 ndcMin = vec2(2.0f * origin.x / imageSize.x - 1.0f, 1.0f - 2.0f * (origin.y + size.y) / imageSize.y);
+         vec2 ndcMax = vec2(2.0f * (origin.x + size.x) / imageSize.x - 1.0f, 1.0f - 2.0f * origin.y / imageSize.y);
+         vec2 tileScale = 2.0f / (ndcMax - ndcMin);
+         vec2 tileOffset = -(ndcMax + ndcMin) / (ndcMax - ndcMin);
+         mat4x4 tileProjection = translate(identity<mat4x4>(), vec3(tileOffset, 0.0f)) * scale(identity<mat4x4>(), vec3(tileScale, 1.0f)) * projection;
+
+         UpdateVisibleChunks(view, tileProjection, size);
+         u32 visibleSplatSlots = pipelines ? static_cast<u32>(_visibleChunks.size()) * SceneCache::ChunkSize : 0;
+
+         // Stochastic transparency accumulates every tile from scratch.
+         _historyValid = false;
+         u32 frameCount = _renderMode == RENDER_MODE_STOCHASTIC ? StochasticCompareFrames : 1;
+         for (u32 frameRun = 0; frameRun < frameCount; ++frameRun) {
+            UpdateUniforms(view, tileProjection, size);
+            CullStats cullStats = { 4, 0, 0, 0, 0, 0 };
+            wgpuQueueWriteBuffer(_wgpuQueue, frame.cullStatsBuffer, 0, &cullStats, sizeof(CullStats));
+
+            WGPUCommandEncoder encoder = CreateCommandEncoder();
+            EncodeOffscreenFrame(encoder, pipelines, frame, _renderMode, visibleSplatSlots, size);
+            if (frameRun + 1 == frameCount) {
+               TextureReadback::EncodeCopy(encoder, _sceneTexture, readback.buffer, size, bytesPerRow);
+            }
+            WGPUCommandBuffer commandBuffer = FinishAndReleaseCommandEncoder(encoder);
+            readback.submission.queue = _wgpuQueue;
+            readback.submission.submissionIndex = wgpuQueueSubmitForIndex(_wgpuQueue, 1, &commandBuffer);
+            wgpuCommandBufferRelease(commandBuffer);
+         }
+
+         // The next tiles render while this one is mapped.
+         readback.origin = origin;
+         readback.tileSize = size;
+         readback.pending = true;
+         wgpuBufferMapAsync(readback.buffer, WGPUMapMode_Read, 0, readbackSize, onMapped, &readback);
+      }
+   }
+
+   bool failed = false;
+   for (TileReadback& readback : readbacks) {
+      while (readback.pending) {
+         wgpuDevicePoll(_wgpuDevice, true, &readback.submission);
+      }
+      failed |= readback.failed;
+      wgpuBufferRelease(readback.buffer);
+   }
+   failed |= !writer.Close();
+
+   if (failed) {
+      std::cerr << "Failed to write tiled render: " << path << std::endl;
+      return false;
+   }
+   float seconds = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - renderStart).count();
+   std::cout << "Wrote " << imageSize.x << "x" << imageSize.y << " render in " << tileCount.x * tileCount.y << " tiles to " << path
+             << " (" << seconds << " s)" << std::endl;
+   return true;
 }
 
-void Renderer::UpdateUniforms(const Camera& camera) const
+void Renderer::UpdateRenderScale()
+{
+   if (!_dynamicResolution) {
+      return;
+   }
+
+   // Prefer GPU pass timings, without timestamp queries the whole CPU frame time is used.
+   float fixedTime = 0.0f;
+   float pixelTime = 0.0f;
+   if (_gpuTimer.IsEnabled()) {
+      if (!_gpuTimer.ConsumeNewResults()) {
+         return;
+      }
+      // Only the splat pass depends on the render resolution.
+      fixedTime = _gpuTimer.GetDuration(GPU_PASS_SH) + _gpuTimer.GetDuration(GPU_PASS_TRANSFORM) +
+                  _gpuTimer.GetDuration(GPU_PASS_SORT) + _gpuTimer.GetDuration(GPU_PASS_UPSCALE);
+      pixelTime = _gpuTimer.GetDuration(GPU_PASS_SPLATS);
+   } else {
+      pixelTime = _performanceData.frameTime;
+   }
+   if (pixelTime <= 0.0f) {
+      return;
+   }
+
+   // Leave the scale alone close to the target to avoid oscillating.
+   float targetFrameTime = 1000.0f / _targetFps;
+   float frameTime = fixedTime + pixelTime;
+   if (std::abs(frameTime - targetFrameTime) < targetFrameTime * 0.05f) {
+      return;
+   }
+
+   // Pixel cost grows with the rendered area, so the scale follows the square root of the time ratio.
+   float pixelBudget = std::max(targetFrameTime - fixedTime, targetFrameTime * 0.1f);
+   float idealScale = _renderScale * std::sqrt(pixelBudget / pixelTime);
+   _renderScale = std::clamp(mix(_renderScale, idealScale, 0.25f), _minRenderScale, 1.0f);
+}
+
+u32vec2 Renderer::GetRenderSize() const
+{
+   return max(u32vec2(round(vec2(_viewPortSize) * _renderScale)), u32vec2(1));
+}
+
+void Renderer::UpdateVisibleChunks(const Camera& camera)
+{
+   UpdateVisibleChunks(camera.GetViewMatrix(), camera.GetProjectionMatrix(), GetRenderSize());
+}
+
+void Renderer::UpdateVisibleChunks(const mat4x4& view, const mat4x4& projection, u32vec2 renderSize)
+{
+   _visibleChunks.clear();
+   if (_chunkCulling) {
+      Frustum frustum(projection * view * _modelMatrix);
+      vec3 cameraPosition = vec3(inverse(_modelMatrix) * inverse(view)[3]);
+
+      // Quad corners reach sqrt(2) * splatScale at unit distance from the camera.
+      float pixelScale = projection[1][1] * static_cast<float>(renderSize.y) * 0.5f;
+      _scene->chunkHierarchy.CollectVisibleChunks(frustum, cameraPosition, _splatScale * 1.5f, pixelScale, _lodEnabled ? _lodPixelError : 0.0f, _visibleChunks);
+   } else {
+      for (u32 c = 0; c < _scene->cache.GetHeader().chunkCount; ++c) {
+         _visibleChunks.push_back(c);
+      }
+   }
+
+   if (!_visibleChunks.empty()) {
+      wgpuQueueWriteBuffer(_wgpuQueue, _frames[_frameIndex].visibleChunksBuffer, 0, _visibleChunks.data(), sizeof(u32) * _visibleChunks.size());
+   }
+}
+
+void Renderer::UpdateUniforms(const Camera& camera)
+{
+   UpdateUniforms(camera.GetViewMatrix(), camera.GetProjectionMatrix(), GetRenderSize());
+}
+
+void Renderer::UpdateUniforms(const mat4x4& view, const mat4x4& projection, u32vec2 renderSize)
 {
    ShaderUniforms uniforms;
    uniforms.model = _modelMatrix;
-   uniforms.view = camera.GetViewMatrix();
-   uniforms.projection = camera.GetProjectionMatrix();
+   uniforms.view = view;
+   uniforms.projection = projection;
    uniforms.splatScale = _splatScale;
-   wgpuQueueWriteBuffer(_wgpuQueue, _uniformBuffer, 0, &uniforms, sizeof(ShaderUniforms));
+   uniforms.cameraPosition = inverse(_modelMatrix) * inverse(uniforms.view)[3];
+   uniforms.shDegree = GetSHDegree();
+   uniforms.shWordsPerSplat = _scene->cache.GetHeader().shWordsPerSplat;
+   uniforms.visibleChunkCount = static_cast<u32>(_visibleChunks.size());
+   uniforms.alphaThreshold = _alphaThreshold;
+   uniforms.pixelAreaThreshold = _pixelAreaThreshold;
+   uniforms.viewportHeight = static_cast<float>(renderSize.y);
+   uniforms.frameIndex = _stochasticFrame;
+   wgpuQueueWriteBuffer(_wgpuQueue, _frames[_frameIndex].uniformBuffer, 0, &uniforms, sizeof(ShaderUniforms));
+   _viewProjection = uniforms.projection * uniforms.view * uniforms.model;
+}
+
+void Renderer::ReadCullStats()
+{
+   // Mapping completes during a later device poll, the counts shown are a few frames old.
+   _cullStatsMapPending = true;
+   auto onMapped = [](WGPUBufferMapAsyncStatus status, void* userData) {
+      auto* renderer = static_cast<Renderer*>(userData);
+      renderer->_cullStatsMapPending = false;
+      if (status != WGPUBufferMapAsyncStatus_Success) {
+         return;
+      }
+
+      const auto* stats = static_cast<const CullStats*>(wgpuBufferGetConstMappedRange(renderer->_cullStatsReadbackBuffer, 0, sizeof(CullStats)));
+      renderer->_performanceData.drawnSplatCount = stats->instanceCount;
+      renderer->_performanceData.alphaCulledCount = stats->alphaCulled;
+      renderer->_performanceData.sizeCulledCount = stats->sizeCulled;
+      wgpuBufferUnmap(renderer->_cullStatsReadbackBuffer);
+   };
+   wgpuBufferMapAsync(_cullStatsReadbackBuffer, WGPUMapMode_Read, 0, sizeof(CullStats), onMapped, this);
 }
 
 WGPUCommandEncoder Renderer::CreateCommandEncoder() const
@@ -755,11 +2808,12 @@ WGPUCommandEncoder Renderer::CreateCommandEncoder() const
    return encoder;
 }
 
-WGPUComputePassEncoder Renderer::BeginComputePass(WGPUCommandEncoder encoder) const
+WGPUComputePassEncoder Renderer::BeginComputePass(WGPUCommandEncoder encoder, const WGPUComputePassTimestampWrites* timestampWrites) const
 {
    WGPUComputePassDescriptor computePassDesc = {};
    computePassDesc.nextInChain = nullptr;
    computePassDesc.label = "Compute Pass";
+   computePassDesc.timestampWrites = timestampWrites;
    WGPUComputePassEncoder computePassEncoder = wgpuCommandEncoderBeginComputePass(encoder, &computePassDesc);
    if (!computePassEncoder) {
       std::cerr << "Failed to begin compute pass!" << std::endl;
@@ -785,7 +2839,7 @@ WGPUTextureView Renderer::CreateTextureView(WGPUTexture texture) const
    WGPUTextureViewDescriptor viewDesc;
    viewDesc.nextInChain = nullptr;
    viewDesc.label = "Surface texture view";
-   viewDesc.format = _surfaceFormat;
+   viewDesc.format = wgpuTextureGetFormat(texture);
    viewDesc.dimension = WGPUTextureViewDimension_2D;
    viewDesc.baseMipLevel = 0;
    viewDesc.mipLevelCount = 1;
@@ -801,7 +2855,7 @@ WGPUTextureView Renderer::CreateTextureView(WGPUTexture texture) const
    return textureView;
 }
 
-WGPURenderPassEncoder Renderer::BeginRenderPass(WGPUCommandEncoder encoder, WGPUTextureView textureView) const
+WGPURenderPassEncoder Renderer::BeginRenderPass(WGPUCommandEncoder encoder, WGPUTextureView textureView, const WGPURenderPassTimestampWrites* timestampWrites) const
 {
    WGPURenderPassDescriptor renderPassDesc = {};
    renderPassDesc.nextInChain = nullptr;
@@ -817,7 +2871,7 @@ WGPURenderPassEncoder Renderer::BeginRenderPass(WGPUCommandEncoder encoder, WGPU
    renderPassDesc.colorAttachmentCount = 1;
    renderPassDesc.colorAttachments = &renderPassColorAttachment;
    renderPassDesc.depthStencilAttachment = nullptr;
-   renderPassDesc.timestampWrites = nullptr;
+   renderPassDesc.timestampWrites = timestampWrites;
 
    WGPURenderPassEncoder renderPassEncoder = wgpuCommandEncoderBeginRenderPass(encoder, &renderPassDesc);
    if (!renderPassEncoder) {
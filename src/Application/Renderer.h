@@ -1,10 +1,23 @@
 #pragma once
 
 #include <webgpu/webgpu.h>
+#include <webgpu/wgpu.h>
 
 #include <Core/Core.h>
+#include <Application/Autotuner.h>
+#include <Application/FrameCapture.h>
+#include <Application/GpuTimer.h>
+#include <Application/ResidentSceneCache.h>
+#include <Application/ThumbnailCache.h>
+#include <Application/ShaderCache.h>
+#include <Utils/SceneCatalog.h>
+#include <Utils/SortSchedule.h>
+#include <Utils/SplatProcessing.h>
+
+#include <chrono>
 
 class Camera;
+class CameraPath;
 struct GLFWwindow;
 
 struct ShaderUniforms {
@@ -12,6 +25,14 @@ struct ShaderUniforms {
    alignas(64) mat4x4 view;
    alignas(64) mat4x4 projection;
    alignas(4) float splatScale;
+   alignas(16) vec4 cameraPosition; // Camera position in model space.
+   alignas(4) u32 shDegree;
+   alignas(4) u32 shWordsPerSplat;
+   alignas(4) u32 visibleChunkCount;
+   alignas(4) float alphaThreshold; // Splats below this opacity are culled.
+   alignas(4) float pixelAreaThreshold; // Splats covering fewer pixels are culled.
+   alignas(4) float viewportHeight;
+   alignas(4) u32 frameIndex; // Seeds the stochastic transparency hash.
 };
 
 struct SortSplatsData {
@@ -19,15 +40,132 @@ struct SortSplatsData {
    alignas(4) f32 z;
 };
 
+// Passes timed with GPU timestamps.
+enum EGpuPass {
+   GPU_PASS_SH,
+   GPU_PASS_TRANSFORM,
+   GPU_PASS_SORT,
+   GPU_PASS_SPLATS,
+   GPU_PASS_UPSCALE,
+   GPU_PASS_COUNT
+};
+
+// How overlapping splats are composited.
+enum ERenderMode {
+   RENDER_MODE_SORTED, // Back to front alpha blending after the bitonic sort.
+   RENDER_MODE_WEIGHTED_OIT, // Weighted blended order independent transparency, skips the sort.
+   RENDER_MODE_STOCHASTIC, // Alpha tested against hashed thresholds with depth testing, averaged over frames.
+   RENDER_MODE_COUNT
+};
+
+// Same view rendered in every mode, measured with blocking submissions.
+struct RenderModeComparison {
+   float times[RENDER_MODE_COUNT] = {}; // Milliseconds from encoding to the end of the splat passes.
+   // Per channel difference of each mode to the sorted image, in 8 bit steps.
+   float meanError[RENDER_MODE_COUNT] = {};
+   float maxError[RENDER_MODE_COUNT] = {};
+   float psnr[RENDER_MODE_COUNT] = {}; // dB, infinite for identical images.
+   bool valid = false;
+};
+
+struct UpscaleUniforms {
+   alignas(8) vec2 uvScale;
+};
+
+struct TemporalUniforms {
+   alignas(16) mat4x4 reprojection; // Current NDC to the previous clip space.
+   alignas(8) vec2 renderSize;
+   alignas(4) float movingHistory;
+   alignas(4) float maxHistory;
+   alignas(4) u32 reset;
+};
+
+// Written by the transform pass, the first four words are the indirect draw arguments.
+struct CullStats {
+   u32 vertexCount;
+   u32 instanceCount;
+   u32 firstVertex;
+   u32 firstInstance;
+   u32 alphaCulled;
+   u32 sizeCulled;
+};
+
+// Bytes of the indirect draw arguments at the start of CullStats.
+constexpr u64 DrawArgsSize = 4 * sizeof(u32);
+
+// Pipelines of one shader permutation.
+struct PipelineVariant {
+   WGPUComputePipeline shPipeline = nullptr; // Only created for permutations with view dependent color.
+   WGPUComputePipeline transformPipeline = nullptr;
+   WGPUComputePipeline sortPipeline = nullptr;
+   WGPUComputePipeline blockSortPipeline = nullptr; // Only created for permutations with the shared sort.
+   WGPUComputePipeline blockMergePipeline = nullptr;
+   WGPURenderPipeline renderPipeline = nullptr;
+   WGPURenderPipeline oitRenderPipeline = nullptr; // Accumulates into the weighted OIT targets.
+   WGPURenderPipeline stochasticRenderPipeline = nullptr; // Alpha tested splats with depth testing.
+};
+
+// Buffers and bind groups written every frame. Each frame in flight has its own set, so the CPU
+// can encode the next frame while the GPU still reads the previous one.
+struct FrameResources {
+   WGPUBuffer uniformBuffer = nullptr;
+   WGPUBuffer sortedSplatsBuffer = nullptr;
+   WGPUBuffer sortSplatsParamsUniform = nullptr;
+   WGPUBuffer visibleChunksBuffer = nullptr;
+   WGPUBuffer cullStatsBuffer = nullptr;
+   WGPUBuffer drawArgsBuffer = nullptr; // Copy of the draw arguments of cullStatsBuffer for the indirect draw.
+   WGPUBuffer upscaleUniformBuffer = nullptr;
+   WGPUBuffer temporalUniformBuffer = nullptr;
+   WGPUBindGroup stateBindGroup = nullptr;
+   WGPUBindGroup upscaleBindGroup = nullptr;
+   WGPUBindGroup temporalUniformBindGroup = nullptr;
+   // Submission that last used these resources.
+   WGPUSubmissionIndex submissionIndex = 0;
+   bool submitted = false;
+};
+
+// Preview of a catalog entry shown in the UI.
+struct ThumbnailTexture {
+   WGPUTexture texture = nullptr;
+   WGPUTextureView view = nullptr;
+   std::filesystem::file_time_type modified; // Of the scene file the preview was rendered from.
+};
+
+// Frame times of the last camera path playback, comparable between runs of the same path.
+struct PlaybackSummary {
+   u32 frameCount = 0;
+   float meanFrameTime = 0.0f; // Milliseconds.
+   float p95FrameTime = 0.0f;
+   float maxFrameTime = 0.0f;
+   u32 missingFrames = 0; // Dropped or failed frames of the playback capture, a complete capture has none.
+   bool valid = false;
+};
+
 struct PerformanceData {
    uint32 pointCount = 0;
+   uint32 chunkCount = 0;
+   uint32 visibleChunkCount = 0;
+   uint32 visibleLodChunkCount = 0;
+   // Read back from the GPU a few frames late.
+   uint32 drawnSplatCount = 0;
+   uint32 alphaCulledCount = 0;
+   uint32 sizeCulledCount = 0;
    float frameTime = 0.0f;
+   float frameInterval = 0.0f; // Time between the starts of consecutive frames.
+   float frameWaitTime = 0.0f; // Time spent waiting for the GPU to release the frame resources.
+   float cpuUtilization = 0.0f;
+   float gpuUtilization = 0.0f; // Only available with timestamp queries.
+   float cullTime = 0.0f;
+   float shTime = 0.0f;
    float sortTime = 0.0f;
    float renderTime = 0.0f;
+   float gpuTimes[GPU_PASS_COUNT] = {}; // Read back from timestamp queries a few frames late.
+   float renderScale = 1.0f;
+   float loadTime = 0.0f;
+   float loadThroughput = 0.0f; // MB/s
+   bool loadedFromCache = false;
 };
 
-struct Splat;
-
 class Renderer {
 private:
    WGPUTextureFormat _surfaceFormat = WGPUTextureFormat_RGBA8Unorm;
@@ -35,19 +173,53 @@ private:
    WGPUDevice _wgpuDevice = nullptr;
    WGPUQueue _wgpuQueue = nullptr;
    WGPUSurface _wgpuSurface = nullptr;
-   WGPUComputePipeline _wgpuTransformComputePipeline = nullptr;
-   WGPUComputePipeline _wgpuSortComputePipeline = nullptr;
-   WGPURenderPipeline _wgpuRenderPipeline = nullptr;
-   WGPUBuffer _splatsBuffer = nullptr;
-   WGPUBuffer _sortedSplatsBuffer = nullptr;
+   WGPURenderPipeline _upscalePipeline = nullptr;
+   WGPUPipelineLayout _upscalePipelineLayout = nullptr;
+   WGPUBindGroupLayout _upscaleBindGroupLayout = nullptr;
+   WGPUSampler _upscaleSampler = nullptr;
+   // Offscreen color target at full viewport size, splats are drawn into its top left part.
+   WGPUTexture _sceneTexture = nullptr;
+   WGPUTextureView _sceneTextureView = nullptr;
+   // Weighted OIT accumulation and revealage targets, resolved into the scene texture.
+   static constexpr WGPUTextureFormat OitAccumFormat = WGPUTextureFormat_RGBA16Float;
+   static constexpr WGPUTextureFormat OitRevealFormat = WGPUTextureFormat_R8Unorm;
+   WGPUTexture _oitAccumTexture = nullptr;
+   WGPUTextureView _oitAccumTextureView = nullptr;
+   WGPUTexture _oitRevealTexture = nullptr;
+   WGPUTextureView _oitRevealTextureView = nullptr;
+   WGPURenderPipeline _oitResolvePipeline = nullptr;
+   WGPUPipelineLayout _oitResolvePipelineLayout = nullptr;
+   WGPUBindGroupLayout _oitResolveBindGroupLayout = nullptr;
+   WGPUBindGroup _oitResolveBindGroup = nullptr;
+   // Stochastic transparency targets and the ping-pong history of the temporal accumulation.
+   static constexpr WGPUTextureFormat StochasticColorFormat = WGPUTextureFormat_RGBA8Unorm;
+   static constexpr WGPUTextureFormat DepthFormat = WGPUTextureFormat_Depth32Float;
+   static constexpr WGPUTextureFormat HistoryFormat = WGPUTextureFormat_RGBA32Float;
+   static constexpr float StochasticMaxHistory = 1024.0f;
+   static constexpr u32 StochasticCompareFrames = 64; // Accumulated frames before the mode comparison reads back.
+   static constexpr u32 TileReadbackCount = 3; // Tiles in flight between rendering and the image file.
+   WGPUTexture _stochasticColorTexture = nullptr;
+   WGPUTextureView _stochasticColorTextureView = nullptr;
+   WGPUTexture _depthTexture = nullptr;
+   WGPUTextureView _depthTextureView = nullptr;
+   WGPUTexture _historyTextures[2] = {};
+   WGPUTextureView _historyTextureViews[2] = {};
+   WGPURenderPipeline _temporalPipeline = nullptr;
+   WGPUPipelineLayout _temporalPipelineLayout = nullptr;
+   WGPUBindGroupLayout _temporalTextureBindGroupLayout = nullptr;
+   WGPUBindGroupLayout _temporalUniformBindGroupLayout = nullptr;
+   WGPUBindGroup _temporalTextureBindGroups[2] = {}; // Reads history texture i.
+   WGPUBuffer _cullStatsReadbackBuffer = nullptr;
    WGPUBuffer _sortSplatsParamsDataBuffer = nullptr;
-   WGPUBuffer _sortSplatsParamsUniform = nullptr;
-   WGPUBuffer _uniformBuffer = nullptr;
    WGPUPipelineLayout _wgpuPipelineLayout = nullptr;
    WGPUBindGroupLayout _sceneBindGroupLayout = nullptr;
-   WGPUBindGroup _sceneBindGroup = nullptr;
    WGPUBindGroupLayout _stateBindGroupLayout = nullptr;
-   WGPUBindGroup _stateBindGroup = nullptr;
+
+   static constexpr u32 FramesInFlight = 2;
+   FrameResources _frames[FramesInFlight];
+   u32 _frameIndex = 0;
+   std::chrono::high_resolution_clock::time_point _lastFrameStart;
+   std::chrono::high_resolution_clock::time_point _lastUiFrame;
 
    ///////////////////////////
    /// Are released after initialization but are needed during initialization.
@@ -55,23 +227,94 @@ private:
    WGPUAdapter _wgpuAdapter = nullptr;
    ///////////////////////////
 
-   std::vector<Splat> _rawSplatsData;
-   std::vector<Splat> _splatsData;
+   ShaderCache _shaderCache;
+   // Keyed by GetPipelineVariantKey, compiled on first use.
+   std::unordered_map<u32, PipelineVariant> _pipelineVariants;
+
+   // Scenes kept on the GPU, the shown one is bound every frame.
+   static constexpr const char* SplatDirectory = "../../../assets/splats";
+   ResidentSceneCache _residentScenes;
+   ResidentScene* _scene = nullptr;
+   u64 _sceneUseCount = 0;
+   // Scene waiting to become resident before it is shown, InvalidHash when there is none.
+   u64 _requestedScene = SceneCache::InvalidHash;
+   std::filesystem::path _requestedPath;
+   // Scene files shown in the file combo, replaced when the catalog publishes a new version.
+   SceneCatalog _catalog;
+   std::shared_ptr<const SceneCatalogSnapshot> _catalogSnapshot;
+   u32 _catalogVersion = 0;
+   // Previews of the catalog entries by file name, rendered in the background.
+   static constexpr float ThumbnailListSize = 48.0f;
+   ThumbnailCache _thumbnails;
+   std::unordered_map<std::string, ThumbnailTexture> _thumbnailTextures;
+   std::vector<u32> _visibleChunks;
    mat4x4 _modelMatrix = identity<mat4x4>();
 
    u32vec2 _viewPortSize = u32vec2{0, 0};
 
-   std::vector<uvec2> _sortSplatsParamsData;
+   // Power of two number of sort keys and visible chunks, large enough for every scene shown so far.
+   u32 _sortCapacity = 0;
+   u32 _chunkCapacity = 0;
+   // Sort steps of the current tuning, uploaded to the sort params buffer.
+   SortSchedule _sortSchedule;
+   TuningConfig _scheduledTuning;
+   bool _cullStatsMapPending = false;
+   bool _timestampQueriesSupported = false;
+   GpuTimer _gpuTimer;
+   FrameCapture _frameCapture;
+   AdapterProfile _adapterProfile;
+   std::vector<TuningResult> _tuningResults;
+   bool _autotuneRequested = false;
+   RenderModeComparison _modeComparison;
+   bool _compareRequested = false;
+   bool _tiledRenderRequested = false;
+   // Camera path playback started from the UI, ends when the path stops playing.
+   bool _playbackActive = false;
+   bool _playbackCapturing = false;
+   std::vector<float> _playbackFrameTimes;
+   PlaybackSummary _playbackSummary;
+   // Temporal accumulation state of the stochastic mode.
+   mat4x4 _viewProjection = identity<mat4x4>(); // Includes the model matrix.
+   mat4x4 _previousViewProjection = identity<mat4x4>();
+   u32 _historyIndex = 0; // History texture holding the latest accumulated frame.
+   bool _historyValid = false;
+   u32vec2 _historyRenderSize = u32vec2{0, 0};
+   u32 _stochasticFrame = 0;
 
    // Settings:
-   int _workGroupSize = 256;
+   // Compute kernel configuration, loaded from the adapter profile and replaced by the autotuner.
+   TuningConfig _tuning;
    float _splatScale = 0.15f;
+   int _shDegreeCap = 3;
+   bool _chunkCulling = true;
+   bool _lodEnabled = true;
+   // Largest projected spread of merged splats drawn instead of their source splats.
+   float _lodPixelError = 2.0f;
+   float _alphaThreshold = 1.0f / 255.0f;
+   float _pixelAreaThreshold = 0.1f;
+   // Dynamic resolution, the render scale is adjusted to hold the target frame rate.
+   bool _dynamicResolution = true;
+   float _targetFps = 60.0f;
+   float _renderScale = 1.0f;
+   float _minRenderScale = 0.5f;
+   ERenderMode _renderMode = RENDER_MODE_SORTED;
+   // History length where the view moved, longer is smoother but ghosts more.
+   float _stochasticMovingHistory = 8.0f;
+   int _sceneBudgetMB = 2048;
+   // Size of the offline tiled render, independent of the window.
+   int _tiledRenderWidth = 16384;
+   int _tiledRenderHeight = 9216;
+   ECaptureFormat _captureFormat = CAPTURE_FORMAT_PNG;
+   bool _capturePlayback = false;
    PerformanceData _performanceData;
 public:
    bool FreeCamera = false;
-   bool ChangeSplatsFlag = false;
+   // Owned by the application, which poses the camera from it. Recorded and played from the UI.
+   CameraPath* Path = nullptr;
    std::string SelectedFile;
    int SelectedFileIndex = 0;
+   // Applied when a scene is loaded, changing them loads the current scene again.
+   SplatProcessingOptions ProcessingOptions;
 
 public:
    bool Initialize(GLFWwindow *window, int windowWidth, int windowHeight, const char* filename);
@@ -82,12 +325,33 @@ public:
 
    vec4 GetModelPosition() const;
 
+   // SH degree used for rendering, limited by the scene and the runtime cap.
+   u32 GetSHDegree() const;
+
 private:
-   bool InitializeImGui(GLFWwindow* window);
+   bool InitializeImGui();
    void ReleaseImGui();
    void ImGuiBeginFrame();
    void ImGuiEndFrame(WGPURenderPassEncoder encoder);
-   void RenderImGuiUI();
+   void RenderImGuiUI(const Camera& camera);
+   // Camera path controls, recording starts from the current camera pose.
+   void RenderCameraPathUI(const Camera& camera);
+   // Stops the capture of the playback and summarizes its frame times.
+   void FinishPlayback();
+
+   // Scene switching, requested scenes are shown once the loader finished and they are uploaded.
+   void RequestScene(const std::filesystem::path& path);
+   void UpdateResidentScenes();
+   void UploadScene(ResidentScene& scene) const;
+   void ShowScene(ResidentScene* scene);
+   // Takes the latest catalog snapshot when the scene directory changed.
+   void UpdateCatalog();
+   // Uploads the thumbnails finished by the thumbnail cache.
+   void UpdateThumbnails();
+   // The thumbnail of the entry, or empty space of the same size while it is rendered.
+   void ShowThumbnail(const SceneCatalogEntry& entry, float size) const;
+   // Prefetches the catalog entries next to the shown scene.
+   void PrefetchNeighbours();
 
    // Initialization functions.
    bool CreateWGPUInstance();
@@ -95,21 +359,73 @@ private:
    bool GetAdapterAndDevice();
    void RequestQueue();
    void ConfigureSurface();
+   void InitializeBindGroupLayouts();
    void InitializeBuffers();
-   void InitializeComputePipelines(WGPUShaderModule shaderModule);
-   void InitializeRenderPipeline(WGPUShaderModule shaderModule);
+   // Grows the sort params and per frame buffers, waits for the frames in flight when they are replaced.
+   void ReserveFrameBuffers(u32 sortCapacity, u32 chunkCount);
+   // Per frame buffers and state bind group for sortCapacity keys and chunkCount visible chunks.
+   void InitializeFrameBuffers(FrameResources& frame, u32 sortCapacity, u32 chunkCount, WGPUBuffer sortParamsDataBuffer);
+   void ReleaseFrameBuffers(FrameResources& frame);
+   WGPUBindGroup CreateSceneBindGroup(WGPUBuffer splatsBuffer, WGPUBuffer shCoefficientsBuffer, WGPUBuffer splatColorsBuffer) const;
+   void InitializeComputePipelines(WGPUShaderModule shaderModule, bool evaluateSH, bool sharedSort, PipelineVariant& variant);
+   void InitializeRenderPipeline(WGPUShaderModule shaderModule, PipelineVariant& variant);
+   void InitializeRenderTarget();
+   void InitializeUpscalePipeline(WGPUShaderModule shaderModule);
+   void InitializeOitResolvePipeline(WGPUShaderModule shaderModule);
+   void InitializeTemporalPipeline(WGPUShaderModule shaderModule);
+
+   // Shader permutations.
+   u32 GetPipelineVariantKey(u32 shDegree, const TuningConfig& tuning) const;
+   const PipelineVariant* GetPipelineVariant(u32 key);
+   // Rebuilds the sort schedule when the tuning changed.
+   void UpdateSortSchedule();
+
+   // Renders the current view in every mode and compares the images and times against the sorted one.
+   void CompareRenderModes(const Camera& camera);
+
+   // Benchmarks every tuning candidate on a synthetic scene, applies the fastest and saves it to the adapter profile.
+   void RunAutotune();
+
+   // Renders an image larger than the surface in tiles of the scene texture size, each with an off-axis
+   // projection and its own culling and sort. Tiles are read back through a ring of staging buffers while
+   // the next ones render and written straight to the image file.
+   bool RenderTiled(const Camera& camera, u32vec2 imageSize, const std::filesystem::path& path);
+   // Culling and splat passes of one offscreen frame into the scene texture, without the upscale and the UI.
+   void EncodeOffscreenFrame(WGPUCommandEncoder encoder, const PipelineVariant* pipelines, const FrameResources& frame, ERenderMode mode,
+                             u32 visibleSplatSlots, u32vec2 renderSize);
 
    // Rendering functions.
-   void UpdateUniforms(const Camera& camera) const;
+   void WaitForFrame(FrameResources& frame);
+   void UpdateRenderScale();
+   u32vec2 GetRenderSize() const;
+   void UpdateVisibleChunks(const Camera& camera);
+   void UpdateVisibleChunks(const mat4x4& view, const mat4x4& projection, u32vec2 renderSize);
+   void UpdateUniforms(const Camera& camera);
+   void UpdateUniforms(const mat4x4& view, const mat4x4& projection, u32vec2 renderSize);
+   void ReadCullStats();
    WGPUCommandEncoder CreateCommandEncoder() const;
+   void EncodeSHPass(WGPUCommandEncoder encoder, const PipelineVariant& pipelines, const FrameResources& frame, u32 visibleSplatSlots, bool timed);
+   // Writes the sort keys and culls, sortCount is a power of two of at least the schedule block size.
+   void EncodeTransformPass(WGPUCommandEncoder encoder, const PipelineVariant& pipelines, WGPUBindGroup sceneBindGroup, const FrameResources& frame,
+                            u32 workGroupSize, u32 sortCount, bool timed);
+   void EncodeSortPasses(WGPUCommandEncoder encoder, const PipelineVariant& pipelines, WGPUBindGroup sceneBindGroup, const FrameResources& frame,
+                         WGPUBuffer sortParamsDataBuffer, const SortSchedule& schedule, u32 workGroupSize, u32 sortCount, bool timed);
+   // Splat passes into the offscreen target, only clear it when pipelines is nullptr. Weighted OIT and
+   // stochastic transparency draw splatSlots unsorted instances, the sorted mode draws the surviving
+   // splats indirectly. The stochastic mode also advances the temporal accumulation.
+   void EncodeSplatPass(WGPUCommandEncoder encoder, const PipelineVariant* pipelines, WGPUBindGroup sceneBindGroup, const FrameResources& frame,
+                        ERenderMode mode, u32 splatSlots, u32vec2 renderSize, bool timed);
+   // Hashed alpha test into the stochastic targets, then accumulation with the reprojected history.
+   void EncodeStochasticPasses(WGPUCommandEncoder encoder, const PipelineVariant* pipelines, WGPUBindGroup sceneBindGroup, const FrameResources& frame,
+                               u32 splatSlots, u32vec2 renderSize, const WGPURenderPassTimestampWrites* timestampWrites);
 
    // Compute pass functions.
-   WGPUComputePassEncoder BeginComputePass(WGPUCommandEncoder encoder) const;
+   WGPUComputePassEncoder BeginComputePass(WGPUCommandEncoder encoder, const WGPUComputePassTimestampWrites* timestampWrites = nullptr) const;
 
    // Render pass functions.
    WGPUSurfaceTexture GetNextSurfaceTexture() const;
    WGPUTextureView CreateTextureView(WGPUTexture texture) const;
-   WGPURenderPassEncoder BeginRenderPass(WGPUCommandEncoder encoder, WGPUTextureView textureView) const;
+   WGPURenderPassEncoder BeginRenderPass(WGPUCommandEncoder encoder, WGPUTextureView textureView, const WGPURenderPassTimestampWrites* timestampWrites = nullptr) const;
 
    // Release functions.
    WGPUCommandBuffer FinishAndReleaseCommandEncoder(WGPUCommandEncoder encoder) const;
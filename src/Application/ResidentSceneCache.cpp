@@ -0,0 +1,245 @@
+#include <GaussianSplatting.h>
+#include <Application/ResidentSceneCache.h>
+#include <Utils/Tracer.h>
+
+#include <algorithm>
+
+bool ResidentScene::Load(const std::filesystem::path& source, const SplatProcessingOptions& options)
+{
+   TRACE_SCOPE("ResidentScene::Load");
+   auto startLoad = std::chrono::high_resolution_clock::now();
+   path = source;
+
+   // Use the scene cache when it was already built from this exact source file. Native scenes
+   // were processed by the converter and are mapped as they are.
+   key = ResidentSceneCache::GetKey(source, options);
+   if (key == SceneCache::InvalidHash) {
+      std::cerr << "Failed to read scene file: " << source << std::endl;
+      return false;
+   }
+   bool isNative = source.extension() == SceneCache::Extension;
+   std::filesystem::path cachePath = isNative ? source : SceneCache::GetCachePath(source, key);
+   bool fromCache = cache.Open(cachePath, isNative ? SceneCache::StandaloneHash : key);
+   if (!fromCache && isNative) {
+      std::cerr << "Failed to open native scene file: " << source << std::endl;
+      return false;
+   }
+   if (!fromCache) {
+      SplatScene scene;
+      if (!FileReader::LoadSplatData(source, scene)) {
+         return false;
+      }
+      SplatProcessing::Process(scene, options);
+
+      cache.Build(scene, key);
+      TRACE_SCOPE("SceneCache::Save");
+      if (!cache.Save(cachePath)) {
+         std::cerr << "Could not write scene cache, the scene will be decoded again on the next load." << std::endl;
+      }
+   }
+   auto endLoad = std::chrono::high_resolution_clock::now();
+
+   // Spatial index over the chunks for coarse culling.
+   {
+      TRACE_SCOPE("ChunkHierarchy::Build");
+      chunkHierarchy.Build(cache.GetChunks(), cache.GetHeader().chunkCount, cache.GetHeader().lodChunkCount);
+   }
+
+   // Report load throughput so the different file formats and the cache can be compared.
+   size_t bytesRead = fromCache ? cache.GetSize() : std::filesystem::file_size(source);
+   float sizeMB = static_cast<float>(bytesRead) / (1024.0f * 1024.0f);
+   loadTime = std::chrono::duration<float, std::milli>(endLoad - startLoad).count();
+   loadThroughput = sizeMB / std::max(loadTime / 1000.0f, 1e-6f);
+   loadedFromCache = fromCache;
+   std::cout << "Loaded " << cache.GetHeader().splatCount << " splats from " << (fromCache ? cachePath : source) << " in " << loadTime << " ms (" << loadThroughput << " MB/s)" << std::endl;
+
+   return true;
+}
+
+u64 ResidentScene::GetGpuSize() const
+{
+   // Matches the buffers created by the renderer, splat colors are only evaluated for scenes with SH.
+   const SceneCacheHeader& header = cache.GetHeader();
+   u64 splats = sizeof(Splat) * header.splatRecordCount;
+   u64 shCoefficients = std::max<u64>(sizeof(u32) * header.shWordsPerSplat * header.splatRecordCount, sizeof(u32));
+   u64 splatColors = header.shDegree > 0 ? sizeof(u32) * header.splatRecordCount : sizeof(u32);
+   return splats + shCoefficients + splatColors;
+}
+
+void ResidentScene::ReleaseBuffers()
+{
+   // Frames still in flight keep their own references to the buffers.
+   if (bindGroup) {
+      wgpuBindGroupRelease(bindGroup);
+      wgpuBufferRelease(splatColorsBuffer);
+      wgpuBufferRelease(shCoefficientsBuffer);
+      wgpuBufferRelease(splatsBuffer);
+   }
+   bindGroup = nullptr;
+   splatColorsBuffer = nullptr;
+   shCoefficientsBuffer = nullptr;
+   splatsBuffer = nullptr;
+   gpuSize = 0;
+}
+
+ResidentSceneCache::~ResidentSceneCache() {
+   Stop();
+}
+
+void ResidentSceneCache::Start() {
+   _stopLoader = false;
+   _loader = std::thread(&ResidentSceneCache::LoaderLoop, this);
+}
+
+void ResidentSceneCache::Stop() {
+   {
+      std::lock_guard lock(_mutex);
+      _stopLoader = true;
+      _requests.clear();
+   }
+   _condition.notify_all();
+   if (_loader.joinable()) {
+      _loader.join();
+   }
+}
+
+u64 ResidentSceneCache::GetKey(const std::filesystem::path& path, const SplatProcessingOptions& options) {
+   return SceneCache::ComputeSourceHash(path, SplatProcessing::HashOptions(options));
+}
+
+ResidentScene* ResidentSceneCache::Find(u64 key) const {
+   for (const std::unique_ptr<ResidentScene>& scene : _scenes) {
+      if (scene->key == key) {
+         return scene.get();
+      }
+   }
+   return nullptr;
+}
+
+void ResidentSceneCache::Request(const std::filesystem::path& path, const SplatProcessingOptions& options, bool prefetch) {
+   u64 key = GetKey(path, options);
+   if (key == SceneCache::InvalidHash || Find(key) != nullptr) {
+      return;
+   }
+
+   {
+      std::lock_guard lock(_mutex);
+      if (_loadingKey == key) {
+         return;
+      }
+      for (const LoadedScene& loaded : _loaded) {
+         if (loaded.key == key) {
+            return;
+         }
+      }
+      auto queued = std::find_if(_requests.begin(), _requests.end(), [key](const LoadRequest& request) { return request.key == key; });
+      if (queued != _requests.end()) {
+         if (prefetch || !queued->prefetch) {
+            return;
+         }
+         _requests.erase(queued);
+      }
+
+      LoadRequest request = { path, options, key, prefetch };
+      if (prefetch) {
+         _requests.push_back(std::move(request));
+      } else {
+         _requests.push_front(std::move(request));
+      }
+   }
+   _condition.notify_one();
+}
+
+std::vector<LoadedScene> ResidentSceneCache::TakeLoaded() {
+   std::vector<LoadedScene> loaded;
+   std::lock_guard lock(_mutex);
+   loaded.swap(_loaded);
+   return loaded;
+}
+
+bool ResidentSceneCache::IsLoading(u64 key) {
+   std::lock_guard lock(_mutex);
+   if (_loadingKey == key) {
+      return true;
+   }
+   for (const LoadRequest& request : _requests) {
+      if (request.key == key) {
+         return true;
+      }
+   }
+   return false;
+}
+
+ResidentScene* ResidentSceneCache::Insert(std::unique_ptr<ResidentScene> scene) {
+   _scenes.push_back(std::move(scene));
+   return _scenes.back().get();
+}
+
+bool ResidentSceneCache::MakeRoom(u64 size, const ResidentScene* keep, bool prefetch) {
+   while (GetResidentSize() + size > _budget) {
+      if (prefetch) {
+         return false;
+      }
+
+      auto oldest = _scenes.end();
+      for (auto it = _scenes.begin(); it != _scenes.end(); ++it) {
+         if (it->get() != keep && (oldest == _scenes.end() || (*it)->lastUsed < (*oldest)->lastUsed)) {
+            oldest = it;
+         }
+      }
+      if (oldest == _scenes.end()) {
+         return false;
+      }
+
+      std::cout << "Evicting " << (*oldest)->path << " from the resident scenes" << std::endl;
+      (*oldest)->ReleaseBuffers();
+      _scenes.erase(oldest);
+   }
+   return true;
+}
+
+void ResidentSceneCache::Clear() {
+   for (std::unique_ptr<ResidentScene>& scene : _scenes) {
+      scene->ReleaseBuffers();
+   }
+   _scenes.clear();
+   std::lock_guard lock(_mutex);
+   _loaded.clear();
+}
+
+u64 ResidentSceneCache::GetResidentSize() const {
+   u64 size = 0;
+   for (const std::unique_ptr<ResidentScene>& scene : _scenes) {
+      size += scene->gpuSize;
+   }
+   return size;
+}
+
+void ResidentSceneCache::LoaderLoop() {
+   Tracer::GetInstance().SetThreadName("Scene loader");
+   while (true) {
+      LoadRequest request;
+      {
+         std::unique_lock lock(_mutex);
+         _condition.wait(lock, [this]() { return _stopLoader || !_requests.empty(); });
+         if (_stopLoader) {
+            return;
+         }
+         request = std::move(_requests.front());
+         _requests.pop_front();
+         _loadingKey = request.key;
+      }
+
+      LoadedScene loaded;
+      loaded.key = request.key;
+      loaded.scene = std::make_unique<ResidentScene>();
+      if (!loaded.scene->Load(request.path, request.options)) {
+         std::cerr << "Failed to load splat data: " << request.path << std::endl;
+         loaded.scene.reset();
+      }
+
+      std::lock_guard lock(_mutex);
+      _loaded.push_back(std::move(loaded));
+      _loadingKey = SceneCache::InvalidHash;
+   }
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <Core/Core.h>
+#include <webgpu/webgpu.h>
+#include <Utils/ChunkHierarchy.h>
+#include <Utils/SceneCache.h>
+#include <Utils/SplatProcessing.h>
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// A scene file loaded with one set of processing options. The CPU side is loaded off the render
+// thread, the buffers and the bind group are created by the renderer when the scene is uploaded.
+struct ResidentScene {
+   std::filesystem::path path;
+   u64 key = 0; // Source hash of the scene cache, covers the file identity and the options.
+   SceneCache cache;
+   ChunkHierarchy chunkHierarchy;
+   float loadTime = 0.0f; // Milliseconds.
+   float loadThroughput = 0.0f; // MB/s
+   bool loadedFromCache = false;
+
+   WGPUBuffer splatsBuffer = nullptr;
+   WGPUBuffer shCoefficientsBuffer = nullptr;
+   WGPUBuffer splatColorsBuffer = nullptr;
+   WGPUBindGroup bindGroup = nullptr;
+   u64 gpuSize = 0; // Bytes of the buffers above.
+   u64 lastUsed = 0; // Order in which scenes were last shown, 0 for prefetched scenes not shown yet.
+
+   // Maps the scene cache, or decodes and processes the source file and writes the cache.
+   bool Load(const std::filesystem::path& source, const SplatProcessingOptions& options);
+
+   // Bytes of GPU buffers the scene needs.
+   [[nodiscard]] u64 GetGpuSize() const;
+
+   void ReleaseBuffers();
+};
+
+// Scenes loaded by the loader thread, uploaded by the renderer on the render thread.
+struct LoadedScene {
+   u64 key = 0;
+   std::unique_ptr<ResidentScene> scene; // nullptr when loading failed.
+};
+
+// Least recently used set of scenes kept on the GPU under a byte budget, so switching back to a scene
+// only swaps its bind group. A loader thread reads requested scenes and prefetches the neighbours of
+// the shown one, loads requested for display go before prefetches.
+class ResidentSceneCache {
+private:
+   struct LoadRequest {
+      std::filesystem::path path;
+      SplatProcessingOptions options;
+      u64 key = 0;
+      bool prefetch = false;
+   };
+
+   // Render thread only.
+   std::vector<std::unique_ptr<ResidentScene>> _scenes;
+   u64 _budget = 2048ull * 1024 * 1024;
+
+   // Shared with the loader thread.
+   std::thread _loader;
+   std::mutex _mutex;
+   std::condition_variable _condition;
+   std::deque<LoadRequest> _requests;
+   std::vector<LoadedScene> _loaded;
+   u64 _loadingKey = SceneCache::InvalidHash; // Scene the loader is working on, InvalidHash when idle.
+   bool _stopLoader = false;
+
+public:
+   ResidentSceneCache() = default;
+
+   ~ResidentSceneCache();
+
+   ResidentSceneCache(const ResidentSceneCache&) = delete;
+
+   ResidentSceneCache& operator=(const ResidentSceneCache&) = delete;
+
+   void Start();
+
+   // Stops the loader thread, queued requests are dropped.
+   void Stop();
+
+   // SceneCache::InvalidHash when the file cannot be read.
+   static u64 GetKey(const std::filesystem::path& path, const SplatProcessingOptions& options);
+
+   [[nodiscard]] ResidentScene* Find(u64 key) const;
+
+   // Queues a load unless the scene is unreadable, resident, queued or loading. Requesting a queued prefetch moves it to the front.
+   void Request(const std::filesystem::path& path, const SplatProcessingOptions& options, bool prefetch);
+
+   // Scenes finished by the loader thread since the last call.
+   std::vector<LoadedScene> TakeLoaded();
+
+   [[nodiscard]] bool IsLoading(u64 key);
+
+   ResidentScene* Insert(std::unique_ptr<ResidentScene> scene);
+
+   // Evicts the least recently used scenes other than keep until size more bytes fit in the budget.
+   // Prefetched scenes only use free budget, they never evict. Returns whether size fits.
+   bool MakeRoom(u64 size, const ResidentScene* keep, bool prefetch);
+
+   // Releases every resident scene, the device must be idle.
+   void Clear();
+
+   void SetBudget(u64 budget) { _budget = budget; }
+
+   [[nodiscard]] u64 GetBudget() const { return _budget; }
+
+   [[nodiscard]] u64 GetResidentSize() const;
+
+   [[nodiscard]] u32 GetResidentCount() const { return static_cast<u32>(_scenes.size()); }
+
+private:
+   void LoaderLoop();
+};
@@ -0,0 +1,66 @@
+#include <GaussianSplatting.h>
+#include <Application/ShaderCache.h>
+
+#include <Utils/FileReader.h>
+#include <Utils/Hash.h>
+#include <Utils/Tracer.h>
+
+void ShaderCache::Initialize(WGPUDevice device) {
+   _device = device;
+}
+
+void ShaderCache::Release() {
+   for (auto& [key, module] : _modules) {
+      wgpuShaderModuleRelease(module);
+   }
+   _modules.clear();
+   _sources.clear();
+   _device = nullptr;
+}
+
+WGPUShaderModule ShaderCache::GetModule(const std::filesystem::path& path, const ShaderDefines& defines) {
+   std::string pathString = path.generic_string();
+   u64 key = Hash::Fnv1a(pathString.data(), pathString.size(), ShaderPreprocessor::HashDefines(defines));
+   auto module = _modules.find(key);
+   if (module != _modules.end()) {
+      return module->second;
+   }
+
+   TRACE_SCOPE("ShaderCache::Compile");
+   auto source = _sources.find(pathString);
+   if (source == _sources.end()) {
+      std::string text;
+      if (!FileReader::LoadTextFile(path, text)) {
+         std::cerr << "Failed to open shader file: " << path << std::endl;
+         return nullptr;
+      }
+      source = _sources.emplace(pathString, std::move(text)).first;
+   }
+
+   std::string processed;
+   if (!ShaderPreprocessor::Process(source->second, defines, processed)) {
+      std::cerr << "Failed to preprocess shader: " << path << std::endl;
+      return nullptr;
+   }
+
+   WGPUShaderModule shaderModule = CreateShaderModule(processed, _device);
+   if (shaderModule != nullptr) {
+      _modules.emplace(key, shaderModule);
+   }
+   return shaderModule;
+}
+
+WGPUShaderModule ShaderCache::CreateShaderModule(const std::string& source, WGPUDevice device) {
+   TRACE_SCOPE("ShaderCache::CreateShaderModule");
+   WGPUShaderModuleDescriptor shaderDesc = {};
+#ifdef WEBGPU_BACKEND_WGPU
+   shaderDesc.hintCount = 0;
+   shaderDesc.hints = nullptr;
+#endif
+   WGPUShaderModuleWGSLDescriptor shaderCodeDesc{};
+   shaderCodeDesc.chain.next = nullptr; // Set the chained struct's header
+   shaderCodeDesc.chain.sType = WGPUSType_ShaderModuleWGSLDescriptor;
+   shaderDesc.nextInChain = &shaderCodeDesc.chain; // Connect the chain
+   shaderCodeDesc.code = source.c_str();
+   return wgpuDeviceCreateShaderModule(device, &shaderDesc);
+}
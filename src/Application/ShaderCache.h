@@ -0,0 +1,29 @@
+#pragma once
+
+#include <Core/Core.h>
+#include <Utils/ShaderPreprocessor.h>
+#include <webgpu/webgpu.h>
+
+#include <unordered_map>
+
+// Compiles shader permutations on first use and keeps them for the lifetime of the device, so every
+// combination of source file and defines is preprocessed and compiled once.
+class ShaderCache {
+private:
+   WGPUDevice _device = nullptr;
+   std::unordered_map<std::string, std::string> _sources;
+   std::unordered_map<u64, WGPUShaderModule> _modules;
+
+public:
+   void Initialize(WGPUDevice device);
+
+   void Release();
+
+   // Returns nullptr when the file is missing or the preprocessor fails. The cache owns the module.
+   WGPUShaderModule GetModule(const std::filesystem::path& path, const ShaderDefines& defines = {});
+
+   [[nodiscard]] size_t GetModuleCount() const { return _modules.size(); }
+
+   // Compiles preprocessed WGSL source, the caller owns the module.
+   static WGPUShaderModule CreateShaderModule(const std::string& source, WGPUDevice device);
+};
@@ -0,0 +1,67 @@
+#include <GaussianSplatting.h>
+#include <Application/TextureReadback.h>
+
+#include <webgpu/wgpu.h>
+
+u32 TextureReadback::GetBytesPerRow(u32 width) {
+   return (width * 4 + 255) / 256 * 256;
+}
+
+WGPUBuffer TextureReadback::CreateBuffer(WGPUDevice device, const char* label, u32vec2 maxSize) {
+   WGPUBufferDescriptor bufferDesc = {};
+   bufferDesc.nextInChain = nullptr;
+   bufferDesc.label = label;
+   bufferDesc.usage = WGPUBufferUsage_MapRead | WGPUBufferUsage_CopyDst;
+   bufferDesc.size = static_cast<u64>(GetBytesPerRow(maxSize.x)) * maxSize.y;
+   return wgpuDeviceCreateBuffer(device, &bufferDesc);
+}
+
+void TextureReadback::EncodeCopy(WGPUCommandEncoder encoder, WGPUTexture texture, WGPUBuffer buffer, u32vec2 size, u32 bytesPerRow) {
+   WGPUImageCopyTexture source = {};
+   source.texture = texture;
+   source.mipLevel = 0;
+   source.origin = { 0, 0, 0 };
+   source.aspect = WGPUTextureAspect_All;
+   WGPUImageCopyBuffer destination = {};
+   destination.buffer = buffer;
+   destination.layout.offset = 0;
+   destination.layout.bytesPerRow = bytesPerRow;
+   destination.layout.rowsPerImage = size.y;
+   WGPUExtent3D copySize = { size.x, size.y, 1 };
+   wgpuCommandEncoderCopyTextureToBuffer(encoder, &source, &destination, &copySize);
+}
+
+void TextureReadback::UnpadRows(const u8* padded, u32 bytesPerRow, u32vec2 size, std::vector<u8>& pixels) {
+   size_t rowSize = static_cast<size_t>(size.x) * 4;
+   pixels.resize(rowSize * size.y);
+   for (u32 y = 0; y < size.y; ++y) {
+      memcpy(&pixels[y * rowSize], padded + static_cast<size_t>(y) * bytesPerRow, rowSize);
+   }
+}
+
+bool TextureReadback::ReadBlocking(WGPUDevice device, WGPUBuffer buffer, u32 bytesPerRow, u32vec2 size, std::vector<u8>& pixels) {
+   struct MapResult {
+      bool done = false;
+      WGPUBufferMapAsyncStatus status = WGPUBufferMapAsyncStatus_Unknown;
+   } mapResult;
+   auto onMapped = [](WGPUBufferMapAsyncStatus status, void* userData) {
+      auto* result = static_cast<MapResult*>(userData);
+      result->status = status;
+      result->done = true;
+   };
+   u64 mapSize = static_cast<u64>(bytesPerRow) * size.y;
+   wgpuBufferMapAsync(buffer, WGPUMapMode_Read, 0, mapSize, onMapped, &mapResult);
+   while (!mapResult.done) {
+      wgpuDevicePoll(device, true, nullptr);
+   }
+   if (mapResult.status != WGPUBufferMapAsyncStatus_Success) {
+      return false;
+   }
+
+   const u8* padded = static_cast<const u8*>(wgpuBufferGetConstMappedRange(buffer, 0, mapSize));
+   if (padded != nullptr) {
+      UnpadRows(padded, bytesPerRow, size, pixels);
+   }
+   wgpuBufferUnmap(buffer);
+   return padded != nullptr;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <Core/Core.h>
+#include <webgpu/webgpu.h>
+
+// Copies of RGBA8 textures into mappable buffers. Rows of texture copies are aligned to 256 bytes,
+// the buffers hold padded rows that are unpadded after mapping.
+class TextureReadback {
+public:
+   static u32 GetBytesPerRow(u32 width);
+
+   // Mappable buffer holding copies up to maxSize.
+   static WGPUBuffer CreateBuffer(WGPUDevice device, const char* label, u32vec2 maxSize);
+
+   // Records a copy of the top left size pixels of the texture, rows are bytesPerRow apart in the buffer.
+   static void EncodeCopy(WGPUCommandEncoder encoder, WGPUTexture texture, WGPUBuffer buffer, u32vec2 size, u32 bytesPerRow);
+
+   // Copies the size pixels of padded rows into tightly packed rows.
+   static void UnpadRows(const u8* padded, u32 bytesPerRow, u32vec2 size, std::vector<u8>& pixels);
+
+   // Maps the buffer after the submitted copy finished, blocks until it is mapped and unpads its rows.
+   // Returns false when the map failed.
+   static bool ReadBlocking(WGPUDevice device, WGPUBuffer buffer, u32 bytesPerRow, u32vec2 size, std::vector<u8>& pixels);
+};
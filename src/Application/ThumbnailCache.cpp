@@ -0,0 +1,267 @@
+#include <GaussianSplatting.h>
+#include <Application/ThumbnailCache.h>
+#include <Utils/Hash.h>
+#include <Utils/MappedFile.h>
+#include <Utils/SceneCache.h>
+#include <Utils/TiledImageWriter.h>
+#include <Utils/Tracer.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+// Reads a binary PPM of the given size written by TiledImageWriter into RGBA8 pixels.
+static bool ReadThumbnail(const std::filesystem::path& path, u32 size, std::vector<u8>& pixels) {
+   std::ifstream file(path, std::ios::binary);
+   std::string magic;
+   u32 width = 0, height = 0, maxValue = 0;
+   file >> magic >> width >> height >> maxValue;
+   file.get();
+   if (!file.good() || magic != "P6" || width != size || height != size || maxValue != 255) {
+      return false;
+   }
+
+   std::vector<u8> rgb(static_cast<size_t>(size) * size * 3);
+   file.read(reinterpret_cast<char*>(rgb.data()), static_cast<std::streamsize>(rgb.size()));
+   if (static_cast<size_t>(file.gcount()) != rgb.size()) {
+      return false;
+   }
+   pixels.resize(static_cast<size_t>(size) * size * 4);
+   for (size_t i = 0; i < static_cast<size_t>(size) * size; ++i) {
+      pixels[i * 4 + 0] = rgb[i * 3 + 0];
+      pixels[i * 4 + 1] = rgb[i * 3 + 1];
+      pixels[i * 4 + 2] = rgb[i * 3 + 2];
+      pixels[i * 4 + 3] = 255;
+   }
+   return true;
+}
+
+ThumbnailCache::~ThumbnailCache() {
+   Stop();
+}
+
+void ThumbnailCache::Start(const std::filesystem::path& directory) {
+   _directory = directory;
+   _stopWorker = false;
+   _worker = std::thread(&ThumbnailCache::WorkerLoop, this);
+}
+
+void ThumbnailCache::Stop() {
+   {
+      std::lock_guard lock(_mutex);
+      _stopWorker = true;
+      _requests.clear();
+   }
+   _condition.notify_all();
+   if (_worker.joinable()) {
+      _worker.join();
+   }
+}
+
+void ThumbnailCache::Request(const std::filesystem::path& path, std::filesystem::file_time_type modified) {
+   std::string pathString = path.generic_string();
+   u64 identity = Hash::Fnv1a(pathString.data(), pathString.size());
+   identity = Hash::Fnv1aValue(modified.time_since_epoch().count(), identity);
+   if (!_requested.insert(identity).second) {
+      return;
+   }
+
+   {
+      std::lock_guard lock(_mutex);
+      _requests.push_back({ path, modified });
+   }
+   _condition.notify_one();
+}
+
+std::vector<Thumbnail> ThumbnailCache::TakeReady() {
+   std::vector<Thumbnail> ready;
+   std::lock_guard lock(_mutex);
+   ready.swap(_ready);
+   return ready;
+}
+
+void ThumbnailCache::Rasterize(const std::vector<Splat>& splats, u32 size, std::vector<u8>& pixels) {
+   TRACE_SCOPE("ThumbnailCache::Rasterize");
+   std::vector<vec3> colors(static_cast<size_t>(size) * size, vec3(1.0f));
+   size_t step = std::max<size_t>(splats.size() / MaxSplats, 1);
+
+   // Frame the sphere around the mean holding 90% of the splats, floaters far outside would shrink the scene to a dot.
+   vec3 center(0.0f);
+   size_t sampleCount = 0;
+   for (size_t i = 0; i < splats.size(); i += step) {
+      center += vec3(splats[i].position);
+      ++sampleCount;
+   }
+   center /= static_cast<float>(std::max<size_t>(sampleCount, 1));
+   std::vector<float> distances;
+   distances.reserve(sampleCount);
+   for (size_t i = 0; i < splats.size(); i += step) {
+      distances.push_back(length(vec3(splats[i].position) - center));
+   }
+   float radius = 1.0f;
+   if (!distances.empty()) {
+      auto percentile = distances.begin() + static_cast<std::ptrdiff_t>(distances.size() * 9 / 10);
+      std::nth_element(distances.begin(), percentile, distances.end());
+      radius = std::max(*percentile, 1e-3f);
+   }
+
+   // Same direction as the initial orbit camera, which looks along +X with -Y up.
+   const float fov = radians(45.0f);
+   const vec3 forward(1.0f, 0.0f, 0.0f);
+   const float distance = radius / std::sin(fov * 0.5f);
+   mat4x4 view = lookAt(center - forward * distance, center, vec3(0.0f, -1.0f, 0.0f));
+   mat4x4 projection = perspective(fov, 1.0f, distance * 0.01f, distance * 4.0f);
+   const float focal = projection[1][1] * static_cast<float>(size) * 0.5f;
+
+   struct Disc {
+      float depth;
+      vec2 center;
+      float sigma;
+      vec3 color;
+      float opacity;
+   };
+   std::vector<Disc> discs;
+   discs.reserve(sampleCount);
+   for (size_t i = 0; i < splats.size(); i += step) {
+      const Splat& splat = splats[i];
+      vec4 viewPosition = view * vec4(vec3(splat.position), 1.0f);
+      float depth = -viewPosition.z;
+      vec4 clip = projection * viewPosition;
+      if (depth <= distance * 0.01f || clip.w <= 0.0f) {
+         continue;
+      }
+
+      vec2 ndc = vec2(clip) / clip.w;
+      Disc disc;
+      disc.depth = depth;
+      disc.center = vec2((ndc.x * 0.5f + 0.5f) * static_cast<float>(size), (0.5f - ndc.y * 0.5f) * static_cast<float>(size));
+      // Subsampled scenes draw fewer, larger discs to keep the coverage.
+      float scale = std::max(std::max(splat.scale.x, splat.scale.y), splat.scale.z) * std::sqrt(static_cast<float>(step));
+      disc.sigma = clamp(scale * focal / depth, 0.5f, static_cast<float>(size) / 8.0f);
+      disc.color = vec3(static_cast<float>((splat.color >> 24) & 0xFF), static_cast<float>((splat.color >> 16) & 0xFF),
+                        static_cast<float>((splat.color >> 8) & 0xFF)) / 255.0f;
+      disc.opacity = static_cast<float>(splat.color & 0xFF) / 255.0f;
+      discs.push_back(disc);
+   }
+   std::sort(discs.begin(), discs.end(), [](const Disc& a, const Disc& b) { return a.depth > b.depth; });
+
+   // Back to front alpha blending of gaussian discs, cut off at three standard deviations.
+   const int imageSize = static_cast<int>(size);
+   for (const Disc& disc : discs) {
+      float extent = disc.sigma * 3.0f;
+      int x0 = std::max(static_cast<int>(std::floor(disc.center.x - extent)), 0);
+      int x1 = std::min(static_cast<int>(std::ceil(disc.center.x + extent)), imageSize - 1);
+      int y0 = std::max(static_cast<int>(std::floor(disc.center.y - extent)), 0);
+      int y1 = std::min(static_cast<int>(std::ceil(disc.center.y + extent)), imageSize - 1);
+      float inverseVariance = 1.0f / (disc.sigma * disc.sigma);
+      for (int y = y0; y <= y1; ++y) {
+         for (int x = x0; x <= x1; ++x) {
+            vec2 offset = vec2(static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f) - disc.center;
+            float alpha = disc.opacity * std::exp(-0.5f * dot(offset, offset) * inverseVariance);
+            if (alpha < 1.0f / 255.0f) {
+               continue;
+            }
+            vec3& color = colors[static_cast<size_t>(y) * size + x];
+            color = mix(color, disc.color, alpha);
+         }
+      }
+   }
+
+   pixels.resize(static_cast<size_t>(size) * size * 4);
+   for (size_t i = 0; i < colors.size(); ++i) {
+      pixels[i * 4 + 0] = static_cast<u8>(clamp(colors[i].r, 0.0f, 1.0f) * 255.0f + 0.5f);
+      pixels[i * 4 + 1] = static_cast<u8>(clamp(colors[i].g, 0.0f, 1.0f) * 255.0f + 0.5f);
+      pixels[i * 4 + 2] = static_cast<u8>(clamp(colors[i].b, 0.0f, 1.0f) * 255.0f + 0.5f);
+      pixels[i * 4 + 3] = 255;
+   }
+}
+
+void ThumbnailCache::WorkerLoop() {
+   Tracer::GetInstance().SetThreadName("Thumbnails");
+   LoadIndex();
+   while (true) {
+      ThumbnailRequest request;
+      {
+         std::unique_lock lock(_mutex);
+         _condition.wait(lock, [this]() { return _stopWorker || !_requests.empty(); });
+         if (_stopWorker) {
+            return;
+         }
+         request = std::move(_requests.front());
+         _requests.pop_front();
+      }
+
+      Thumbnail thumbnail;
+      if (!Generate(request, thumbnail)) {
+         continue;
+      }
+      std::lock_guard lock(_mutex);
+      _ready.push_back(std::move(thumbnail));
+   }
+}
+
+bool ThumbnailCache::Generate(const ThumbnailRequest& request, Thumbnail& thumbnail) {
+   TRACE_SCOPE("ThumbnailCache::Generate");
+   thumbnail.name = request.path.filename().string();
+   thumbnail.modified = request.modified;
+
+   u64 identity = SceneCache::ComputeSourceHash(request.path, 0);
+   u64 contentHash = identity != SceneCache::InvalidHash ? GetContentHash(request.path, identity) : 0;
+   if (contentHash == 0) {
+      return false;
+   }
+
+   std::ostringstream name;
+   name << std::hex << std::setw(16) << std::setfill('0') << contentHash << ".ppm";
+   std::filesystem::path imagePath = _directory / name.str();
+   if (ReadThumbnail(imagePath, Size, thumbnail.pixels)) {
+      return true;
+   }
+
+   SplatScene scene;
+   if (request.path.extension() == SceneCache::Extension) {
+      SceneCache native;
+      if (!native.Open(request.path, SceneCache::StandaloneHash)) {
+         return false;
+      }
+      scene.splats.assign(native.GetSplats(), native.GetSplats() + native.GetHeader().splatCount);
+   } else if (!FileReader::LoadSplatData(request.path, scene)) {
+      return false;
+   }
+   Rasterize(scene.splats, Size, thumbnail.pixels);
+
+   TiledImageWriter writer;
+   if (!writer.Open(imagePath, u32vec2(Size)) || !writer.WriteTile(u32vec2(0), u32vec2(Size), thumbnail.pixels.data(), Size * 4) || !writer.Close()) {
+      std::cerr << "Could not write thumbnail, it will be rendered again on the next start: " << imagePath << std::endl;
+   }
+   return true;
+}
+
+u64 ThumbnailCache::GetContentHash(const std::filesystem::path& path, u64 identity) {
+   auto known = _contentHashes.find(identity);
+   if (known != _contentHashes.end()) {
+      return known->second;
+   }
+
+   TRACE_SCOPE("ThumbnailCache::HashContent");
+   MappedFile file;
+   if (!file.Open(path)) {
+      return 0;
+   }
+   u64 contentHash = Hash::Fnv1a(file.GetData(), file.GetSize());
+   _contentHashes[identity] = contentHash;
+
+   std::error_code error;
+   std::filesystem::create_directories(_directory, error);
+   std::ofstream index(_directory / "index.txt", std::ios::app);
+   index << std::hex << identity << " " << contentHash << "\n";
+   return contentHash;
+}
+
+void ThumbnailCache::LoadIndex() {
+   std::ifstream index(_directory / "index.txt");
+   u64 identity = 0, contentHash = 0;
+   while (index >> std::hex >> identity >> contentHash) {
+      _contentHashes[identity] = contentHash;
+   }
+}
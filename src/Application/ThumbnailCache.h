@@ -0,0 +1,79 @@
+#pragma once
+
+#include <Core/Core.h>
+#include <Utils/FileReader.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+// Preview of a scene file, RGBA8 rows of Size x Size pixels.
+struct Thumbnail {
+   std::string name; // File name of the scene.
+   std::filesystem::file_time_type modified;
+   std::vector<u8> pixels;
+};
+
+// Small previews of scene files, rendered on the CPU by a background thread and cached on disk as PPM
+// images named after the content hash of the scene file. Renamed or copied scenes reuse their preview,
+// an index maps the file identity to its content hash so unchanged files are not hashed again.
+class ThumbnailCache {
+public:
+   static constexpr u32 Size = 128;
+   // Splats rasterized per thumbnail, larger scenes are subsampled evenly.
+   static constexpr u32 MaxSplats = 1u << 18;
+
+private:
+   struct ThumbnailRequest {
+      std::filesystem::path path;
+      std::filesystem::file_time_type modified;
+   };
+
+   std::filesystem::path _directory;
+   std::thread _worker;
+   std::mutex _mutex;
+   std::condition_variable _condition;
+   std::deque<ThumbnailRequest> _requests;
+   std::vector<Thumbnail> _ready;
+   bool _stopWorker = false;
+   // Render thread only, file identities already requested.
+   std::unordered_set<u64> _requested;
+   // Worker only, file identity to content hash, mirrored in the index file.
+   std::unordered_map<u64, u64> _contentHashes;
+
+public:
+   ThumbnailCache() = default;
+
+   ~ThumbnailCache();
+
+   ThumbnailCache(const ThumbnailCache&) = delete;
+
+   ThumbnailCache& operator=(const ThumbnailCache&) = delete;
+
+   void Start(const std::filesystem::path& directory);
+
+   // Stops the worker, queued thumbnails are dropped.
+   void Stop();
+
+   // Queues the thumbnail of a scene file unless it was requested before with this modification time.
+   void Request(const std::filesystem::path& path, std::filesystem::file_time_type modified);
+
+   // Thumbnails finished since the last call.
+   std::vector<Thumbnail> TakeReady();
+
+   // Splats as blurred discs sorted back to front, seen from the initial orbit camera direction and
+   // framed to hold most of the splats. Far outliers are left outside the frame.
+   static void Rasterize(const std::vector<Splat>& splats, u32 size, std::vector<u8>& pixels);
+
+private:
+   void WorkerLoop();
+
+   bool Generate(const ThumbnailRequest& request, Thumbnail& thumbnail);
+
+   u64 GetContentHash(const std::filesystem::path& path, u64 identity);
+
+   void LoadIndex();
+};
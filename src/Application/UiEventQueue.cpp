@@ -0,0 +1,138 @@
+#include <GaussianSplatting.h>
+#include <Application/UiEventQueue.h>
+
+#include <GLFW/glfw3.h>
+
+#include "imgui.h"
+
+// Keys used by the widgets of the UI, other keys are not forwarded.
+static ImGuiKey ToImGuiKey(int key) {
+   if (key >= GLFW_KEY_0 && key <= GLFW_KEY_9) {
+      return static_cast<ImGuiKey>(ImGuiKey_0 + (key - GLFW_KEY_0));
+   }
+   if (key >= GLFW_KEY_A && key <= GLFW_KEY_Z) {
+      return static_cast<ImGuiKey>(ImGuiKey_A + (key - GLFW_KEY_A));
+   }
+   switch (key) {
+      case GLFW_KEY_TAB: return ImGuiKey_Tab;
+      case GLFW_KEY_LEFT: return ImGuiKey_LeftArrow;
+      case GLFW_KEY_RIGHT: return ImGuiKey_RightArrow;
+      case GLFW_KEY_UP: return ImGuiKey_UpArrow;
+      case GLFW_KEY_DOWN: return ImGuiKey_DownArrow;
+      case GLFW_KEY_PAGE_UP: return ImGuiKey_PageUp;
+      case GLFW_KEY_PAGE_DOWN: return ImGuiKey_PageDown;
+      case GLFW_KEY_HOME: return ImGuiKey_Home;
+      case GLFW_KEY_END: return ImGuiKey_End;
+      case GLFW_KEY_INSERT: return ImGuiKey_Insert;
+      case GLFW_KEY_DELETE: return ImGuiKey_Delete;
+      case GLFW_KEY_BACKSPACE: return ImGuiKey_Backspace;
+      case GLFW_KEY_SPACE: return ImGuiKey_Space;
+      case GLFW_KEY_ENTER: return ImGuiKey_Enter;
+      case GLFW_KEY_KP_ENTER: return ImGuiKey_KeypadEnter;
+      case GLFW_KEY_ESCAPE: return ImGuiKey_Escape;
+      case GLFW_KEY_MINUS: return ImGuiKey_Minus;
+      case GLFW_KEY_PERIOD: return ImGuiKey_Period;
+      case GLFW_KEY_LEFT_SHIFT: return ImGuiKey_LeftShift;
+      case GLFW_KEY_LEFT_CONTROL: return ImGuiKey_LeftCtrl;
+      case GLFW_KEY_LEFT_ALT: return ImGuiKey_LeftAlt;
+      case GLFW_KEY_LEFT_SUPER: return ImGuiKey_LeftSuper;
+      case GLFW_KEY_RIGHT_SHIFT: return ImGuiKey_RightShift;
+      case GLFW_KEY_RIGHT_CONTROL: return ImGuiKey_RightCtrl;
+      case GLFW_KEY_RIGHT_ALT: return ImGuiKey_RightAlt;
+      case GLFW_KEY_RIGHT_SUPER: return ImGuiKey_RightSuper;
+      default: return ImGuiKey_None;
+   }
+}
+
+void UiEventQueue::Install(GLFWwindow* window) {
+   _previousCursorPosCallback = glfwSetCursorPosCallback(window, CursorPosCallback);
+   _previousMouseButtonCallback = glfwSetMouseButtonCallback(window, MouseButtonCallback);
+   glfwSetScrollCallback(window, ScrollCallback);
+   _previousKeyCallback = glfwSetKeyCallback(window, KeyCallback);
+   glfwSetCharCallback(window, CharCallback);
+   glfwSetWindowFocusCallback(window, FocusCallback);
+}
+
+void UiEventQueue::Apply(ImGuiIO& io) {
+   UiEvent event;
+   while (_events.Pop(event)) {
+      switch (event.type) {
+         case UI_EVENT_MOUSE_POSITION:
+            io.AddMousePosEvent(event.value.x, event.value.y);
+            break;
+         case UI_EVENT_MOUSE_BUTTON:
+            if (event.code >= 0 && event.code < ImGuiMouseButton_COUNT) {
+               io.AddMouseButtonEvent(event.code, event.down);
+            }
+            break;
+         case UI_EVENT_SCROLL:
+            io.AddMouseWheelEvent(event.value.x, event.value.y);
+            break;
+         case UI_EVENT_KEY: {
+            io.AddKeyEvent(ImGuiMod_Ctrl, (event.mods & GLFW_MOD_CONTROL) != 0);
+            io.AddKeyEvent(ImGuiMod_Shift, (event.mods & GLFW_MOD_SHIFT) != 0);
+            io.AddKeyEvent(ImGuiMod_Alt, (event.mods & GLFW_MOD_ALT) != 0);
+            io.AddKeyEvent(ImGuiMod_Super, (event.mods & GLFW_MOD_SUPER) != 0);
+            ImGuiKey key = ToImGuiKey(event.code);
+            if (key != ImGuiKey_None) {
+               io.AddKeyEvent(key, event.down);
+            }
+            break;
+         }
+         case UI_EVENT_CHARACTER:
+            io.AddInputCharacter(static_cast<unsigned int>(event.code));
+            break;
+         case UI_EVENT_FOCUS:
+            io.AddFocusEvent(event.down);
+            break;
+      }
+   }
+}
+
+void UiEventQueue::CursorPosCallback(GLFWwindow* window, double x, double y) {
+   UiEventQueue& queue = GetInstance();
+   if (queue._previousCursorPosCallback) {
+      queue._previousCursorPosCallback(window, x, y);
+   }
+   queue.Push({ UI_EVENT_MOUSE_POSITION, 0, 0, false, vec2(x, y) });
+}
+
+void UiEventQueue::MouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
+   UiEventQueue& queue = GetInstance();
+   if (queue._previousMouseButtonCallback) {
+      queue._previousMouseButtonCallback(window, button, action, mods);
+   }
+   queue.Push({ UI_EVENT_MOUSE_BUTTON, button, mods, action == GLFW_PRESS, vec2(0.0f) });
+}
+
+void UiEventQueue::ScrollCallback(GLFWwindow* window, double x, double y) {
+   GetInstance().Push({ UI_EVENT_SCROLL, 0, 0, false, vec2(x, y) });
+}
+
+void UiEventQueue::KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+   UiEventQueue& queue = GetInstance();
+   if (queue._previousKeyCallback) {
+      queue._previousKeyCallback(window, key, scancode, action, mods);
+   }
+
+   // ImGui repeats held keys itself.
+   if (action == GLFW_REPEAT) {
+      return;
+   }
+
+   // Some platforms report the modifiers from before the event, the key state already includes it.
+   auto isDown = [window](int left, int right) { return glfwGetKey(window, left) == GLFW_PRESS || glfwGetKey(window, right) == GLFW_PRESS; };
+   mods = (isDown(GLFW_KEY_LEFT_CONTROL, GLFW_KEY_RIGHT_CONTROL) ? GLFW_MOD_CONTROL : 0) |
+          (isDown(GLFW_KEY_LEFT_SHIFT, GLFW_KEY_RIGHT_SHIFT) ? GLFW_MOD_SHIFT : 0) |
+          (isDown(GLFW_KEY_LEFT_ALT, GLFW_KEY_RIGHT_ALT) ? GLFW_MOD_ALT : 0) |
+          (isDown(GLFW_KEY_LEFT_SUPER, GLFW_KEY_RIGHT_SUPER) ? GLFW_MOD_SUPER : 0);
+   queue.Push({ UI_EVENT_KEY, key, mods, action == GLFW_PRESS, vec2(0.0f) });
+}
+
+void UiEventQueue::CharCallback(GLFWwindow* window, unsigned int character) {
+   GetInstance().Push({ UI_EVENT_CHARACTER, static_cast<int>(character), 0, false, vec2(0.0f) });
+}
+
+void UiEventQueue::FocusCallback(GLFWwindow* window, int focused) {
+   GetInstance().Push({ UI_EVENT_FOCUS, 0, 0, focused != 0, vec2(0.0f) });
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <Core/Core.h>
+#include <Utils/SpscRing.h>
+
+#include <atomic>
+
+struct GLFWwindow;
+struct ImGuiIO;
+
+enum EUiEventType {
+   UI_EVENT_MOUSE_POSITION,
+   UI_EVENT_MOUSE_BUTTON,
+   UI_EVENT_SCROLL,
+   UI_EVENT_KEY,
+   UI_EVENT_CHARACTER,
+   UI_EVENT_FOCUS
+};
+
+struct UiEvent {
+   EUiEventType type = UI_EVENT_MOUSE_POSITION;
+   int code = 0; // GLFW key or mouse button, or the character.
+   int mods = 0;
+   bool down = false;
+   vec2 value = vec2(0.0f); // Cursor position or scroll offset.
+};
+
+// Carries the UI input from the GLFW callbacks on the main thread to ImGui on the render thread, which
+// owns the ImGui context. The render thread publishes back whether the UI uses the mouse, so the main
+// thread knows when not to move the camera.
+class UiEventQueue {
+public:
+   static UiEventQueue& GetInstance() {
+      static UiEventQueue instance;
+      return instance;
+   }
+
+private:
+   SpscRing<UiEvent, 1024> _events;
+   std::atomic<bool> _wantCaptureMouse = false;
+   // Previous callbacks, still called so the input manager keeps receiving its events.
+   void (*_previousCursorPosCallback)(GLFWwindow*, double, double) = nullptr;
+   void (*_previousMouseButtonCallback)(GLFWwindow*, int, int, int) = nullptr;
+   void (*_previousKeyCallback)(GLFWwindow*, int, int, int, int) = nullptr;
+
+   UiEventQueue() = default;
+
+   ~UiEventQueue() = default;
+
+   UiEventQueue(const UiEventQueue&) = delete;
+
+   UiEventQueue& operator=(const UiEventQueue&) = delete;
+
+public:
+   // Main thread, installs the GLFW input callbacks.
+   void Install(GLFWwindow* window);
+
+   // Render thread, adds the queued events to ImGui before its new frame.
+   void Apply(ImGuiIO& io);
+
+   void SetWantCaptureMouse(bool capture) { _wantCaptureMouse.store(capture, std::memory_order_relaxed); }
+
+   [[nodiscard]] bool WantsCaptureMouse() const { return _wantCaptureMouse.load(std::memory_order_relaxed); }
+
+private:
+   // Events are dropped when the render thread stalls long enough to fill the ring.
+   void Push(const UiEvent& event) { _events.Push(event); }
+
+   static void CursorPosCallback(GLFWwindow* window, double x, double y);
+
+   static void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
+
+   static void ScrollCallback(GLFWwindow* window, double x, double y);
+
+   static void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+
+   static void CharCallback(GLFWwindow* window, unsigned int character);
+
+   static void FocusCallback(GLFWwindow* window, int focused);
+};
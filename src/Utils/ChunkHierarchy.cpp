@@ -0,0 +1,86 @@
+#include <GaussianSplatting.h>
+#include <Utils/ChunkHierarchy.h>
+
+void ChunkHierarchy::Build(const SceneCacheChunk* chunks, u32 chunkCount, u32 lodChunkCount) {
+   _nodes.clear();
+   if (chunkCount == 0) {
+      return;
+   }
+
+   // Level of detail chunks are only usable when there is one for every internal node.
+   u32 nextLodChunk = lodChunkCount == chunkCount - 1 ? chunkCount : InvalidChunk;
+   _nodes.reserve(chunkCount * 2);
+   BuildNode(chunks, 0, chunkCount, nextLodChunk, chunkCount + lodChunkCount);
+}
+
+u32 ChunkHierarchy::BuildNode(const SceneCacheChunk* chunks, u32 firstChunk, u32 chunkCount, u32& nextLodChunk, u32 lodChunkEnd) {
+   u32 index = static_cast<u32>(_nodes.size());
+   _nodes.push_back({});
+
+   vec3 boundsMin;
+   vec3 boundsMax;
+   u32 lodChunk = InvalidChunk;
+   float geometricError = 0.0f;
+   if (chunkCount == 1) {
+      boundsMin = vec3(chunks[firstChunk].boundsMin);
+      boundsMax = vec3(chunks[firstChunk].boundsMax);
+   } else {
+      if (nextLodChunk < lodChunkEnd) {
+         lodChunk = nextLodChunk++;
+      }
+
+      // Chunks are in Morton order, so splitting the range in half keeps children compact.
+      u32 leftCount = GetLeftChunkCount(chunkCount);
+      u32 left = BuildNode(chunks, firstChunk, leftCount, nextLodChunk, lodChunkEnd);
+      u32 right = BuildNode(chunks, firstChunk + leftCount, chunkCount - leftCount, nextLodChunk, lodChunkEnd);
+      boundsMin = min(_nodes[left].boundsMin, _nodes[right].boundsMin);
+      boundsMax = max(_nodes[left].boundsMax, _nodes[right].boundsMax);
+
+      // Merged splats may reach past the source splats.
+      if (lodChunk != InvalidChunk) {
+         boundsMin = min(boundsMin, vec3(chunks[lodChunk].boundsMin));
+         boundsMax = max(boundsMax, vec3(chunks[lodChunk].boundsMax));
+         geometricError = chunks[lodChunk].geometricError;
+      }
+   }
+
+   ChunkHierarchyNode& node = _nodes[index];
+   node.boundsMin = boundsMin;
+   node.boundsMax = boundsMax;
+   node.firstChunk = firstChunk;
+   node.chunkCount = chunkCount;
+   node.skipIndex = static_cast<u32>(_nodes.size());
+   node.lodChunk = lodChunk;
+   node.geometricError = geometricError;
+   return index;
+}
+
+void ChunkHierarchy::CollectVisibleChunks(const Frustum& frustum, const vec3& cameraPosition, float splatRadius,
+                                          float pixelScale, float maxPixelError, std::vector<u32>& visibleChunks) const {
+   const bool useLod = maxPixelError > 0.0f;
+
+   // Stackless traversal, children directly follow their parent.
+   u32 index = 0;
+   while (index < _nodes.size()) {
+      const ChunkHierarchyNode& node = _nodes[index];
+
+      // Splats shrink with distance, so the closest point of the box bounds their size.
+      float distance = std::max(length(clamp(cameraPosition, node.boundsMin, node.boundsMax) - cameraPosition), 0.1f);
+      float margin = splatRadius / distance;
+
+      Frustum::Result result = frustum.TestBox(node.boundsMin, node.boundsMax, margin);
+      if (result == Frustum::Result::Outside) {
+         index = node.skipIndex;
+      } else if (useLod && node.lodChunk != InvalidChunk && node.geometricError * pixelScale / distance <= maxPixelError) {
+         visibleChunks.push_back(node.lodChunk);
+         index = node.skipIndex;
+      } else if ((result == Frustum::Result::Inside && !useLod) || node.chunkCount == 1) {
+         for (u32 c = 0; c < node.chunkCount; ++c) {
+            visibleChunks.push_back(node.firstChunk + c);
+         }
+         index = node.skipIndex;
+      } else {
+         ++index;
+      }
+   }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <Utils/Frustum.h>
+#include <Utils/SceneCache.h>
+
+// Node of a bounding volume hierarchy over consecutive chunks, stored in depth first order.
+struct ChunkHierarchyNode {
+   vec3 boundsMin;
+   u32 firstChunk;
+   vec3 boundsMax;
+   u32 chunkCount;
+   u32 skipIndex; // Index of the next node once this subtree has been handled.
+   u32 lodChunk; // Chunk of merged splats approximating the subtree, InvalidChunk for leaves.
+   float geometricError; // Spread of the merged splats in lodChunk.
+};
+
+// BVH over the spatially ordered chunks of the scene cache, used to reject whole chunks
+// outside the view frustum before any per-splat work.
+class ChunkHierarchy {
+private:
+   std::vector<ChunkHierarchyNode> _nodes;
+
+public:
+   static constexpr u32 InvalidChunk = 0xFFFFFFFF;
+
+   // Children split the chunk range of their parent at this count, shared with SplatLod.
+   static u32 GetLeftChunkCount(u32 chunkCount) { return chunkCount / 2; }
+
+   // Level of detail chunks follow the chunkCount source chunks, one per internal node in depth first order.
+   void Build(const SceneCacheChunk* chunks, u32 chunkCount, u32 lodChunkCount);
+
+   // Appends the indices of all chunks that may be visible. Splats are grown by splatRadius at unit
+   // distance from the camera, matching the distance based splat scaling of the renderer.
+   // Subtrees whose merged splats project to at most maxPixelError pixels are replaced by their level
+   // of detail chunk, pixelScale is the focal length in pixels. A maxPixelError of 0 disables it.
+   void CollectVisibleChunks(const Frustum& frustum, const vec3& cameraPosition, float splatRadius,
+                             float pixelScale, float maxPixelError, std::vector<u32>& visibleChunks) const;
+
+   [[nodiscard]] size_t GetNodeCount() const { return _nodes.size(); }
+
+private:
+   u32 BuildNode(const SceneCacheChunk* chunks, u32 firstChunk, u32 chunkCount, u32& nextLodChunk, u32 lodChunkEnd);
+};
@@ -1,5 +1,26 @@
 #include <GaussianSplatting.h>
 #include <Utils/FileReader.h>
+#include <Utils/Parallel.h>
+#include <Utils/Tracer.h>
+
+#include <sstream>
+
+size_t GetPlyTypeSize(const std::string& type) {
+   if (type == "char" || type == "uchar" || type == "int8" || type == "uint8") return 1;
+   if (type == "short" || type == "ushort" || type == "int16" || type == "uint16") return 2;
+   if (type == "int" || type == "uint" || type == "float" || type == "int32" || type == "uint32" || type == "float32") return 4;
+   if (type == "double" || type == "float64") return 8;
+   return 0;
+}
+
+uint32_t PackUnorm8(float value) {
+   return static_cast<uint32_t>(clamp(value * 255.0f + 0.5f, 0.0f, 255.0f));
+}
+
+// Packs a [-1, 1] quaternion component the same way the .splat converter does.
+uint32_t PackQuaternion8(float value) {
+   return static_cast<uint32_t>(clamp(value * 128.0f + 128.0f, 0.0f, 255.0f));
+}
 
 uint32_t ABGRtoRGBA(uint32_t abgr) {
    uint8_t a = (abgr >> 24) & 0xFF;
@@ -10,7 +31,17 @@ uint32_t ABGRtoRGBA(uint32_t abgr) {
    return (r << 24) | (g << 16) | (b << 8) | a;
 }
 
-bool FileReader::LoadSplatData(const std::filesystem::path& path, std::vector<Splat>& splats) {
+bool FileReader::LoadSplatData(const std::filesystem::path& path, SplatScene& scene) {
+   TRACE_SCOPE("FileReader::LoadSplatData");
+   if (path.extension() == ".ply") {
+      return LoadPlyData(path, scene);
+   }
+
+   // .splat files only store the packed color.
+   std::vector<Splat>& splats = scene.splats;
+   scene.shDegree = 0;
+   scene.shCoefficients.clear();
+
    // Open the file in binary mode
    std::ifstream file(path, std::ios::binary);
    if (!file.is_open()) {
@@ -24,81 +55,241 @@ bool FileReader::LoadSplatData(const std::filesystem::path& path, std::vector<Sp
    file.seekg(0, std::ios::beg);
 
    // Calculate the number of splats
-   size_t numSplats = fileSize / 32;
+   size_t numSplats = fileSize / SplatRecordSize;
    splats.resize(numSplats);
 
    // Read the splats from the file
+   uint8_t record[SplatRecordSize];
    for (size_t i = 0; i < numSplats; ++i) {
-      // Position (3 * float32)
-      file.read(reinterpret_cast<char*>(&splats[i].position.x), sizeof(splats[i].position.x));
-      file.read(reinterpret_cast<char*>(&splats[i].position.y), sizeof(splats[i].position.y));
-      file.read(reinterpret_cast<char*>(&splats[i].position.z), sizeof(splats[i].position.z));
-      splats[i].position.w = 1.0f;
+      file.read(reinterpret_cast<char*>(record), SplatRecordSize);
+      DecodeSplatRecord(record, splats[i]);
+   }
+    
+   file.close();
+   return true;
+}
+
+void FileReader::DecodeSplatRecord(const uint8_t* record, Splat& splat) {
+   // Position (3 * float32)
+   memcpy(&splat.position.x, record, 3 * sizeof(float));
+   splat.position.w = 1.0f;
 
-      // Scale (3 * float32)
-      file.read(reinterpret_cast<char*>(&splats[i].scale.x), sizeof(splats[i].scale.x));
-      file.read(reinterpret_cast<char*>(&splats[i].scale.y), sizeof(splats[i].scale.y));
-      file.read(reinterpret_cast<char*>(&splats[i].scale.z), sizeof(splats[i].scale.z));
-      splats[i].position.w = 1.0f;
+   // Scale (3 * float32)
+   memcpy(&splat.scale.x, record + 12, 3 * sizeof(float));
+   splat.scale.w = 0.0f;
 
-      // Color (4 * uint8 -> uint32)
-      file.read(reinterpret_cast<char*>(&splats[i].color), sizeof(splats[i].color));
+   // Color (4 * uint8 -> uint32), ABGR -> RGBA
+   memcpy(&splat.color, record + 24, sizeof(splat.color));
+   splat.color = ABGRtoRGBA(splat.color);
 
-      // ABGR -> RGBA
-      splats[i].color = ABGRtoRGBA(splats[i].color);
+   // Rotation (4 * uint8 -> uint32)
+   memcpy(&splat.rotation, record + 28, sizeof(splat.rotation));
+}
 
-      // Rotation (4 * uint8 -> uint32)
-      file.read(reinterpret_cast<char*>(&splats[i].rotation), sizeof(splats[i].rotation));
+void FileReader::EncodeSplatRecord(const Splat& splat, uint8_t* record) {
+   memcpy(record, &splat.position.x, 3 * sizeof(float));
+   memcpy(record + 12, &splat.scale.x, 3 * sizeof(float));
+   // Swapping the bytes back turns RGBA into ABGR.
+   uint32_t color = ABGRtoRGBA(splat.color);
+   memcpy(record + 24, &color, sizeof(color));
+   memcpy(record + 28, &splat.rotation, sizeof(splat.rotation));
+}
+
+bool FileReader::ReadPlyHeader(std::istream& file, const std::filesystem::path& path, PlyHeader& header) {
+   std::string line;
+   std::getline(file, line);
+   if (line.rfind("ply", 0) != 0) {
+      std::cerr << "Not a PLY file: " << path << std::endl;
+      return false;
    }
-    
-   file.close();
+
+   header = PlyHeader();
+   bool littleEndian = false;
+   bool inVertexElement = false;
+   while (std::getline(file, line)) {
+      if (!line.empty() && line.back() == '\r') {
+         line.pop_back();
+      }
+
+      std::istringstream tokens(line);
+      std::string keyword;
+      tokens >> keyword;
+      if (keyword == "format") {
+         std::string format;
+         tokens >> format;
+         littleEndian = format == "binary_little_endian";
+      } else if (keyword == "element") {
+         std::string name;
+         size_t count = 0;
+         tokens >> name >> count;
+         inVertexElement = name == "vertex";
+         if (inVertexElement) {
+            header.vertexCount = count;
+         } else if (header.vertexCount == 0 && count > 0) {
+            std::cerr << "PLY elements before the vertex element are not supported: " << name << std::endl;
+            return false;
+         }
+      } else if (keyword == "property" && inVertexElement) {
+         std::string type, name;
+         tokens >> type >> name;
+         size_t typeSize = GetPlyTypeSize(type);
+         if (typeSize == 0) {
+            std::cerr << "Unsupported PLY vertex property: " << line << std::endl;
+            return false;
+         }
+         header.properties.push_back({ name, header.vertexStride, type == "float" || type == "float32" });
+         header.vertexStride += typeSize;
+      } else if (keyword == "end_header") {
+         break;
+      }
+   }
+
+   if (!littleEndian) {
+      std::cerr << "Only binary little endian PLY files are supported: " << path << std::endl;
+      return false;
+   }
+   header.dataOffset = static_cast<size_t>(file.tellg());
    return true;
 }
 
-wgpu::ShaderModule FileReader::LoadShaderModule(const std::filesystem::path& path, wgpu::Device device) {
-   // Open the file in binary mode and position at the end to get its size
-   std::ifstream file(path, std::ios::ate | std::ios::binary);
+int64_t PlyHeader::FindFloatOffset(const std::string& name) const {
+   for (const auto& property : properties) {
+      if (property.name == name) {
+         return property.isFloat ? static_cast<int64_t>(property.offset) : -1;
+      }
+   }
+   return -1;
+}
+
+size_t PlyHeader::GetSHRestCount() const {
+   size_t restCount = 0;
+   while (FindFloatOffset("f_rest_" + std::to_string(restCount)) >= 0) {
+      ++restCount;
+   }
+   return restCount;
+}
+
+u32 PlyHeader::GetSHDegree() const {
+   size_t restCount = GetSHRestCount();
+   return restCount >= 45 ? 3 : restCount >= 24 ? 2 : restCount >= 9 ? 1 : 0;
+}
+
+bool FileReader::LoadPlyData(const std::filesystem::path& path, SplatScene& scene) {
+   TRACE_SCOPE("FileReader::LoadPlyData");
+   // Open the file in binary mode
+   std::ifstream file(path, std::ios::binary);
    if (!file.is_open()) {
-      std::cerr << "Failed to open shader file: " << path << std::endl;
-      return nullptr;
+      std::cerr << "Failed to open geometry file: " << path << std::endl;
+      return false;
    }
 
-   // Get the file size
-   size_t fileSize = file.tellg();
-   // Create a buffer with an extra byte for a null terminator
-   std::vector<char> buffer(fileSize + 1);
+   PlyHeader header;
+   PlyVertexDecoder decoder;
+   if (!ReadPlyHeader(file, path, header) || !decoder.Init(header, path)) {
+      return false;
+   }
+   const size_t vertexCount = header.vertexCount;
+   const size_t vertexStride = header.vertexStride;
+   const u32 shWords = decoder.shWords;
 
-   // Go back to the beginning and read the entire file
-   file.seekg(0);
-   file.read(buffer.data(), fileSize);
+   // Read the whole vertex block at once.
+   std::vector<char> data(vertexCount * vertexStride);
+   file.read(data.data(), static_cast<std::streamsize>(data.size()));
+   if (static_cast<size_t>(file.gcount()) != data.size()) {
+      std::cerr << "PLY file is truncated: " << path << std::endl;
+      return false;
+   }
    file.close();
 
-   // Null-terminate the shader source code
-   buffer[fileSize] = '\0';
-
-   const char* shaderSource = buffer.data();
-
-   // Load shader module.
-   WGPUShaderModuleDescriptor shaderDesc = {};
-#ifdef WEBGPU_BACKEND_WGPU
-   shaderDesc.hintCount = 0;
-   shaderDesc.hints = nullptr;
-#endif
-   WGPUShaderModuleWGSLDescriptor shaderCodeDesc{};
-   shaderCodeDesc.chain.next = nullptr; // Set the chained struct's header
-   shaderCodeDesc.chain.sType = WGPUSType_ShaderModuleWGSLDescriptor;
-   shaderDesc.nextInChain = &shaderCodeDesc.chain; // Connect the chain
-   shaderCodeDesc.code = shaderSource;
-   WGPUShaderModule shaderModule = wgpuDeviceCreateShaderModule(device, &shaderDesc);
-
-   return shaderModule;
+   // Decode vertices in parallel chunks straight into the GPU layout.
+   std::vector<Splat>& splats = scene.splats;
+   splats.resize(vertexCount);
+   scene.shDegree = decoder.shDegree;
+   scene.shCoefficients.assign(vertexCount * shWords, 0u);
+   Parallel::ForChunks(vertexCount, 16384, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+         decoder.Decode(data.data() + i * vertexStride, splats[i], scene.shCoefficients.data() + i * shWords);
+      }
+   });
+
+   return true;
 }
 
-void FileReader::GetFilesInDirectory(const std::filesystem::path& path, std::vector<char*>& files)
-{
-   for (const auto& entry : std::filesystem::directory_iterator(path))
-   {
-      std::string filename = entry.path().filename().string();
-      files.push_back(strdup(filename.c_str()));
+bool PlyVertexDecoder::Init(const PlyHeader& header, const std::filesystem::path& path) {
+   // Map the properties we need to their offsets within a vertex.
+   const char* names[PropertyCount] = { "x", "y", "z", "scale_0", "scale_1", "scale_2", "opacity", "rot_0", "rot_1", "rot_2", "rot_3", "f_dc_0", "f_dc_1", "f_dc_2" };
+   for (size_t i = 0; i < PropertyCount; ++i) {
+      int64_t offset = header.FindFloatOffset(names[i]);
+      if (offset < 0) {
+         std::cerr << "PLY file is missing float property '" << names[i] << "': " << path << std::endl;
+         return false;
+      }
+      offsets[i] = static_cast<size_t>(offset);
    }
-}
\ No newline at end of file
+
+   // Higher order SH coefficients are stored channel by channel in f_rest_*.
+   shDegree = header.GetSHDegree();
+   shWords = GetSHWordsPerSplat(shDegree);
+   size_t restPerChannel = header.GetSHRestCount() / 3;
+   size_t shCount = (shDegree + 1) * (shDegree + 1) - 1;
+   shOffsets.resize(shCount * 3);
+   for (size_t k = 0; k < shCount; ++k) {
+      for (size_t c = 0; c < 3; ++c) {
+         shOffsets[k * 3 + c] = static_cast<size_t>(header.FindFloatOffset("f_rest_" + std::to_string(c * restPerChannel + k)));
+      }
+   }
+   return true;
+}
+
+void PlyVertexDecoder::Decode(const char* vertex, Splat& splat, u32* shCoefficients) const {
+   float values[PropertyCount];
+   for (size_t p = 0; p < PropertyCount; ++p) {
+      memcpy(&values[p], vertex + offsets[p], sizeof(float));
+   }
+
+   splat.position = vec4(values[0], values[1], values[2], 1.0f);
+
+   // Scales are stored in log space.
+   splat.scale = vec4(std::exp(values[3]), std::exp(values[4]), std::exp(values[5]), 0.0f);
+
+   // Opacity is stored before the sigmoid activation.
+   float opacity = 1.0f / (1.0f + std::exp(-values[6]));
+
+   // Color from the zeroth order SH coefficients, packed as RGBA.
+   splat.color = (PackUnorm8(0.5f + SH_C0 * values[11]) << 24) |
+                 (PackUnorm8(0.5f + SH_C0 * values[12]) << 16) |
+                 (PackUnorm8(0.5f + SH_C0 * values[13]) << 8) |
+                 PackUnorm8(opacity);
+
+   // Rotation is an unnormalized (w, x, y, z) quaternion, packed the same way as in .splat files.
+   vec4 rotation(values[7], values[8], values[9], values[10]);
+   float length = glm::length(rotation);
+   rotation = length > 0.0f ? rotation / length : vec4(1.0f, 0.0f, 0.0f, 0.0f);
+   splat.rotation = PackQuaternion8(rotation.x) |
+                    (PackQuaternion8(rotation.y) << 8) |
+                    (PackQuaternion8(rotation.z) << 16) |
+                    (PackQuaternion8(rotation.w) << 24);
+
+   // Interleave the SH coefficients as RGB triplets and pack them to half floats.
+   if (shWords > 0) {
+      float shValues[2 * GetSHWordsPerSplat(3)] = {};
+      for (size_t h = 0; h < shOffsets.size(); ++h) {
+         memcpy(&shValues[h], vertex + shOffsets[h], sizeof(float));
+      }
+      for (u32 w = 0; w < shWords; ++w) {
+         shCoefficients[w] = packHalf2x16(vec2(shValues[w * 2], shValues[w * 2 + 1]));
+      }
+   }
+}
+
+bool FileReader::LoadTextFile(const std::filesystem::path& path, std::string& text) {
+   std::ifstream file(path, std::ios::binary);
+   if (!file.is_open()) {
+      return false;
+   }
+
+   std::ostringstream stream;
+   stream << file.rdbuf();
+   text = stream.str();
+   return true;
+}
@@ -1,19 +1,89 @@
 #pragma once
 
-#include <webgpu/webgpu.hpp>
+#include <Core/Core.h>
 
 struct Splat {
    alignas(16) f32vec4 position;
    alignas(16) f32vec4 scale;
    alignas(4) u32 color;
    alignas(4) u32 rotation;
+   // Tail padding of the WGSL struct, explicit so copies keep it zero and written scene files are reproducible.
+   u32 padding[2] = {};
+};
+static_assert(sizeof(Splat) == 48, "Splat must match the WGSL struct layout");
+
+// Number of u32 words holding the higher order SH coefficients of one splat.
+// Coefficients are stored as RGB triplets of half floats, two halves per word.
+constexpr u32 GetSHWordsPerSplat(u32 shDegree) {
+   return (3 * ((shDegree + 1) * (shDegree + 1) - 1) + 1) / 2;
+}
+
+// Zeroth order spherical harmonics basis constant.
+constexpr float SH_C0 = 0.28209479177387814f;
+
+struct SplatScene {
+   std::vector<Splat> splats;
+   // Degree of the view dependent color, 0 when only the packed splat color is available.
+   u32 shDegree = 0;
+   // GetSHWordsPerSplat(shDegree) words per splat.
+   std::vector<u32> shCoefficients;
+};
+
+struct PlyProperty {
+   std::string name;
+   size_t offset;
+   bool isFloat;
+};
+
+// Vertex layout of a binary little endian PLY file.
+struct PlyHeader {
+   size_t vertexCount = 0;
+   size_t vertexStride = 0;
+   size_t dataOffset = 0; // Bytes before the first vertex.
+   std::vector<PlyProperty> properties;
+
+   // Offset of a float vertex property within a vertex, -1 when it is missing or not a float.
+   [[nodiscard]] int64_t FindFloatOffset(const std::string& name) const;
+
+   // Number of consecutive f_rest_* properties, the higher order SH coefficients.
+   [[nodiscard]] size_t GetSHRestCount() const;
+
+   [[nodiscard]] u32 GetSHDegree() const;
+};
+
+// Offsets of the vertex properties the renderer uses, decodes single vertices into the GPU layout.
+struct PlyVertexDecoder {
+   static constexpr size_t PropertyCount = 14;
+
+   size_t offsets[PropertyCount] = {};
+   std::vector<size_t> shOffsets; // f_rest_* offsets in the interleaved RGB order of the GPU layout.
+   u32 shDegree = 0;
+   u32 shWords = 0;
+
+   // Fails when a required property is missing.
+   bool Init(const PlyHeader& header, const std::filesystem::path& path);
+
+   // Writes shWords words to shCoefficients.
+   void Decode(const char* vertex, Splat& splat, u32* shCoefficients) const;
 };
 
 class FileReader {
 public:
-   static bool LoadSplatData(const std::filesystem::path& path, std::vector<Splat>& splats);
+   // Bytes of one record of a .splat file.
+   static constexpr size_t SplatRecordSize = 32;
+
+   static void DecodeSplatRecord(const uint8_t* record, Splat& splat);
+
+   // Inverse of DecodeSplatRecord, writes SplatRecordSize bytes.
+   static void EncodeSplatRecord(const Splat& splat, uint8_t* record);
+
+   static bool LoadSplatData(const std::filesystem::path& path, SplatScene& scene);
+
+   // Loads binary little endian PLY files as written by the reference 3DGS training code.
+   static bool LoadPlyData(const std::filesystem::path& path, SplatScene& scene);
 
-   static wgpu::ShaderModule LoadShaderModule(const std::filesystem::path& path, wgpu::Device device);
+   // Parses the header up to end_header, the stream is left at the first vertex.
+   static bool ReadPlyHeader(std::istream& file, const std::filesystem::path& path, PlyHeader& header);
 
-   static void GetFilesInDirectory(const std::filesystem::path& path, std::vector<char*>& files);
+   static bool LoadTextFile(const std::filesystem::path& path, std::string& text);
 };
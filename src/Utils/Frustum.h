@@ -0,0 +1,40 @@
+#pragma once
+
+#include <Core/Core.h>
+
+// View frustum planes extracted from a clip matrix, normals point inwards.
+struct Frustum {
+   vec4 planes[6];
+
+   explicit Frustum(const mat4x4& clip) {
+      mat4x4 m = transpose(clip);
+      planes[0] = m[3] + m[0]; // Left
+      planes[1] = m[3] - m[0]; // Right
+      planes[2] = m[3] + m[1]; // Bottom
+      planes[3] = m[3] - m[1]; // Top
+      planes[4] = m[3] + m[2]; // Near
+      planes[5] = m[3] - m[2]; // Far
+      for (auto& plane : planes) {
+         plane /= length(vec3(plane));
+      }
+   }
+
+   enum class Result { Outside, Intersecting, Inside };
+
+   // Tests a box grown by margin on every side.
+   [[nodiscard]] Result TestBox(const vec3& boundsMin, const vec3& boundsMax, float margin = 0.0f) const {
+      Result result = Result::Inside;
+      for (const auto& plane : planes) {
+         vec3 normal = vec3(plane);
+         vec3 positive = mix(boundsMin, boundsMax, greaterThanEqual(normal, vec3(0.0f)));
+         vec3 negative = mix(boundsMax, boundsMin, greaterThanEqual(normal, vec3(0.0f)));
+         if (dot(normal, positive) + plane.w < -margin) {
+            return Result::Outside;
+         }
+         if (dot(normal, negative) + plane.w < margin) {
+            result = Result::Intersecting;
+         }
+      }
+      return result;
+   }
+};
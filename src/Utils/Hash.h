@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace Hash {
+
+   constexpr uint64_t Fnv1aSeed = 14695981039346656037ull;
+
+   // 64-bit FNV-1a, pass the previous result as the seed to hash several values.
+   inline uint64_t Fnv1a(const void* data, size_t size, uint64_t seed = Fnv1aSeed) {
+      const auto* bytes = static_cast<const uint8_t*>(data);
+      uint64_t hash = seed;
+      for (size_t i = 0; i < size; ++i) {
+         hash ^= bytes[i];
+         hash *= 1099511628211ull;
+      }
+      return hash;
+   }
+
+   template<typename T>
+   uint64_t Fnv1aValue(const T& value, uint64_t seed = Fnv1aSeed) {
+      return Fnv1a(&value, sizeof(T), seed);
+   }
+
+}
@@ -0,0 +1,97 @@
+#include <GaussianSplatting.h>
+#include <Utils/MappedFile.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+   Close();
+}
+
+bool MappedFile::Open(const std::filesystem::path& path) {
+   Close();
+
+#ifdef _WIN32
+   HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+   if (file == INVALID_HANDLE_VALUE) {
+      return false;
+   }
+
+   LARGE_INTEGER fileSize;
+   if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+      CloseHandle(file);
+      return false;
+   }
+
+   HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+   if (!mapping) {
+      CloseHandle(file);
+      return false;
+   }
+
+   void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+   if (!data) {
+      CloseHandle(mapping);
+      CloseHandle(file);
+      return false;
+   }
+
+   _fileHandle = file;
+   _mappingHandle = mapping;
+   _data = static_cast<const uint8_t*>(data);
+   _size = static_cast<size_t>(fileSize.QuadPart);
+#else
+   int fileDescriptor = open(path.c_str(), O_RDONLY);
+   if (fileDescriptor < 0) {
+      return false;
+   }
+
+   struct stat fileStat = {};
+   if (fstat(fileDescriptor, &fileStat) != 0 || fileStat.st_size == 0) {
+      close(fileDescriptor);
+      return false;
+   }
+
+   void* data = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+   if (data == MAP_FAILED) {
+      close(fileDescriptor);
+      return false;
+   }
+   madvise(data, static_cast<size_t>(fileStat.st_size), MADV_SEQUENTIAL);
+
+   _fileDescriptor = fileDescriptor;
+   _data = static_cast<const uint8_t*>(data);
+   _size = static_cast<size_t>(fileStat.st_size);
+#endif
+
+   return true;
+}
+
+void MappedFile::Close() {
+   if (!_data) {
+      return;
+   }
+
+#ifdef _WIN32
+   UnmapViewOfFile(_data);
+   CloseHandle(static_cast<HANDLE>(_mappingHandle));
+   CloseHandle(static_cast<HANDLE>(_fileHandle));
+   _mappingHandle = nullptr;
+   _fileHandle = nullptr;
+#else
+   munmap(const_cast<uint8_t*>(_data), _size);
+   close(_fileDescriptor);
+   _fileDescriptor = -1;
+#endif
+
+   _data = nullptr;
+   _size = 0;
+}
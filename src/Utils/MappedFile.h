@@ -0,0 +1,34 @@
+#pragma once
+
+// Read-only memory mapping of a whole file.
+class MappedFile {
+private:
+   const uint8_t* _data = nullptr;
+   size_t _size = 0;
+
+#ifdef _WIN32
+   void* _fileHandle = nullptr;
+   void* _mappingHandle = nullptr;
+#else
+   int _fileDescriptor = -1;
+#endif
+
+public:
+   MappedFile() = default;
+
+   ~MappedFile();
+
+   MappedFile(const MappedFile&) = delete;
+
+   MappedFile& operator=(const MappedFile&) = delete;
+
+   bool Open(const std::filesystem::path& path);
+
+   void Close();
+
+   [[nodiscard]] bool IsOpen() const { return _data != nullptr; }
+
+   [[nodiscard]] const uint8_t* GetData() const { return _data; }
+
+   [[nodiscard]] size_t GetSize() const { return _size; }
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <Utils/Tracer.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace Parallel {
+
+   inline size_t GetThreadCount() {
+      return std::max<size_t>(1, std::thread::hardware_concurrency());
+   }
+
+   // Splits [0, count) into contiguous chunks and runs func(begin, end) for each chunk on its own thread.
+   template<typename Func>
+   void ForChunks(size_t count, size_t minChunkSize, Func&& func) {
+      if (count == 0) {
+         return;
+      }
+
+      size_t threadCount = std::min(GetThreadCount(), (count + minChunkSize - 1) / minChunkSize);
+      if (threadCount <= 1) {
+         func(size_t(0), count);
+         return;
+      }
+
+      size_t chunkSize = (count + threadCount - 1) / threadCount;
+      std::vector<std::thread> threads;
+      threads.reserve(threadCount - 1);
+      for (size_t t = 1; t < threadCount; ++t) {
+         size_t begin = t * chunkSize;
+         size_t end = std::min(count, begin + chunkSize);
+         if (begin >= end) {
+            break;
+         }
+         threads.emplace_back([&func, begin, end]() {
+            TRACE_SCOPE("Parallel::ForChunks");
+            func(begin, end);
+         });
+      }
+
+      // The calling thread handles the first chunk.
+      func(size_t(0), std::min(count, chunkSize));
+
+      for (auto& thread : threads) {
+         thread.join();
+      }
+   }
+
+   // Sorts chunks on separate threads and merges them pairwise, also in parallel.
+   template<typename Iterator, typename Compare>
+   void Sort(Iterator begin, Iterator end, Compare compare) {
+      size_t count = static_cast<size_t>(end - begin);
+      size_t chunkCount = std::min(GetThreadCount(), std::max<size_t>(1, count / 65536));
+      if (chunkCount <= 1) {
+         std::sort(begin, end, compare);
+         return;
+      }
+
+      std::vector<size_t> bounds(chunkCount + 1);
+      for (size_t c = 0; c <= chunkCount; ++c) {
+         bounds[c] = count * c / chunkCount;
+      }
+
+      ForChunks(chunkCount, 1, [&](size_t first, size_t last) {
+         for (size_t c = first; c < last; ++c) {
+            std::sort(begin + bounds[c], begin + bounds[c + 1], compare);
+         }
+      });
+
+      // Merge neighbouring sorted runs until a single run is left.
+      while (bounds.size() > 2) {
+         size_t mergeCount = (bounds.size() - 1) / 2;
+         ForChunks(mergeCount, 1, [&](size_t first, size_t last) {
+            for (size_t m = first; m < last; ++m) {
+               std::inplace_merge(begin + bounds[m * 2], begin + bounds[m * 2 + 1], begin + bounds[m * 2 + 2], compare);
+            }
+         });
+
+         std::vector<size_t> merged;
+         for (size_t b = 0; b < bounds.size(); b += 2) {
+            merged.push_back(bounds[b]);
+         }
+         if (merged.back() != bounds.back()) {
+            merged.push_back(bounds.back());
+         }
+         bounds = std::move(merged);
+      }
+   }
+
+}
@@ -0,0 +1,240 @@
+#include <GaussianSplatting.h>
+#include <Utils/SceneCache.h>
+
+#include <Utils/Hash.h>
+#include <Utils/Parallel.h>
+#include <Utils/SplatLod.h>
+#include <Utils/Tracer.h>
+
+#include <iomanip>
+#include <sstream>
+
+// Sections are aligned so the mapped splat records can be handed to the GPU as is.
+constexpr u64 SectionAlignment = 256;
+
+u64 AlignOffset(u64 offset) {
+   return (offset + SectionAlignment - 1) / SectionAlignment * SectionAlignment;
+}
+
+u64 SceneCache::ComputeSourceHash(const std::filesystem::path& source, u64 optionsHash) {
+   std::error_code error;
+   std::string absolutePath = std::filesystem::absolute(source, error).generic_string();
+   u64 fileSize = std::filesystem::file_size(source, error);
+   if (error) {
+      return InvalidHash;
+   }
+   auto writeTime = std::filesystem::last_write_time(source, error).time_since_epoch().count();
+
+   u64 hash = Hash::Fnv1a(absolutePath.data(), absolutePath.size());
+   hash = Hash::Fnv1aValue(fileSize, hash);
+   hash = Hash::Fnv1aValue(writeTime, hash);
+   hash = Hash::Fnv1aValue(optionsHash, hash);
+   hash = Hash::Fnv1aValue(Version, hash);
+   // The reserved values are never valid keys.
+   return hash == InvalidHash || hash == StandaloneHash ? 1 : hash;
+}
+
+std::filesystem::path SceneCache::GetCachePath(const std::filesystem::path& source, u64 sourceHash) {
+   std::ostringstream name;
+   name << std::hex << std::setw(16) << std::setfill('0') << sourceHash << Extension;
+   return source.parent_path().parent_path() / "cache" / name.str();
+}
+
+bool SceneCache::Open(const std::filesystem::path& path, u64 sourceHash) {
+   TRACE_SCOPE("SceneCache::Open");
+   Release();
+
+   if (!_mappedFile.Open(path)) {
+      return false;
+   }
+
+   _data = _mappedFile.GetData();
+   _size = _mappedFile.GetSize();
+   if (!Validate(sourceHash)) {
+      std::cerr << "Ignoring invalid scene cache: " << path << std::endl;
+      Release();
+      return false;
+   }
+
+   return true;
+}
+
+void SceneCache::Build(const SplatScene& scene, u64 sourceHash) {
+   TRACE_SCOPE("SceneCache::Build");
+   Release();
+
+   const u64 splatCount = scene.splats.size();
+   SceneCacheHeader header = CreateHeader(splatCount, scene.shDegree, sourceHash);
+   const u32 chunkCount = header.chunkCount;
+   const u32 lodChunkCount = header.lodChunkCount;
+   const u32 shWords = header.shWordsPerSplat;
+
+   // Padding records stay zero, which makes them fully transparent.
+   _storage.assign(header.fileSize, 0);
+   _data = _storage.data();
+   _size = _storage.size();
+
+   auto* chunks = reinterpret_cast<SceneCacheChunk*>(_storage.data() + header.chunksOffset);
+   auto* splats = reinterpret_cast<Splat*>(_storage.data() + header.splatsOffset);
+   auto* shCoefficients = reinterpret_cast<u32*>(_storage.data() + header.shCoefficientsOffset);
+   memcpy(splats, scene.splats.data(), splatCount * sizeof(Splat));
+   if (shWords > 0) {
+      memcpy(shCoefficients, scene.shCoefficients.data(), splatCount * shWords * sizeof(u32));
+   }
+
+   size_t lodRecord = static_cast<size_t>(chunkCount) * ChunkSize;
+   SplatLod::Build(splats, shCoefficients, shWords, chunkCount, splats + lodRecord, shCoefficients + lodRecord * shWords);
+
+   // Per-chunk metadata.
+   std::vector<dvec3> chunkSums(chunkCount, dvec3(0.0));
+   Parallel::ForChunks(chunkCount + lodChunkCount, 64, [&](size_t begin, size_t end) {
+      for (size_t c = begin; c < end; ++c) {
+         const bool isLod = c >= chunkCount;
+         size_t first = c * ChunkSize;
+         size_t last = isLod ? first + ChunkSize : std::min<size_t>(splatCount, first + ChunkSize);
+         chunks[c] = ComputeChunk(splats + first, last - first, isLod);
+         if (!isLod) {
+            for (size_t i = first; i < last; ++i) {
+               chunkSums[c] += dvec3(splats[i].position);
+            }
+         }
+      }
+   });
+
+   // Scene bounds and centroid of the source splats.
+   dvec3 sum(0.0);
+   header.boundsMin = vec4(std::numeric_limits<float>::max());
+   header.boundsMax = vec4(-std::numeric_limits<float>::max());
+   for (u32 c = 0; c < chunkCount; ++c) {
+      header.boundsMin = min(header.boundsMin, chunks[c].boundsMin);
+      header.boundsMax = max(header.boundsMax, chunks[c].boundsMax);
+      sum += chunkSums[c];
+   }
+   header.centroid = splatCount > 0 ? vec4(vec3(sum / static_cast<double>(splatCount)), 1.0f) : vec4(0.0f, 0.0f, 0.0f, 1.0f);
+
+   memcpy(_storage.data(), &header, sizeof(header));
+}
+
+SceneCacheHeader SceneCache::CreateHeader(u64 splatCount, u32 shDegree, u64 sourceHash) {
+   const u32 chunkCount = static_cast<u32>((splatCount + ChunkSize - 1) / ChunkSize);
+   const u32 lodChunkCount = SplatLod::GetChunkCount(chunkCount);
+   const u32 shWords = shDegree > 0 ? GetSHWordsPerSplat(shDegree) : 0;
+   // Level of detail chunks start at a chunk boundary, so the last source chunk is padded.
+   const u64 recordCount = lodChunkCount > 0 ? static_cast<u64>(chunkCount + lodChunkCount) * ChunkSize : splatCount;
+
+   SceneCacheHeader header = {};
+   memcpy(header.magic, "GSSC", sizeof(header.magic));
+   header.version = Version;
+   header.sourceHash = sourceHash;
+   header.splatCount = splatCount;
+   header.splatRecordCount = recordCount;
+   header.chunkSize = ChunkSize;
+   header.chunkCount = chunkCount;
+   header.lodChunkCount = lodChunkCount;
+   header.shDegree = shWords > 0 ? shDegree : 0;
+   header.shWordsPerSplat = shWords;
+   header.chunksOffset = AlignOffset(sizeof(SceneCacheHeader));
+   header.splatsOffset = AlignOffset(header.chunksOffset + (chunkCount + lodChunkCount) * sizeof(SceneCacheChunk));
+   header.shCoefficientsOffset = AlignOffset(header.splatsOffset + recordCount * sizeof(Splat));
+   header.fileSize = AlignOffset(header.shCoefficientsOffset + recordCount * shWords * sizeof(u32));
+   return header;
+}
+
+SceneCacheChunk SceneCache::ComputeChunk(const Splat* splats, size_t count, bool isLod) {
+   SceneCacheChunk chunk;
+   chunk.boundsMin = vec4(std::numeric_limits<float>::max());
+   chunk.boundsMax = vec4(-std::numeric_limits<float>::max());
+   chunk.opacityRange = vec2(1.0f, 0.0f);
+   chunk.scaleRange = vec2(std::numeric_limits<float>::max(), 0.0f);
+   chunk.geometricError = 0.0f;
+
+   for (size_t i = 0; i < count; ++i) {
+      const Splat& splat = splats[i];
+      float opacity = static_cast<float>(splat.color & 0xFF) / 255.0f;
+      if (isLod && opacity == 0.0f) {
+         continue;
+      }
+
+      // Merged splats cover the spread of the splats they replace.
+      vec4 extent = vec4(vec3(splat.scale.w), 0.0f);
+      float minScale = std::min(splat.scale.x, std::min(splat.scale.y, splat.scale.z));
+      float maxScale = std::max(splat.scale.x, std::max(splat.scale.y, splat.scale.z));
+      chunk.boundsMin = min(chunk.boundsMin, splat.position - extent);
+      chunk.boundsMax = max(chunk.boundsMax, splat.position + extent);
+      chunk.opacityRange = vec2(std::min(chunk.opacityRange.x, opacity), std::max(chunk.opacityRange.y, opacity));
+      chunk.scaleRange = vec2(std::min(chunk.scaleRange.x, minScale), std::max(chunk.scaleRange.y, maxScale));
+      chunk.geometricError = std::max(chunk.geometricError, splat.scale.w);
+   }
+   return chunk;
+}
+
+bool SceneCache::Save(const std::filesystem::path& path) const {
+   if (!_data) {
+      return false;
+   }
+
+   std::error_code error;
+   std::filesystem::create_directories(path.parent_path(), error);
+
+   // Write to a temporary file first so an interrupted write never leaves a valid looking cache behind.
+   std::filesystem::path tempPath = path;
+   tempPath += ".tmp";
+   {
+      std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+      if (!file.is_open()) {
+         std::cerr << "Failed to create scene cache file: " << tempPath << std::endl;
+         return false;
+      }
+      file.write(reinterpret_cast<const char*>(_data), static_cast<std::streamsize>(_size));
+      if (!file.good()) {
+         std::cerr << "Failed to write scene cache file: " << tempPath << std::endl;
+         file.close();
+         std::filesystem::remove(tempPath, error);
+         return false;
+      }
+   }
+
+   std::filesystem::rename(tempPath, path, error);
+   if (error) {
+      std::cerr << "Failed to move scene cache file into place: " << path << std::endl;
+      std::filesystem::remove(tempPath, error);
+      return false;
+   }
+
+   return true;
+}
+
+void SceneCache::Release() {
+   _mappedFile.Close();
+   _storage.clear();
+   _storage.shrink_to_fit();
+   _data = nullptr;
+   _size = 0;
+}
+
+bool SceneCache::Validate(u64 sourceHash) const {
+   if (_size < sizeof(SceneCacheHeader)) {
+      return false;
+   }
+
+   const SceneCacheHeader& header = GetHeader();
+   if (memcmp(header.magic, "GSSC", sizeof(header.magic)) != 0 || header.version != Version) {
+      return false;
+   }
+   if (header.sourceHash != sourceHash || header.fileSize != _size || header.chunkSize != ChunkSize) {
+      return false;
+   }
+   if (header.chunkCount != (header.splatCount + ChunkSize - 1) / ChunkSize ||
+       header.lodChunkCount != SplatLod::GetChunkCount(header.chunkCount) ||
+       header.shWordsPerSplat != (header.shDegree > 0 ? GetSHWordsPerSplat(header.shDegree) : 0)) {
+      return false;
+   }
+   u64 recordCount = header.lodChunkCount > 0 ? static_cast<u64>(header.chunkCount + header.lodChunkCount) * ChunkSize : header.splatCount;
+   if (header.splatRecordCount != recordCount) {
+      return false;
+   }
+
+   return header.chunksOffset + (header.chunkCount + header.lodChunkCount) * sizeof(SceneCacheChunk) <= header.splatsOffset &&
+          header.splatsOffset + header.splatRecordCount * sizeof(Splat) <= header.shCoefficientsOffset &&
+          header.shCoefficientsOffset + header.splatRecordCount * header.shWordsPerSplat * sizeof(u32) <= _size;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <Utils/FileReader.h>
+#include <Utils/MappedFile.h>
+
+// Header at the start of a scene cache file. All offsets are in bytes from the start of the file.
+struct SceneCacheHeader {
+   char magic[4];
+   u32 version;
+   u64 sourceHash;
+   u64 splatCount;
+   u64 splatRecordCount; // Source splats, padding of the last source chunk and level of detail splats.
+   u32 chunkSize;
+   u32 chunkCount; // Chunks of source splats.
+   u32 lodChunkCount; // Chunks of merged splats, stored after the source chunks.
+   u32 shDegree;
+   u32 shWordsPerSplat;
+   u64 chunksOffset;
+   u64 splatsOffset;
+   u64 shCoefficientsOffset;
+   u64 fileSize;
+   vec4 boundsMin;
+   vec4 boundsMax;
+   vec4 centroid;
+};
+
+// Metadata of a fixed-size chunk of consecutive splats.
+struct SceneCacheChunk {
+   vec4 boundsMin;
+   vec4 boundsMax;
+   vec2 opacityRange;
+   vec2 scaleRange;
+   float geometricError; // Largest spread of the merged splats, 0 for chunks of source splats.
+};
+
+// Versioned binary scene cache. Splat records are stored in the GPU layout so the
+// mapped file can be uploaded without any decoding. Scenes with more than one chunk also
+// store the level of detail chunks built by SplatLod. The same format is the native scene
+// format written by the converter tool, such files are loaded directly.
+class SceneCache {
+public:
+   static constexpr u32 Version = 2;
+   static constexpr u32 ChunkSize = 256;
+   static constexpr const char* Extension = ".gscache";
+   // Source hash of native scene files, they are not a cache of another file.
+   static constexpr u64 StandaloneHash = ~0ull;
+   // Returned for source files that cannot be read, never the hash of a readable file.
+   static constexpr u64 InvalidHash = 0;
+
+private:
+   MappedFile _mappedFile;
+   std::vector<uint8_t> _storage; // Used when the cache was built in memory.
+   const uint8_t* _data = nullptr;
+   size_t _size = 0;
+
+public:
+   // Hash of the source file identity (path, size and modification time), the load-time
+   // processing options and the cache version. InvalidHash when the file cannot be read.
+   static u64 ComputeSourceHash(const std::filesystem::path& source, u64 optionsHash);
+
+   // Cache files live in a cache directory next to the directory of the source file.
+   static std::filesystem::path GetCachePath(const std::filesystem::path& source, u64 sourceHash);
+
+   // Maps an existing cache file, fails if it is missing, corrupt or was built from a different source.
+   bool Open(const std::filesystem::path& path, u64 sourceHash);
+
+   // Builds the cache contents in memory from a decoded scene.
+   void Build(const SplatScene& scene, u64 sourceHash);
+
+   // Header with the section layout for splatCount splats, the bounds and centroid are left to the caller.
+   static SceneCacheHeader CreateHeader(u64 splatCount, u32 shDegree, u64 sourceHash);
+
+   // Metadata of count consecutive records. Transparent records of level of detail chunks are padding.
+   static SceneCacheChunk ComputeChunk(const Splat* splats, size_t count, bool isLod);
+
+   bool Save(const std::filesystem::path& path) const;
+
+   void Release();
+
+   [[nodiscard]] bool IsMapped() const { return _mappedFile.IsOpen(); }
+
+   [[nodiscard]] size_t GetSize() const { return _size; }
+
+   [[nodiscard]] const SceneCacheHeader& GetHeader() const {
+      return *reinterpret_cast<const SceneCacheHeader*>(_data);
+   }
+
+   [[nodiscard]] const SceneCacheChunk* GetChunks() const {
+      return reinterpret_cast<const SceneCacheChunk*>(_data + GetHeader().chunksOffset);
+   }
+
+   [[nodiscard]] const Splat* GetSplats() const {
+      return reinterpret_cast<const Splat*>(_data + GetHeader().splatsOffset);
+   }
+
+   [[nodiscard]] const u32* GetSHCoefficients() const {
+      return reinterpret_cast<const u32*>(_data + GetHeader().shCoefficientsOffset);
+   }
+
+private:
+   bool Validate(u64 sourceHash) const;
+};
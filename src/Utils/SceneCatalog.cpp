@@ -0,0 +1,239 @@
+#include <GaussianSplatting.h>
+#include <Utils/SceneCatalog.h>
+#include <Utils/FileReader.h>
+#include <Utils/MappedFile.h>
+#include <Utils/SceneCache.h>
+#include <Utils/Tracer.h>
+
+#include <algorithm>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+int SceneCatalogSnapshot::Find(const std::string& name) const {
+   for (size_t i = 0; i < entries.size(); ++i) {
+      if (entries[i].name == name) {
+         return static_cast<int>(i);
+      }
+   }
+   return -1;
+}
+
+SceneCatalog::~SceneCatalog() {
+   Stop();
+}
+
+void SceneCatalog::Start(const std::filesystem::path& directory) {
+   _directory = directory;
+   _stopWatcher = false;
+   _sinceRescan = 0;
+#ifdef _WIN32
+   HANDLE change = FindFirstChangeNotificationW(_directory.c_str(), FALSE,
+                                                FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE);
+   _changeHandle = change != INVALID_HANDLE_VALUE ? change : nullptr;
+#elif defined(__linux__)
+   // Files being written are picked up again once they are closed.
+   _notifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+   if (_notifyDescriptor >= 0 &&
+       inotify_add_watch(_notifyDescriptor, _directory.c_str(), IN_CREATE | IN_CLOSE_WRITE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO) < 0) {
+      close(_notifyDescriptor);
+      _notifyDescriptor = -1;
+   }
+#endif
+   _watcher = std::thread(&SceneCatalog::WatcherLoop, this);
+}
+
+void SceneCatalog::Stop() {
+   _stopWatcher = true;
+   if (_watcher.joinable()) {
+      _watcher.join();
+   }
+#ifdef _WIN32
+   if (_changeHandle != nullptr) {
+      FindCloseChangeNotification(_changeHandle);
+      _changeHandle = nullptr;
+   }
+#else
+   if (_notifyDescriptor >= 0) {
+      close(_notifyDescriptor);
+      _notifyDescriptor = -1;
+   }
+#endif
+}
+
+std::shared_ptr<const SceneCatalogSnapshot> SceneCatalog::GetSnapshot() {
+   std::lock_guard lock(_mutex);
+   return _snapshot;
+}
+
+bool SceneCatalog::ReadEntry(const std::filesystem::path& path, SceneCatalogEntry& entry) {
+   TRACE_SCOPE("SceneCatalog::ReadEntry");
+   size_t stride = 0;
+   size_t dataOffset = 0;
+   size_t positionOffsets[3] = { 0, sizeof(float), 2 * sizeof(float) };
+   if (path.extension() == ".splat") {
+      // Fixed 32 byte records starting with the position.
+      entry.format = SCENE_FORMAT_SPLAT;
+      entry.splatCount = entry.fileSize / 32;
+      entry.shDegree = 0;
+      stride = 32;
+   } else if (path.extension() == ".ply") {
+      entry.format = SCENE_FORMAT_PLY;
+      std::ifstream file(path, std::ios::binary);
+      PlyHeader header;
+      if (!file.is_open() || !FileReader::ReadPlyHeader(file, path, header)) {
+         return true;
+      }
+      entry.splatCount = header.vertexCount;
+      entry.shDegree = header.GetSHDegree();
+      stride = header.vertexStride;
+      dataOffset = header.dataOffset;
+      const char* names[3] = { "x", "y", "z" };
+      for (size_t i = 0; i < 3; ++i) {
+         int64_t offset = header.FindFloatOffset(names[i]);
+         if (offset < 0) {
+            return true;
+         }
+         positionOffsets[i] = static_cast<size_t>(offset);
+      }
+   } else if (path.extension() == SceneCache::Extension) {
+      // Native scenes store their metadata in the header.
+      entry.format = SCENE_FORMAT_NATIVE;
+      std::ifstream file(path, std::ios::binary);
+      SceneCacheHeader header = {};
+      file.read(reinterpret_cast<char*>(&header), sizeof(header));
+      if (!file.good() || memcmp(header.magic, "GSSC", sizeof(header.magic)) != 0 || header.version != SceneCache::Version ||
+          header.sourceHash != SceneCache::StandaloneHash || header.fileSize != entry.fileSize) {
+         return true;
+      }
+      entry.splatCount = header.splatCount;
+      entry.shDegree = header.shDegree;
+      if (header.splatCount > 0) {
+         entry.boundsMin = vec3(header.boundsMin);
+         entry.boundsMax = vec3(header.boundsMax);
+      }
+      entry.valid = true;
+      return true;
+   } else {
+      return false;
+   }
+
+   // Bounds from one pass over the mapped positions, only the touched pages are read.
+   MappedFile file;
+   if (!file.Open(path) || stride == 0 || dataOffset + entry.splatCount * stride > file.GetSize()) {
+      return true;
+   }
+   vec3 boundsMin(std::numeric_limits<float>::max());
+   vec3 boundsMax(std::numeric_limits<float>::lowest());
+   const uint8_t* data = file.GetData() + dataOffset;
+   for (u64 i = 0; i < entry.splatCount; ++i) {
+      vec3 position;
+      for (size_t c = 0; c < 3; ++c) {
+         memcpy(&position[static_cast<int>(c)], data + i * stride + positionOffsets[c], sizeof(float));
+      }
+      boundsMin = min(boundsMin, position);
+      boundsMax = max(boundsMax, position);
+   }
+   if (entry.splatCount > 0) {
+      entry.boundsMin = boundsMin;
+      entry.boundsMax = boundsMax;
+   }
+   entry.valid = true;
+   return true;
+}
+
+void SceneCatalog::WatcherLoop() {
+   Tracer::GetInstance().SetThreadName("Scene catalog");
+   Scan();
+   while (!_stopWatcher) {
+      if (WaitForChange()) {
+         // Copies report bursts of changes, scan once they settled.
+         while (!_stopWatcher && WaitForChange()) {
+         }
+         Scan();
+      }
+   }
+}
+
+bool SceneCatalog::WaitForChange() {
+#ifdef _WIN32
+   if (_changeHandle != nullptr) {
+      if (WaitForSingleObject(_changeHandle, PollInterval) != WAIT_OBJECT_0) {
+         return false;
+      }
+      FindNextChangeNotification(_changeHandle);
+      return true;
+   }
+#elif defined(__linux__)
+   if (_notifyDescriptor >= 0) {
+      pollfd descriptor = { _notifyDescriptor, POLLIN, 0 };
+      if (poll(&descriptor, 1, PollInterval) <= 0) {
+         return false;
+      }
+      // The events are not inspected, a scan covers all of them.
+      alignas(inotify_event) char events[4096];
+      while (read(_notifyDescriptor, events, sizeof(events)) > 0) {
+      }
+      return true;
+   }
+#endif
+
+   std::this_thread::sleep_for(std::chrono::milliseconds(PollInterval));
+   _sinceRescan += PollInterval;
+   if (_sinceRescan < RescanInterval) {
+      return false;
+   }
+   _sinceRescan = 0;
+   return true;
+}
+
+void SceneCatalog::Scan() {
+   TRACE_SCOPE("SceneCatalog::Scan");
+   std::shared_ptr<const SceneCatalogSnapshot> previous = GetSnapshot();
+   auto snapshot = std::make_shared<SceneCatalogSnapshot>();
+
+   std::error_code error;
+   for (const std::filesystem::directory_entry& file : std::filesystem::directory_iterator(_directory, error)) {
+      if (!file.is_regular_file(error)) {
+         continue;
+      }
+
+      SceneCatalogEntry entry;
+      entry.path = file.path();
+      entry.name = file.path().filename().string();
+      entry.fileSize = file.file_size(error);
+      entry.modified = file.last_write_time(error);
+      int index = previous->Find(entry.name);
+      if (index >= 0 && previous->entries[index].fileSize == entry.fileSize && previous->entries[index].modified == entry.modified) {
+         snapshot->entries.push_back(previous->entries[index]);
+      } else if (ReadEntry(entry.path, entry)) {
+         snapshot->entries.push_back(std::move(entry));
+      }
+   }
+   std::sort(snapshot->entries.begin(), snapshot->entries.end(),
+             [](const SceneCatalogEntry& a, const SceneCatalogEntry& b) { return a.name < b.name; });
+
+   // Only publish when a file was added, removed or changed.
+   bool changed = snapshot->entries.size() != previous->entries.size();
+   for (size_t i = 0; !changed && i < snapshot->entries.size(); ++i) {
+      const SceneCatalogEntry& entry = snapshot->entries[i];
+      const SceneCatalogEntry& old = previous->entries[i];
+      changed = entry.name != old.name || entry.fileSize != old.fileSize || entry.modified != old.modified;
+   }
+   if (!changed && GetVersion() > 0) {
+      return;
+   }
+
+   {
+      std::lock_guard lock(_mutex);
+      _snapshot = std::move(snapshot);
+   }
+   _version.fetch_add(1, std::memory_order_release);
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <Core/Core.h>
+#include <Utils/SceneFormat.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Metadata of a scene file, read from its size or header and one pass over the positions.
+struct SceneCatalogEntry {
+   std::filesystem::path path;
+   std::string name; // File name, shown in the UI.
+   ESceneFormat format = SCENE_FORMAT_SPLAT;
+   u64 fileSize = 0;
+   std::filesystem::file_time_type modified;
+   u64 splatCount = 0;
+   u32 shDegree = 0;
+   vec3 boundsMin = vec3(0.0f);
+   vec3 boundsMax = vec3(0.0f);
+   bool valid = false; // False when the file could not be read, loading it will fail.
+};
+
+// Scenes of the directory sorted by name, never modified once published.
+struct SceneCatalogSnapshot {
+   std::vector<SceneCatalogEntry> entries;
+
+   // Index of the entry with this file name, -1 when it is not in the catalog.
+   [[nodiscard]] int Find(const std::string& name) const;
+};
+
+// Scene files of a directory, kept up to date by a background thread. The directory is scanned at start
+// and again when the OS reports a change, through inotify on Linux and change notifications on Windows,
+// with a periodic rescan elsewhere. Unchanged files keep their metadata between scans. Readers share
+// immutable snapshots, so listing the scenes does not touch the filesystem or allocate.
+class SceneCatalog {
+public:
+   static constexpr u32 PollInterval = 100; // Milliseconds, bounds how long Stop waits.
+   static constexpr u32 RescanInterval = 2000; // Milliseconds, only without change notifications.
+
+private:
+   std::filesystem::path _directory;
+   std::thread _watcher;
+   std::atomic<bool> _stopWatcher = false;
+   u32 _sinceRescan = 0;
+#ifdef _WIN32
+   void* _changeHandle = nullptr;
+#else
+   int _notifyDescriptor = -1;
+#endif
+
+   std::mutex _mutex;
+   std::shared_ptr<const SceneCatalogSnapshot> _snapshot = std::make_shared<SceneCatalogSnapshot>();
+   std::atomic<u32> _version = 0;
+
+public:
+   SceneCatalog() = default;
+
+   ~SceneCatalog();
+
+   SceneCatalog(const SceneCatalog&) = delete;
+
+   SceneCatalog& operator=(const SceneCatalog&) = delete;
+
+   void Start(const std::filesystem::path& directory);
+
+   void Stop();
+
+   // Incremented whenever a new snapshot is published, cheap to compare every frame.
+   [[nodiscard]] u32 GetVersion() const { return _version.load(std::memory_order_acquire); }
+
+   [[nodiscard]] std::shared_ptr<const SceneCatalogSnapshot> GetSnapshot();
+
+   // Fills the metadata of one file, returns false for files of other formats.
+   static bool ReadEntry(const std::filesystem::path& path, SceneCatalogEntry& entry);
+
+private:
+   void WatcherLoop();
+
+   // Waits up to PollInterval, returns true when the directory may have changed.
+   bool WaitForChange();
+
+   void Scan();
+};
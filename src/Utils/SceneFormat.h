@@ -0,0 +1,11 @@
+#pragma once
+
+// Scene file formats the renderer loads and the converter reads and writes.
+enum ESceneFormat {
+   SCENE_FORMAT_SPLAT,
+   SCENE_FORMAT_PLY,
+   SCENE_FORMAT_NATIVE, // Scene cache layout written by the converter tool.
+   SCENE_FORMAT_COUNT
+};
+
+inline constexpr const char* SceneFormatNames[SCENE_FORMAT_COUNT] = { "splat", "PLY", "native" };
@@ -0,0 +1,164 @@
+#include <GaussianSplatting.h>
+#include <Utils/ShaderPreprocessor.h>
+
+#include <Utils/Hash.h>
+
+#include <sstream>
+
+bool IsIdentifierChar(char c) {
+   return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+const std::string* FindDefine(const ShaderDefines& defines, const std::string& name) {
+   for (const auto& [defineName, value] : defines) {
+      if (defineName == name) {
+         return &value;
+      }
+   }
+   return nullptr;
+}
+
+// Integer value of a literal or a define, undefined names and non numeric values are 0.
+long long EvaluateOperand(const ShaderDefines& defines, const std::string& operand) {
+   const std::string* value = FindDefine(defines, operand);
+   const std::string& text = value ? *value : operand;
+   char* end = nullptr;
+   long long result = std::strtoll(text.c_str(), &end, 0);
+   return end != text.c_str() ? result : 0;
+}
+
+bool EvaluateCondition(const ShaderDefines& defines, const std::string& expression, bool& result) {
+   std::istringstream stream(expression);
+   std::string lhs, op, rhs, rest;
+   stream >> lhs >> op >> rhs >> rest;
+   if (lhs.empty() || !rest.empty()) {
+      return false;
+   }
+
+   if (op.empty()) {
+      bool negate = lhs[0] == '!';
+      result = (EvaluateOperand(defines, negate ? lhs.substr(1) : lhs) != 0) != negate;
+      return true;
+   }
+
+   long long a = EvaluateOperand(defines, lhs);
+   long long b = EvaluateOperand(defines, rhs);
+   if (op == "==") result = a == b;
+   else if (op == "!=") result = a != b;
+   else if (op == "<") result = a < b;
+   else if (op == "<=") result = a <= b;
+   else if (op == ">") result = a > b;
+   else if (op == ">=") result = a >= b;
+   else return false;
+   return true;
+}
+
+// Replaces whole identifiers that name a define with its value, comments are copied as they are.
+void SubstituteDefines(const ShaderDefines& defines, const std::string& line, std::string& output) {
+   size_t codeEnd = std::min(line.find("//"), line.size());
+   size_t i = 0;
+   while (i < codeEnd) {
+      if (!IsIdentifierChar(line[i])) {
+         output += line[i++];
+         continue;
+      }
+
+      size_t end = i;
+      while (end < line.size() && IsIdentifierChar(line[end])) {
+         ++end;
+      }
+      std::string token = line.substr(i, end - i);
+      const std::string* value = FindDefine(defines, token);
+      output += value ? *value : token;
+      i = end;
+   }
+   output.append(line, codeEnd, std::string::npos);
+}
+
+bool ShaderPreprocessor::Process(const std::string& source, const ShaderDefines& defines, std::string& output) {
+   // One entry per open #if block.
+   struct Block {
+      bool parentActive;
+      bool active;
+      bool taken; // Some branch of the block was already taken.
+   };
+   std::vector<Block> blocks;
+   bool active = true;
+
+   output.clear();
+   output.reserve(source.size());
+   std::istringstream stream(source);
+   std::string line;
+   u32 lineNumber = 0;
+   while (std::getline(stream, line)) {
+      ++lineNumber;
+      size_t first = line.find_first_not_of(" \t");
+      if (first == std::string::npos || line[first] != '#') {
+         if (active) {
+            SubstituteDefines(defines, line, output);
+         }
+         // Removed lines stay empty so compiler errors keep their line numbers.
+         output += '\n';
+         continue;
+      }
+
+      std::istringstream directiveStream(line.substr(first + 1));
+      std::string directive, argument;
+      directiveStream >> directive;
+      std::getline(directiveStream, argument);
+
+      bool valid = true;
+      if (directive == "ifdef" || directive == "ifndef" || directive == "if") {
+         bool condition = false;
+         if (directive == "if") {
+            valid = EvaluateCondition(defines, argument, condition);
+         } else {
+            std::string name;
+            std::istringstream(argument) >> name;
+            condition = (FindDefine(defines, name) != nullptr) == (directive == "ifdef");
+         }
+         blocks.push_back({ active, active && condition, condition });
+         active = blocks.back().active;
+      } else if (directive == "elif" && !blocks.empty()) {
+         bool condition = false;
+         valid = EvaluateCondition(defines, argument, condition);
+         Block& block = blocks.back();
+         block.active = block.parentActive && !block.taken && condition;
+         block.taken = block.taken || condition;
+         active = block.active;
+      } else if (directive == "else" && !blocks.empty()) {
+         Block& block = blocks.back();
+         block.active = block.parentActive && !block.taken;
+         block.taken = true;
+         active = block.active;
+      } else if (directive == "endif" && !blocks.empty()) {
+         active = blocks.back().parentActive;
+         blocks.pop_back();
+      } else {
+         valid = false;
+      }
+
+      if (!valid) {
+         std::cerr << "Invalid shader preprocessor directive on line " << lineNumber << ": " << line << std::endl;
+         return false;
+      }
+      output += '\n';
+   }
+
+   if (!blocks.empty()) {
+      std::cerr << "Unterminated #if block in shader source." << std::endl;
+      return false;
+   }
+   return true;
+}
+
+u64 ShaderPreprocessor::HashDefines(const ShaderDefines& defines) {
+   u64 hash = Hash::Fnv1aSeed;
+   for (const auto& [name, value] : defines) {
+      hash = Hash::Fnv1a(name.data(), name.size(), hash);
+      hash = Hash::Fnv1aValue('=', hash);
+      hash = Hash::Fnv1a(value.data(), value.size(), hash);
+      hash = Hash::Fnv1aValue(';', hash);
+   }
+   return hash;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <Core/Core.h>
+
+#include <string>
+#include <utility>
+
+// Name and value pairs, values are substituted for whole identifiers in the shader source.
+using ShaderDefines = std::vector<std::pair<std::string, std::string>>;
+
+// Minimal C style preprocessor for WGSL permutations. Supports #ifdef, #ifndef, #if, #elif, #else and
+// #endif, where #if takes a define, !define or a comparison (==, !=, <, <=, >, >=) between a define
+// and an integer. Undefined names evaluate to 0.
+class ShaderPreprocessor {
+public:
+   // Returns false and prints the line on malformed directives.
+   static bool Process(const std::string& source, const ShaderDefines& defines, std::string& output);
+
+   // Hash of the define names and values, order dependent.
+   static u64 HashDefines(const ShaderDefines& defines);
+};
@@ -0,0 +1,42 @@
+#include <GaussianSplatting.h>
+#include <Utils/SortSchedule.h>
+
+#include <bit>
+
+void SortSchedule::Build(u32 capacity, ESortAlgorithm algorithm, u32 workGroupSize, u32 keysPerThread) {
+   _steps.clear();
+   _stepCounts.assign(std::countr_zero(capacity) + 1, 0);
+
+   if (algorithm == SORT_ALGORITHM_GLOBAL) {
+      _blockSize = 1;
+      for (u32 k = 2; k <= capacity; k *= 2) {
+         for (u32 j = k / 2; j > 0; j /= 2) {
+            _steps.push_back({ { k, j }, SORT_PASS_GLOBAL });
+         }
+         _stepCounts[std::countr_zero(k)] = static_cast<u32>(_steps.size());
+      }
+      return;
+   }
+
+   // The block passes replace every step whose compare distance stays inside a block.
+   _blockSize = workGroupSize * keysPerThread;
+   _steps.push_back({ { _blockSize, 0 }, SORT_PASS_BLOCK_SORT });
+   _stepCounts[std::countr_zero(_blockSize)] = 1;
+   for (u32 k = _blockSize * 2; k <= capacity; k *= 2) {
+      for (u32 j = k / 2; j >= _blockSize; j /= 2) {
+         _steps.push_back({ { k, j }, SORT_PASS_GLOBAL });
+      }
+      _steps.push_back({ { k, _blockSize / 2 }, SORT_PASS_BLOCK_MERGE });
+      _stepCounts[std::countr_zero(k)] = static_cast<u32>(_steps.size());
+   }
+}
+
+u32 SortSchedule::GetStepCount(u32 keyCount) const {
+   u32 level = std::countr_zero(std::max(keyCount, _blockSize));
+   return level < _stepCounts.size() ? _stepCounts[level] : static_cast<u32>(_steps.size());
+}
+
+u32 SortSchedule::GetMaxStepCount(u32 capacity) {
+   u32 levels = std::countr_zero(capacity);
+   return std::max(levels * (levels + 1) / 2, 1u);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <Core/Core.h>
+
+// Bitonic sort variants of the splat sort.
+enum ESortAlgorithm {
+   SORT_ALGORITHM_GLOBAL, // One dispatch per compare and exchange step, all accesses go to global memory.
+   SORT_ALGORITHM_SHARED, // Steps within a block of workgroup size * keys per thread run in workgroup memory.
+   SORT_ALGORITHM_COUNT
+};
+
+// Kernel of a sort step.
+enum ESortPass {
+   SORT_PASS_GLOBAL, // Single compare and exchange step (k, j) in global memory.
+   SORT_PASS_BLOCK_SORT, // Sorts each block completely, alternating direction per block.
+   SORT_PASS_BLOCK_MERGE, // All steps of merge k with distances below the block size.
+};
+
+struct SortStep {
+   uvec2 params; // (k, j) written to the sort params uniform, j is unused by the block passes.
+   ESortPass pass;
+};
+
+// Sequence of dispatches sorting a power of two number of keys. Steps are ordered by merge size, so
+// sorting fewer keys runs a prefix of the steps built for the capacity.
+class SortSchedule {
+private:
+   std::vector<SortStep> _steps;
+   std::vector<u32> _stepCounts; // Steps needed to sort 2^i keys.
+   u32 _blockSize = 1;
+
+public:
+   // Shared block sorts need a capacity of at least workGroupSize * keysPerThread keys.
+   void Build(u32 capacity, ESortAlgorithm algorithm, u32 workGroupSize, u32 keysPerThread);
+
+   // Smallest key count the schedule can sort, frames pad to at least this many keys.
+   [[nodiscard]] u32 GetBlockSize() const { return _blockSize; }
+
+   // Number of steps sorting keyCount keys, a power of two between the block size and the capacity.
+   [[nodiscard]] u32 GetStepCount(u32 keyCount) const;
+
+   [[nodiscard]] const std::vector<SortStep>& GetSteps() const { return _steps; }
+
+   // Steps of the global algorithm for the capacity, the largest schedule and the size of the params buffer.
+   static u32 GetMaxStepCount(u32 capacity);
+};
@@ -0,0 +1,219 @@
+#include <GaussianSplatting.h>
+#include <Utils/SplatLod.h>
+
+#include <Utils/ChunkHierarchy.h>
+#include <Utils/Parallel.h>
+#include <Utils/Tracer.h>
+
+#include <bit>
+#include <thread>
+
+constexpr u32 LodChunkSize = SceneCache::ChunkSize;
+
+vec4 UnpackColor(u32 packed) {
+   return vec4((packed >> 24) & 0xFF, (packed >> 16) & 0xFF, (packed >> 8) & 0xFF, packed & 0xFF) / 255.0f;
+}
+
+u32 PackColor(const vec4& color) {
+   uvec4 bytes = uvec4(clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f);
+   return (bytes.r << 24) | (bytes.g << 16) | (bytes.b << 8) | bytes.a;
+}
+
+// Rotations are packed as (w, x, y, z) with one byte per component.
+quat UnpackRotation(u32 packed) {
+   vec4 q = (vec4(packed & 0xFF, (packed >> 8) & 0xFF, (packed >> 16) & 0xFF, (packed >> 24) & 0xFF) - 128.0f) / 128.0f;
+   float length = glm::length(q);
+   return length > 0.0f ? quat(q.x / length, q.y / length, q.z / length, q.w / length) : quat(1.0f, 0.0f, 0.0f, 0.0f);
+}
+
+u32 PackRotation(const quat& rotation) {
+   uvec4 bytes = uvec4(clamp(vec4(rotation.w, rotation.x, rotation.y, rotation.z) * 128.0f + 128.0f, 0.0f, 255.0f));
+   return bytes.x | (bytes.y << 8) | (bytes.z << 16) | (bytes.w << 24);
+}
+
+mat3 GetSplatCovariance(const Splat& splat) {
+   mat3 rotation = mat3_cast(UnpackRotation(splat.rotation));
+   vec3 scale = vec3(splat.scale);
+   mat3 scaleSquared(0.0f);
+   scaleSquared[0][0] = scale.x * scale.x;
+   scaleSquared[1][1] = scale.y * scale.y;
+   scaleSquared[2][2] = scale.z * scale.z;
+   return rotation * scaleSquared * transpose(rotation);
+}
+
+// Eigen decomposition of a symmetric matrix with cyclic Jacobi rotations, eigenvectors are the columns of vectors.
+void JacobiEigen(mat3 matrix, vec3& values, mat3& vectors) {
+   vectors = mat3(1.0f);
+   for (int sweep = 0; sweep < 16; ++sweep) {
+      float offDiagonal = matrix[1][0] * matrix[1][0] + matrix[2][0] * matrix[2][0] + matrix[2][1] * matrix[2][1];
+      float diagonal = matrix[0][0] * matrix[0][0] + matrix[1][1] * matrix[1][1] + matrix[2][2] * matrix[2][2];
+      if (offDiagonal <= 1e-12f * diagonal) {
+         break;
+      }
+
+      for (int p = 0; p < 2; ++p) {
+         for (int q = p + 1; q < 3; ++q) {
+            if (matrix[q][p] == 0.0f) {
+               continue;
+            }
+
+            float theta = (matrix[q][q] - matrix[p][p]) / (2.0f * matrix[q][p]);
+            float t = (theta >= 0.0f ? 1.0f : -1.0f) / (std::abs(theta) + std::sqrt(theta * theta + 1.0f));
+            float c = 1.0f / std::sqrt(t * t + 1.0f);
+            float s = t * c;
+
+            mat3 rotation(1.0f);
+            rotation[p][p] = c;
+            rotation[q][q] = c;
+            rotation[q][p] = s;
+            rotation[p][q] = -s;
+            matrix = transpose(rotation) * matrix * rotation;
+            vectors = vectors * rotation;
+         }
+      }
+   }
+   values = vec3(matrix[0][0], matrix[1][1], matrix[2][2]);
+}
+
+// Merges two splats into one Gaussian with the same weighted mean and covariance. Splats are
+// weighted by opacity times surface area, padding records have no weight.
+void MergeSplats(const Splat& a, const Splat& b, const u32* shA, const u32* shB, u32 shWordsPerSplat, Splat& merged, u32* mergedSH) {
+   const Splat* sources[2] = { &a, &b };
+   vec4 colors[2];
+   float areas[2];
+   float weights[2];
+   for (int i = 0; i < 2; ++i) {
+      vec3 scale = vec3(sources[i]->scale);
+      colors[i] = UnpackColor(sources[i]->color);
+      areas[i] = scale.x * scale.y + scale.y * scale.z + scale.z * scale.x;
+      weights[i] = areas[i] * colors[i].a;
+   }
+
+   float totalWeight = weights[0] + weights[1];
+   if (!(totalWeight > 0.0f)) {
+      merged = Splat{};
+      std::fill(mergedSH, mergedSH + shWordsPerSplat, 0u);
+      return;
+   }
+
+   vec3 mean = (weights[0] * vec3(a.position) + weights[1] * vec3(b.position)) / totalWeight;
+   mat3 covariance(0.0f);
+   vec3 color(0.0f);
+   float extentSquared = 0.0f;
+   for (int i = 0; i < 2; ++i) {
+      vec3 offset = vec3(sources[i]->position) - mean;
+      covariance += weights[i] * (GetSplatCovariance(*sources[i]) + outerProduct(offset, offset));
+      extentSquared += weights[i] * (sources[i]->scale.w * sources[i]->scale.w + dot(offset, offset));
+      color += weights[i] * vec3(colors[i]);
+   }
+   covariance /= totalWeight;
+   extentSquared /= totalWeight;
+   color /= totalWeight;
+   float opacity = (areas[0] * colors[0].a + areas[1] * colors[1].a) / (areas[0] + areas[1]);
+
+   vec3 eigenValues;
+   mat3 eigenVectors;
+   JacobiEigen(covariance, eigenValues, eigenVectors);
+   if (determinant(eigenVectors) < 0.0f) {
+      eigenVectors[2] = -eigenVectors[2];
+   }
+
+   merged.position = vec4(mean, 1.0f);
+   // The w component holds the spread of the merged splat centers, used by the renderer to size the quad.
+   merged.scale = vec4(sqrt(max(eigenValues, vec3(1e-12f))), std::sqrt(extentSquared));
+   merged.color = PackColor(vec4(color, opacity));
+   merged.rotation = PackRotation(normalize(quat_cast(eigenVectors)));
+
+   for (u32 w = 0; w < shWordsPerSplat; ++w) {
+      vec2 coefficients = (weights[0] * unpackHalf2x16(shA[w]) + weights[1] * unpackHalf2x16(shB[w])) / totalWeight;
+      mergedSH[w] = packHalf2x16(coefficients);
+   }
+}
+
+struct LodBuildContext {
+   const Splat* splats;
+   const u32* shCoefficients;
+   u32 shWordsPerSplat;
+   Splat* lodSplats;
+   u32* lodSHCoefficients;
+   u32 parallelDepth;
+};
+
+// Builds the chunk of an internal node from the representatives of its children. lodIndex is the depth
+// first index of the node among the internal nodes, so the left child follows it and the right child
+// follows the internal nodes of the left subtree.
+void BuildLodNode(const LodBuildContext& context, u32 firstChunk, u32 chunkCount, u32 lodIndex, u32 depth) {
+   u32 leftCount = ChunkHierarchy::GetLeftChunkCount(chunkCount);
+   u32 rightCount = chunkCount - leftCount;
+   u32 leftLod = lodIndex + 1;
+   u32 rightLod = lodIndex + leftCount;
+
+   auto buildLeft = [&]() {
+      if (leftCount > 1) {
+         BuildLodNode(context, firstChunk, leftCount, leftLod, depth + 1);
+      }
+   };
+   auto buildRight = [&]() {
+      if (rightCount > 1) {
+         BuildLodNode(context, firstChunk + leftCount, rightCount, rightLod, depth + 1);
+      }
+   };
+
+   if (depth < context.parallelDepth) {
+      std::thread leftThread(buildLeft);
+      buildRight();
+      leftThread.join();
+   } else {
+      buildLeft();
+      buildRight();
+   }
+
+   const u32 shWords = context.shWordsPerSplat;
+   size_t leftRecord = static_cast<size_t>(leftCount > 1 ? leftLod : firstChunk) * LodChunkSize;
+   size_t rightRecord = static_cast<size_t>(rightCount > 1 ? rightLod : firstChunk + leftCount) * LodChunkSize;
+   const Splat* children[2] = {
+      (leftCount > 1 ? context.lodSplats : context.splats) + leftRecord,
+      (rightCount > 1 ? context.lodSplats : context.splats) + rightRecord,
+   };
+   const u32* childrenSH[2] = {
+      (leftCount > 1 ? context.lodSHCoefficients : context.shCoefficients) + leftRecord * shWords,
+      (rightCount > 1 ? context.lodSHCoefficients : context.shCoefficients) + rightRecord * shWords,
+   };
+
+   size_t nodeRecord = static_cast<size_t>(lodIndex) * LodChunkSize;
+   SplatLod::MergeChildren(children, childrenSH, shWords, context.lodSplats + nodeRecord, context.lodSHCoefficients + nodeRecord * shWords);
+}
+
+void SplatLod::MergeChildren(const Splat* const children[2], const u32* const childrenSH[2], u32 shWordsPerSplat,
+                             Splat* merged, u32* mergedSH) {
+   // Both children are Morton ordered, so neighbouring records of their concatenation are close in space.
+   const u32 shWords = shWordsPerSplat;
+   for (u32 i = 0; i < LodChunkSize; ++i) {
+      u32 first = i * 2;
+      u32 second = first + 1;
+      u32 child = first / LodChunkSize;
+      first %= LodChunkSize;
+      second %= LodChunkSize;
+      MergeSplats(children[child][first], children[child][second],
+                  childrenSH[child] + first * shWords, childrenSH[child] + second * shWords, shWords,
+                  merged[i], mergedSH + i * shWords);
+   }
+}
+
+void SplatLod::Build(const Splat* splats, const u32* shCoefficients, u32 shWordsPerSplat, u32 chunkCount,
+                     Splat* lodSplats, u32* lodSHCoefficients) {
+   TRACE_SCOPE("SplatLod::Build");
+   if (GetChunkCount(chunkCount) == 0) {
+      return;
+   }
+
+   LodBuildContext context;
+   context.splats = splats;
+   context.shCoefficients = shCoefficients;
+   context.shWordsPerSplat = shWordsPerSplat;
+   context.lodSplats = lodSplats;
+   context.lodSHCoefficients = lodSHCoefficients;
+   context.parallelDepth = static_cast<u32>(std::bit_width(Parallel::GetThreadCount()) - 1);
+
+   BuildLodNode(context, 0, chunkCount, 0, 0);
+}
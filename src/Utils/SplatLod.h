@@ -0,0 +1,21 @@
+#pragma once
+
+#include <Utils/FileReader.h>
+
+// Builds the level of detail chunks of the scene cache. Every internal node of the chunk hierarchy
+// gets one chunk of merged splats that approximates all splats below it. The chunks are stored in
+// depth first order of the internal nodes, matching ChunkHierarchy::Build.
+class SplatLod {
+public:
+   // A binary hierarchy over chunkCount chunks has chunkCount - 1 internal nodes.
+   static u32 GetChunkCount(u32 chunkCount) { return chunkCount > 1 ? chunkCount - 1 : 0; }
+
+   // splats and shCoefficients hold chunkCount full chunks where padding records have zero opacity.
+   // Writes GetChunkCount(chunkCount) chunks to lodSplats and lodSHCoefficients.
+   static void Build(const Splat* splats, const u32* shCoefficients, u32 shWordsPerSplat, u32 chunkCount,
+                     Splat* lodSplats, u32* lodSHCoefficients);
+
+   // Merges neighbouring pairs of the 2 * ChunkSize records of two child chunks into one chunk.
+   static void MergeChildren(const Splat* const children[2], const u32* const childrenSH[2], u32 shWordsPerSplat,
+                             Splat* merged, u32* mergedSH);
+};
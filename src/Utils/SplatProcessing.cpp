@@ -0,0 +1,173 @@
+#include <GaussianSplatting.h>
+#include <Utils/SplatProcessing.h>
+
+#include <Utils/Hash.h>
+#include <Utils/Parallel.h>
+#include <Utils/Tracer.h>
+
+#include <mutex>
+
+// Spreads the lower 21 bits of value so there are two zero bits between each bit.
+u64 SpreadBits3(u64 value) {
+   value &= 0x1FFFFF;
+   value = (value | (value << 32)) & 0x001F00000000FFFFull;
+   value = (value | (value << 16)) & 0x001F0000FF0000FFull;
+   value = (value | (value << 8)) & 0x100F00F00F00F00Full;
+   value = (value | (value << 4)) & 0x10C30C30C30C30C3ull;
+   value = (value | (value << 2)) & 0x1249249249249249ull;
+   return value;
+}
+
+void SplatProcessing::Process(SplatScene& scene, const SplatProcessingOptions& options) {
+   TRACE_SCOPE("SplatProcessing::Process");
+   if (options.prune || options.splatBudget > 0) {
+      SelectByImportance(scene, options);
+   }
+   if (options.spatialReorder) {
+      ReorderMorton(scene);
+   }
+}
+
+u64 SplatProcessing::HashOptions(const SplatProcessingOptions& options) {
+   u64 hash = Hash::Fnv1aValue(options.spatialReorder);
+   hash = Hash::Fnv1aValue(options.prune, hash);
+   hash = Hash::Fnv1aValue(options.minOpacity, hash);
+   hash = Hash::Fnv1aValue(options.minImportance, hash);
+   hash = Hash::Fnv1aValue(options.splatBudget, hash);
+   return hash;
+}
+
+float SplatProcessing::ComputeImportance(const Splat& splat) {
+   float opacity = static_cast<float>(splat.color & 0xFF) / 255.0f;
+   float volume = splat.scale.x * splat.scale.y * splat.scale.z;
+   float importance = opacity * std::cbrt(volume * volume);
+   // NaN would break the ordering of the budget sort, non-finite splats rank below all others.
+   return std::isfinite(importance) ? importance : -std::numeric_limits<float>::infinity();
+}
+
+bool SplatProcessing::IsPruned(const Splat& splat, const SplatProcessingOptions& options) {
+   if (!options.prune) {
+      return false;
+   }
+
+   vec3 position = vec3(splat.position);
+   vec3 scale = vec3(splat.scale);
+   bool finite = !any(isnan(position)) && !any(isinf(position)) && !any(isnan(scale)) && !any(isinf(scale));
+   bool degenerate = !finite || !(std::min(splat.scale.x, std::min(splat.scale.y, splat.scale.z)) > 0.0f);
+   float opacity = static_cast<float>(splat.color & 0xFF) / 255.0f;
+   return degenerate || opacity < options.minOpacity || ComputeImportance(splat) < options.minImportance;
+}
+
+u64 SplatProcessing::ComputeMortonCode(const vec3& position, const vec3& boundsMin, const vec3& extent) {
+   vec3 normalized = clamp((position - boundsMin) / extent, 0.0f, 1.0f);
+   u64 x = static_cast<u64>(normalized.x * 2097151.0f);
+   u64 y = static_cast<u64>(normalized.y * 2097151.0f);
+   u64 z = static_cast<u64>(normalized.z * 2097151.0f);
+   return SpreadBits3(x) | (SpreadBits3(y) << 1) | (SpreadBits3(z) << 2);
+}
+
+void SplatProcessing::SelectByImportance(SplatScene& scene, const SplatProcessingOptions& options) {
+   TRACE_SCOPE("SplatProcessing::SelectByImportance");
+   const size_t splatCount = scene.splats.size();
+   if (splatCount == 0) {
+      return;
+   }
+
+   // Scores and per-thread lists of the splats that survive pruning.
+   std::mutex keptMutex;
+   std::vector<float> importance(splatCount);
+   std::vector<std::vector<u32>> keptRanges;
+   Parallel::ForChunks(splatCount, 65536, [&](size_t begin, size_t end) {
+      std::vector<u32> kept;
+      kept.reserve(end - begin);
+      for (size_t i = begin; i < end; ++i) {
+         const Splat& splat = scene.splats[i];
+         importance[i] = ComputeImportance(splat);
+         if (IsPruned(splat, options)) {
+            continue;
+         }
+         kept.push_back(static_cast<u32>(i));
+      }
+      std::lock_guard lock(keptMutex);
+      keptRanges.push_back(std::move(kept));
+   });
+
+   std::vector<u32> order;
+   order.reserve(splatCount);
+   for (const auto& kept : keptRanges) {
+      order.insert(order.end(), kept.begin(), kept.end());
+   }
+
+   // Most important first, ties keep the file order.
+   Parallel::Sort(order.begin(), order.end(), [&importance](u32 a, u32 b) {
+      return importance[a] > importance[b] || (importance[a] == importance[b] && a < b);
+   });
+   if (options.splatBudget > 0 && order.size() > options.splatBudget) {
+      order.resize(options.splatBudget);
+   }
+
+   std::cout << "Kept " << order.size() << " of " << splatCount << " splats after pruning" << std::endl;
+   ApplyPermutation(scene, order);
+}
+
+void SplatProcessing::ReorderMorton(SplatScene& scene) {
+   TRACE_SCOPE("SplatProcessing::ReorderMorton");
+   const size_t splatCount = scene.splats.size();
+   if (splatCount < 2) {
+      return;
+   }
+
+   // Scene bounds, reduced per thread.
+   std::mutex boundsMutex;
+   vec3 boundsMin(std::numeric_limits<float>::max());
+   vec3 boundsMax(-std::numeric_limits<float>::max());
+   Parallel::ForChunks(splatCount, 65536, [&](size_t begin, size_t end) {
+      vec3 localMin(std::numeric_limits<float>::max());
+      vec3 localMax(-std::numeric_limits<float>::max());
+      for (size_t i = begin; i < end; ++i) {
+         localMin = min(localMin, vec3(scene.splats[i].position));
+         localMax = max(localMax, vec3(scene.splats[i].position));
+      }
+      std::lock_guard lock(boundsMutex);
+      boundsMin = min(boundsMin, localMin);
+      boundsMax = max(boundsMax, localMax);
+   });
+
+   // 21 bits per axis Morton codes paired with the original index.
+   vec3 extent = max(boundsMax - boundsMin, vec3(1e-6f));
+   std::vector<std::pair<u64, u32>> codes(splatCount);
+   Parallel::ForChunks(splatCount, 65536, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+         codes[i] = { ComputeMortonCode(vec3(scene.splats[i].position), boundsMin, extent), static_cast<u32>(i) };
+      }
+   });
+
+   Parallel::Sort(codes.begin(), codes.end(), [](const auto& a, const auto& b) {
+      return a.first < b.first;
+   });
+
+   std::vector<u32> order(splatCount);
+   for (size_t i = 0; i < splatCount; ++i) {
+      order[i] = codes[i].second;
+   }
+   ApplyPermutation(scene, order);
+}
+
+void SplatProcessing::ApplyPermutation(SplatScene& scene, const std::vector<u32>& order) {
+   const size_t count = order.size();
+   const u32 shWords = scene.shDegree > 0 ? GetSHWordsPerSplat(scene.shDegree) : 0;
+
+   std::vector<Splat> splats(count);
+   std::vector<u32> shCoefficients(count * shWords);
+   Parallel::ForChunks(count, 65536, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+         splats[i] = scene.splats[order[i]];
+         if (shWords > 0) {
+            memcpy(&shCoefficients[i * shWords], &scene.shCoefficients[static_cast<size_t>(order[i]) * shWords], shWords * sizeof(u32));
+         }
+      }
+   });
+
+   scene.splats = std::move(splats);
+   scene.shCoefficients = std::move(shCoefficients);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <Utils/FileReader.h>
+
+// Load-time processing applied to a decoded scene before it is written to the scene cache.
+struct SplatProcessingOptions {
+   // Sort splats along a Morton curve so neighbouring records are close in space.
+   bool spatialReorder = true;
+   // Drop degenerate splats and splats below minOpacity or minImportance.
+   bool prune = true;
+   float minOpacity = 1.0f / 255.0f;
+   // Importance in scene units squared, see ComputeImportance. 0 keeps splats of any importance.
+   float minImportance = 0.0f;
+   // Keep only the splatBudget most important splats, 0 keeps all of them.
+   u32 splatBudget = 0;
+};
+
+class SplatProcessing {
+public:
+   static void Process(SplatScene& scene, const SplatProcessingOptions& options);
+
+   // Hash of the options, part of the scene cache key.
+   static u64 HashOptions(const SplatProcessingOptions& options);
+
+   // Importance of a splat for pruning and the splat budget, opacity times volume^(2/3).
+   // Non-finite values become -infinity, so importance always has a strict weak order.
+   static float ComputeImportance(const Splat& splat);
+
+   // True for degenerate splats and splats below minOpacity or minImportance when pruning is enabled.
+   static bool IsPruned(const Splat& splat, const SplatProcessingOptions& options);
+
+   // 21 bits per axis Morton code of a position within the scene bounds.
+   static u64 ComputeMortonCode(const vec3& position, const vec3& boundsMin, const vec3& extent);
+
+   // Applies pruning and the splat budget. Kept splats are stored in decreasing importance unless
+   // they are reordered spatially afterwards.
+   static void SelectByImportance(SplatScene& scene, const SplatProcessingOptions& options);
+
+   static void ReorderMorton(SplatScene& scene);
+
+   // Reorders splats and their SH coefficients so that new index i holds old index order[i].
+   // Splats missing from order are dropped.
+   static void ApplyPermutation(SplatScene& scene, const std::vector<u32>& order);
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <Core/Core.h>
+
+#include <array>
+#include <atomic>
+
+// Bounded lock-free queue between exactly one producer and one consumer thread. Push fails instead of
+// blocking when the ring is full, the capacity must be a power of two.
+template<typename T, size_t Capacity>
+class SpscRing {
+   static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+private:
+   std::array<T, Capacity> _items = {};
+   // Free running indices on separate cache lines, the producer only writes the tail and the consumer the head.
+   alignas(64) std::atomic<size_t> _head = 0;
+   alignas(64) std::atomic<size_t> _tail = 0;
+
+public:
+   // Producer thread only.
+   bool Push(const T& item) {
+      size_t tail = _tail.load(std::memory_order_relaxed);
+      if (tail - _head.load(std::memory_order_acquire) == Capacity) {
+         return false;
+      }
+      _items[tail & (Capacity - 1)] = item;
+      _tail.store(tail + 1, std::memory_order_release);
+      return true;
+   }
+
+   // Consumer thread only.
+   bool Pop(T& item) {
+      size_t head = _head.load(std::memory_order_relaxed);
+      if (head == _tail.load(std::memory_order_acquire)) {
+         return false;
+      }
+      item = _items[head & (Capacity - 1)];
+      _head.store(head + 1, std::memory_order_release);
+      return true;
+   }
+
+   // Approximate from any thread other than the two sides.
+   [[nodiscard]] size_t Size() const {
+      return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire);
+   }
+};
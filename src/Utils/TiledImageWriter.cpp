@@ -0,0 +1,66 @@
+#include <GaussianSplatting.h>
+#include <Utils/TiledImageWriter.h>
+
+#include <string>
+
+TiledImageWriter::~TiledImageWriter() {
+   Close();
+}
+
+bool TiledImageWriter::Open(const std::filesystem::path& path, u32vec2 size) {
+   Close();
+
+   std::error_code error;
+   std::filesystem::create_directories(path.parent_path(), error);
+   _file.open(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+   if (!_file.is_open()) {
+      std::cerr << "Failed to create image: " << path << std::endl;
+      return false;
+   }
+
+   std::string header = "P6\n" + std::to_string(size.x) + " " + std::to_string(size.y) + "\n255\n";
+   _file.write(header.data(), static_cast<std::streamsize>(header.size()));
+   _size = size;
+   _headerSize = header.size();
+
+   // Reserve the pixel data up front, tiles are then written in place.
+   u64 fileSize = _headerSize + static_cast<u64>(size.x) * size.y * 3;
+   _file.seekp(static_cast<std::streamoff>(fileSize - 1));
+   _file.put('\0');
+   if (!_file.good()) {
+      std::cerr << "Failed to allocate image: " << path << std::endl;
+      _file.close();
+      return false;
+   }
+   return true;
+}
+
+bool TiledImageWriter::WriteTile(u32vec2 origin, u32vec2 tileSize, const u8* pixels, u32 bytesPerRow) {
+   if (!_file.is_open() || origin.x + tileSize.x > _size.x || origin.y + tileSize.y > _size.y) {
+      return false;
+   }
+
+   std::vector<u8> row(static_cast<size_t>(tileSize.x) * 3);
+   for (u32 y = 0; y < tileSize.y; ++y) {
+      const u8* source = pixels + static_cast<size_t>(y) * bytesPerRow;
+      for (u32 x = 0; x < tileSize.x; ++x) {
+         row[x * 3 + 0] = source[x * 4 + 0];
+         row[x * 3 + 1] = source[x * 4 + 1];
+         row[x * 3 + 2] = source[x * 4 + 2];
+      }
+      u64 offset = _headerSize + ((static_cast<u64>(origin.y) + y) * _size.x + origin.x) * 3;
+      _file.seekp(static_cast<std::streamoff>(offset));
+      _file.write(reinterpret_cast<const char*>(row.data()), static_cast<std::streamsize>(row.size()));
+   }
+   return _file.good();
+}
+
+bool TiledImageWriter::Close() {
+   if (!_file.is_open()) {
+      return true;
+   }
+   _file.flush();
+   bool good = _file.good();
+   _file.close();
+   return good;
+}
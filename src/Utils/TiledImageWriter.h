@@ -0,0 +1,31 @@
+#pragma once
+
+#include <Core/Core.h>
+
+// Binary PPM written one tile at a time. Rows of a tile are written at their final offsets, so tiles can
+// arrive in any order and only the tile being written is held in memory.
+class TiledImageWriter {
+private:
+   std::fstream _file;
+   u32vec2 _size = u32vec2(0);
+   u64 _headerSize = 0;
+
+public:
+   TiledImageWriter() = default;
+
+   ~TiledImageWriter();
+
+   TiledImageWriter(const TiledImageWriter&) = delete;
+
+   TiledImageWriter& operator=(const TiledImageWriter&) = delete;
+
+   // Creates the file at its full size, parent directories included.
+   bool Open(const std::filesystem::path& path, u32vec2 size);
+
+   // Writes a tile of RGBA8 pixels at origin, the alpha channel is dropped.
+   bool WriteTile(u32vec2 origin, u32vec2 tileSize, const u8* pixels, u32 bytesPerRow);
+
+   bool Close();
+
+   [[nodiscard]] bool IsOpen() const { return _file.is_open(); }
+};
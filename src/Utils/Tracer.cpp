@@ -0,0 +1,110 @@
+#include <GaussianSplatting.h>
+#include <Utils/Tracer.h>
+
+#include <algorithm>
+#include <chrono>
+
+std::atomic<u32> NextThreadId = 0;
+
+void WriteJsonString(std::ostream& stream, const char* text) {
+   stream << '"';
+   for (const char* c = text; *c; ++c) {
+      if (*c == '"' || *c == '\\') {
+         stream << '\\';
+      }
+      stream << *c;
+   }
+   stream << '"';
+}
+
+Tracer::Tracer() : _slots(Capacity) {
+   _startTime = Now();
+}
+
+u64 Tracer::Now() {
+   return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+u32 Tracer::GetThreadId() {
+   thread_local u32 threadId = NextThreadId.fetch_add(1, std::memory_order_relaxed);
+   return threadId;
+}
+
+void Tracer::SetThreadName(const char* name) {
+   std::lock_guard<std::mutex> lock(_threadNamesMutex);
+   _threadNames[GetThreadId()] = name;
+}
+
+void Tracer::Record(const char* name, u64 start, u64 end) {
+   u64 index = _nextEvent.fetch_add(1, std::memory_order_relaxed);
+   Slot& slot = _slots[index % Capacity];
+
+   // Readers skip the slot while it is being overwritten.
+   slot.sequence.store(0, std::memory_order_relaxed);
+   std::atomic_thread_fence(std::memory_order_release);
+   slot.event.name = name;
+   slot.event.start = start - std::min(start, _startTime);
+   slot.event.duration = end - start;
+   slot.event.threadId = GetThreadId();
+   slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+bool Tracer::Export(const std::filesystem::path& path) {
+   // Copy the completed events first so the file is written without racing the recording threads.
+   u64 eventCount = _nextEvent.load(std::memory_order_acquire);
+   u64 firstEvent = eventCount > Capacity ? eventCount - Capacity : 0;
+   std::vector<TraceEvent> events;
+   events.reserve(static_cast<size_t>(eventCount - firstEvent));
+   for (u64 index = firstEvent; index < eventCount; ++index) {
+      const Slot& slot = _slots[index % Capacity];
+      if (slot.sequence.load(std::memory_order_acquire) != index + 1) {
+         continue;
+      }
+      TraceEvent event = slot.event;
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.sequence.load(std::memory_order_relaxed) == index + 1) {
+         events.push_back(event);
+      }
+   }
+
+   std::error_code error;
+   if (path.has_parent_path()) {
+      std::filesystem::create_directories(path.parent_path(), error);
+   }
+   std::ofstream file(path, std::ios::trunc);
+   if (!file.is_open()) {
+      std::cerr << "Failed to create trace file: " << path << std::endl;
+      return false;
+   }
+
+   // Complete ("X") events with microsecond timestamps.
+   file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+   bool first = true;
+   {
+      std::lock_guard<std::mutex> lock(_threadNamesMutex);
+      for (const auto& [threadId, name] : _threadNames) {
+         file << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << threadId << ",\"args\":{\"name\":";
+         WriteJsonString(file, name.c_str());
+         file << "}}";
+         first = false;
+      }
+   }
+   file << std::fixed;
+   file.precision(3);
+   for (const TraceEvent& event : events) {
+      file << (first ? "" : ",") << "\n{\"name\":";
+      WriteJsonString(file, event.name);
+      file << ",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.threadId
+           << ",\"ts\":" << static_cast<double>(event.start) / 1000.0
+           << ",\"dur\":" << static_cast<double>(event.duration) / 1000.0 << "}";
+      first = false;
+   }
+   file << "\n]}\n";
+
+   if (!file.good()) {
+      std::cerr << "Failed to write trace file: " << path << std::endl;
+      return false;
+   }
+   std::cout << "Wrote " << events.size() << " trace events to " << path << std::endl;
+   return true;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <Core/Core.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// A completed span on one thread, times are in nanoseconds since the tracer was created.
+struct TraceEvent {
+   const char* name = nullptr;
+   u64 start = 0;
+   u64 duration = 0;
+   u32 threadId = 0;
+};
+
+// Records scoped CPU spans from any thread into a fixed-size ring buffer and exports them as Chrome
+// trace_event JSON (chrome://tracing, Perfetto). When disabled a scope costs one relaxed atomic load.
+class Tracer {
+public:
+   static constexpr size_t Capacity = 1 << 16;
+
+   static Tracer& GetInstance() {
+      static Tracer instance;
+      return instance;
+   }
+
+private:
+   // The sequence of a slot is the event index plus one once the event is fully written.
+   struct Slot {
+      std::atomic<u64> sequence = 0;
+      TraceEvent event;
+   };
+
+   std::atomic<bool> _enabled = false;
+   std::atomic<u64> _nextEvent = 0;
+   std::vector<Slot> _slots;
+   u64 _startTime = 0;
+
+   std::mutex _threadNamesMutex;
+   std::unordered_map<u32, std::string> _threadNames;
+
+   Tracer();
+
+   ~Tracer() = default;
+
+   Tracer(const Tracer&) = delete;
+
+   Tracer& operator=(const Tracer&) = delete;
+
+public:
+   [[nodiscard]] bool IsEnabled() const { return _enabled.load(std::memory_order_relaxed); }
+
+   void SetEnabled(bool enabled) { _enabled.store(enabled, std::memory_order_relaxed); }
+
+   // Monotonic time in nanoseconds.
+   static u64 Now();
+
+   // Small sequential id of the calling thread.
+   static u32 GetThreadId();
+
+   // Names the calling thread in exported traces.
+   void SetThreadName(const char* name);
+
+   // name must outlive the tracer, scopes pass string literals.
+   void Record(const char* name, u64 start, u64 end);
+
+   // Writes the events currently held by the ring buffer, the oldest are overwritten once it is full.
+   bool Export(const std::filesystem::path& path);
+};
+
+// Records the lifetime of the scope as a span.
+class TraceScope {
+private:
+   const char* _name;
+   u64 _start;
+
+public:
+   explicit TraceScope(const char* name)
+      : _name(Tracer::GetInstance().IsEnabled() ? name : nullptr), _start(_name ? Tracer::Now() : 0) {}
+
+   ~TraceScope() {
+      if (_name) {
+         Tracer::GetInstance().Record(_name, _start, Tracer::Now());
+      }
+   }
+
+   TraceScope(const TraceScope&) = delete;
+
+   TraceScope& operator=(const TraceScope&) = delete;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <Core/Core.h>
+
+#include <atomic>
+
+// Lock-free handoff of the latest value from one writer thread to one reader thread. The writer never
+// waits for the reader, values written between two reads are skipped and the reader only sees the newest.
+template<typename T>
+class TripleBuffer {
+private:
+   static constexpr u32 IndexMask = 3;
+   static constexpr u32 NewBit = 4; // Set when the shared slot holds a value the reader has not taken.
+
+   T _buffers[3] = {};
+   std::atomic<u32> _shared = 1;
+   u32 _back = 0; // Writer owned.
+   u32 _front = 2; // Reader owned.
+
+public:
+   // Writer thread only.
+   void Write(const T& value) {
+      _buffers[_back] = value;
+      _back = _shared.exchange(_back | NewBit, std::memory_order_acq_rel) & IndexMask;
+   }
+
+   // Reader thread only, returns false and leaves value unchanged when nothing new was written.
+   bool Read(T& value) {
+      if ((_shared.load(std::memory_order_relaxed) & NewBit) == 0) {
+         return false;
+      }
+      _front = _shared.exchange(_front, std::memory_order_acq_rel) & IndexMask;
+      value = _buffers[_front];
+      return true;
+   }
+};
@@ -0,0 +1,216 @@
+#include <GaussianSplatting.h>
+#include <SplatConverter/ExternalSort.h>
+#include <Utils/Parallel.h>
+#include <Utils/Tracer.h>
+
+#include <queue>
+
+// Splats merged into the writer at once.
+constexpr size_t MergeBatchSize = 65536;
+
+// Buffered sequential reader of one run file.
+class RunReader {
+private:
+   std::ifstream _file;
+   std::vector<uint8_t> _buffer;
+   size_t _position = 0;
+   size_t _end = 0;
+   size_t _recordSize = 0;
+
+public:
+   bool Open(const std::filesystem::path& path, size_t recordSize, size_t bufferSize) {
+      _file.open(path, std::ios::binary);
+      _recordSize = recordSize;
+      _buffer.resize(std::max(bufferSize / recordSize, size_t(1)) * recordSize);
+      return _file.is_open() && Fill();
+   }
+
+   // Current record, nullptr once the run is exhausted.
+   [[nodiscard]] const uint8_t* Get() const { return _position < _end ? _buffer.data() + _position : nullptr; }
+
+   bool Next() {
+      _position += _recordSize;
+      return _position < _end || Fill();
+   }
+
+private:
+   bool Fill() {
+      _file.read(reinterpret_cast<char*>(_buffer.data()), static_cast<std::streamsize>(_buffer.size()));
+      _position = 0;
+      _end = static_cast<size_t>(_file.gcount()) / _recordSize * _recordSize;
+      return _end > 0;
+   }
+};
+
+ExternalSplatSort::~ExternalSplatSort() {
+   WaitForRunWriter();
+   RemoveRuns();
+}
+
+void ExternalSplatSort::Start(const std::filesystem::path& directory, const std::string& prefix, size_t runCapacity, u32 shWords) {
+   _directory = directory;
+   _prefix = prefix;
+   _runCapacity = std::max<size_t>(runCapacity, 1);
+   _shWords = shWords;
+   _filling.keys.reserve(_runCapacity);
+   _filling.splats.reserve(_runCapacity);
+   _filling.shCoefficients.reserve(_runCapacity * shWords);
+}
+
+bool ExternalSplatSort::Add(u64 key, const Splat& splat, const u32* shCoefficients) {
+   _filling.keys.push_back(key);
+   _filling.splats.push_back(splat);
+   _filling.shCoefficients.insert(_filling.shCoefficients.end(), shCoefficients, shCoefficients + _shWords);
+   return _filling.keys.size() < _runCapacity || FlushRun();
+}
+
+bool ExternalSplatSort::Merge(SplatWriter& writer, size_t readBufferSize) {
+   TRACE_SCOPE("ExternalSplatSort::Merge");
+   // Everything fit into one run, it goes straight to the writer.
+   if (_runPaths.empty()) {
+      SortRun(_filling);
+      return writer.Write(_filling.splats.data(), _filling.shCoefficients.data(), _filling.splats.size());
+   }
+   if ((!_filling.keys.empty() && !FlushRun()) || !WaitForRunWriter()) {
+      return false;
+   }
+   _filling = Run();
+   _writing = Run();
+
+   const size_t recordSize = GetRecordSize(_shWords);
+   std::vector<RunReader> readers(_runPaths.size());
+   for (size_t r = 0; r < readers.size(); ++r) {
+      if (!readers[r].Open(_runPaths[r], recordSize, readBufferSize / readers.size())) {
+         std::cerr << "Failed to read sort run: " << _runPaths[r] << std::endl;
+         return false;
+      }
+   }
+   std::cout << "Merging " << readers.size() << " sorted runs" << std::endl;
+
+   // Smallest key first, ties go to the earlier run so equal keys keep their order.
+   using HeapEntry = std::pair<u64, size_t>;
+   std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>> heap;
+   for (size_t r = 0; r < readers.size(); ++r) {
+      u64 key;
+      memcpy(&key, readers[r].Get(), sizeof(key));
+      heap.push({ key, r });
+   }
+
+   std::vector<Splat> splats;
+   std::vector<u32> shCoefficients;
+   splats.reserve(MergeBatchSize);
+   shCoefficients.reserve(MergeBatchSize * _shWords);
+   while (!heap.empty()) {
+      size_t r = heap.top().second;
+      heap.pop();
+      const uint8_t* record = readers[r].Get();
+      splats.emplace_back();
+      memcpy(&splats.back(), record + sizeof(u64), sizeof(Splat));
+      shCoefficients.resize(shCoefficients.size() + _shWords);
+      memcpy(shCoefficients.data() + shCoefficients.size() - _shWords, record + sizeof(u64) + sizeof(Splat), _shWords * sizeof(u32));
+      if (readers[r].Next()) {
+         u64 key;
+         memcpy(&key, readers[r].Get(), sizeof(key));
+         heap.push({ key, r });
+      }
+
+      if (splats.size() == MergeBatchSize || heap.empty()) {
+         if (!writer.Write(splats.data(), shCoefficients.data(), splats.size())) {
+            return false;
+         }
+         splats.clear();
+         shCoefficients.clear();
+      }
+   }
+   return true;
+}
+
+void ExternalSplatSort::SortRun(Run& run) const {
+   TRACE_SCOPE("ExternalSplatSort::SortRun");
+   const size_t count = run.keys.size();
+   std::vector<u32> order(count);
+   for (size_t i = 0; i < count; ++i) {
+      order[i] = static_cast<u32>(i);
+   }
+   Parallel::Sort(order.begin(), order.end(), [&run](u32 a, u32 b) {
+      return run.keys[a] < run.keys[b] || (run.keys[a] == run.keys[b] && a < b);
+   });
+
+   Run sorted;
+   sorted.keys.resize(count);
+   sorted.splats.resize(count);
+   sorted.shCoefficients.resize(count * _shWords);
+   Parallel::ForChunks(count, 65536, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+         sorted.keys[i] = run.keys[order[i]];
+         sorted.splats[i] = run.splats[order[i]];
+         memcpy(sorted.shCoefficients.data() + i * _shWords, run.shCoefficients.data() + static_cast<size_t>(order[i]) * _shWords, _shWords * sizeof(u32));
+      }
+   });
+   run = std::move(sorted);
+}
+
+bool ExternalSplatSort::FlushRun() {
+   SortRun(_filling);
+   if (!WaitForRunWriter()) {
+      return false;
+   }
+
+   // The previous run is on disk, its buffers collect the next run.
+   std::swap(_filling, _writing);
+   _filling.keys.clear();
+   _filling.splats.clear();
+   _filling.shCoefficients.clear();
+
+   std::filesystem::path path = _directory / (_prefix + ".run" + std::to_string(_runPaths.size()) + ".tmp");
+   _runPaths.push_back(path);
+   _runWriter = std::thread([this, path]() {
+      Tracer::GetInstance().SetThreadName("Sort run writer");
+      _runWriteFailed = !WriteRun(_writing, path);
+   });
+   return true;
+}
+
+bool ExternalSplatSort::WriteRun(const Run& run, const std::filesystem::path& path) const {
+   TRACE_SCOPE("ExternalSplatSort::WriteRun");
+   std::ofstream file(path, std::ios::binary | std::ios::trunc);
+   if (!file.is_open()) {
+      std::cerr << "Failed to create sort run: " << path << std::endl;
+      return false;
+   }
+
+   // Records are interleaved in blocks so the merge reads every run sequentially.
+   const size_t recordSize = GetRecordSize(_shWords);
+   const size_t blockRecords = std::max<size_t>((4 << 20) / recordSize, 1);
+   std::vector<uint8_t> block(blockRecords * recordSize);
+   for (size_t first = 0; first < run.keys.size(); first += blockRecords) {
+      size_t count = std::min(blockRecords, run.keys.size() - first);
+      for (size_t i = 0; i < count; ++i) {
+         uint8_t* record = block.data() + i * recordSize;
+         memcpy(record, &run.keys[first + i], sizeof(u64));
+         memcpy(record + sizeof(u64), &run.splats[first + i], sizeof(Splat));
+         memcpy(record + sizeof(u64) + sizeof(Splat), run.shCoefficients.data() + (first + i) * _shWords, _shWords * sizeof(u32));
+      }
+      file.write(reinterpret_cast<const char*>(block.data()), static_cast<std::streamsize>(count * recordSize));
+   }
+   if (!file.good()) {
+      std::cerr << "Failed to write sort run: " << path << std::endl;
+      return false;
+   }
+   return true;
+}
+
+bool ExternalSplatSort::WaitForRunWriter() {
+   if (_runWriter.joinable()) {
+      _runWriter.join();
+   }
+   return !_runWriteFailed;
+}
+
+void ExternalSplatSort::RemoveRuns() {
+   std::error_code error;
+   for (const std::filesystem::path& path : _runPaths) {
+      std::filesystem::remove(path, error);
+   }
+   _runPaths.clear();
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <SplatConverter/SplatStream.h>
+
+#include <thread>
+
+// Sorts splats by a 64-bit key with bounded memory. Splats are collected into runs that are
+// sorted in parallel and written to temporary files while the next run is collected, then the
+// runs are merged into the writer. Equal keys keep the order in which the splats were added.
+class ExternalSplatSort {
+private:
+   // Keys, splats and SH coefficients of one run, sorted before it is written.
+   struct Run {
+      std::vector<u64> keys;
+      std::vector<Splat> splats;
+      std::vector<u32> shCoefficients;
+   };
+
+   std::filesystem::path _directory;
+   std::string _prefix;
+   size_t _runCapacity = 0;
+   u32 _shWords = 0;
+   Run _filling;
+   Run _writing;
+   std::thread _runWriter;
+   bool _runWriteFailed = false;
+   std::vector<std::filesystem::path> _runPaths;
+
+public:
+   ~ExternalSplatSort();
+
+   // Run files are named prefix.run<N>.tmp in directory. Up to three runs of runCapacity splats are in memory
+   // at once: the one being collected, its sorted copy and the one being written.
+   void Start(const std::filesystem::path& directory, const std::string& prefix, size_t runCapacity, u32 shWords);
+
+   bool Add(u64 key, const Splat& splat, const u32* shCoefficients);
+
+   // Writes all splats in key order. A single run is written without temporary files.
+   // readBufferSize bytes are shared by the run readers.
+   bool Merge(SplatWriter& writer, size_t readBufferSize);
+
+   // Bytes of one splat in a run file.
+   static size_t GetRecordSize(u32 shWords) { return sizeof(u64) + sizeof(Splat) + shWords * sizeof(u32); }
+
+private:
+   // Sorts the filled run in place.
+   void SortRun(Run& run) const;
+
+   // Sorts the filled run and hands it to the run writer thread.
+   bool FlushRun();
+
+   bool WriteRun(const Run& run, const std::filesystem::path& path) const;
+
+   bool WaitForRunWriter();
+
+   void RemoveRuns();
+};
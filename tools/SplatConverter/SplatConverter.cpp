@@ -0,0 +1,226 @@
+#include <GaussianSplatting.h>
+#include <SplatConverter/SplatConverter.h>
+#include <Utils/Parallel.h>
+#include <Utils/Tracer.h>
+
+#include <chrono>
+#include <mutex>
+
+// What happens to a splat of the batch.
+enum ESelection : u8 {
+   SELECTION_DROPPED,
+   SELECTION_KEPT,
+   SELECTION_BOUNDARY, // In the threshold bin of the splat budget, kept while the quota lasts.
+};
+
+bool SplatConverter::Convert(const std::filesystem::path& input, const std::filesystem::path& output, const ConverterOptions& options) {
+   TRACE_SCOPE("SplatConverter::Convert");
+   auto start = std::chrono::high_resolution_clock::now();
+   _options = options;
+   if (!_reader.Open(input)) {
+      return false;
+   }
+   ESceneFormat outputFormat = GetSceneFormat(output);
+   if (outputFormat == SCENE_FORMAT_COUNT) {
+      std::cerr << "Unsupported scene format: " << output << std::endl;
+      return false;
+   }
+   _inputSHWords = _reader.GetSHWords();
+   _outputSHDegree = outputFormat == SCENE_FORMAT_SPLAT ? 0 : std::min(_reader.GetSHDegree(), options.maxSHDegree);
+   _outputSHWords = _outputSHDegree > 0 ? GetSHWordsPerSplat(_outputSHDegree) : 0;
+
+   // A quarter of the budget goes to the batch, the sort runs and the merge share the rest.
+   size_t batchRecordSize = 2 * sizeof(Splat) + (_inputSHWords + _outputSHWords) * sizeof(u32) + sizeof(u8) + sizeof(u32) + sizeof(u64);
+   _batchSize = static_cast<size_t>(std::clamp<u64>(options.memoryBudget / 4 / batchRecordSize, 4096, 1 << 20));
+
+   std::cout << "Converting " << _reader.GetCount() << " splats from " << input << std::endl;
+   Scan();
+   ApplyBudget();
+   std::cout << "Kept " << _keptCount << " of " << _reader.GetCount() << " splats after pruning" << std::endl;
+
+   SplatWriter writer;
+   if (!writer.Open(output, _keptCount, _outputSHDegree)) {
+      return false;
+   }
+
+   ExternalSplatSort sort;
+   bool reorder = options.processing.spatialReorder && _keptCount > 1;
+   if (reorder) {
+      // Up to three runs are in memory at once, plus the sort order of one of them.
+      size_t runRecordSize = 3 * ExternalSplatSort::GetRecordSize(_outputSHWords) + sizeof(u32);
+      size_t runCapacity = static_cast<size_t>(std::min<u64>(options.memoryBudget / 2 / runRecordSize, 0xFFFFFFFFull));
+      std::filesystem::path directory = options.tempDirectory.empty() ? output.parent_path() : options.tempDirectory;
+      sort.Start(directory.empty() ? std::filesystem::path(".") : directory, output.filename().string(), runCapacity, _outputSHWords);
+   }
+   if (!Stream(writer, reorder ? &sort : nullptr) || !writer.Close()) {
+      return false;
+   }
+
+   auto end = std::chrono::high_resolution_clock::now();
+   std::error_code error;
+   double sizeMB = static_cast<double>(std::filesystem::file_size(output, error)) / (1024.0 * 1024.0);
+   std::cout << "Wrote " << output << " (" << sizeMB << " MB) in " << std::chrono::duration<float>(end - start).count() << " s" << std::endl;
+   return true;
+}
+
+u32 SplatConverter::GetImportanceBin(float importance) {
+   if (!(importance > 0.0f)) {
+      return 0;
+   }
+   float bin = (std::log2(importance) + 64.0f) * 32.0f + 1.0f;
+   return static_cast<u32>(clamp(bin, 1.0f, static_cast<float>(ImportanceBins - 1)));
+}
+
+void SplatConverter::ReadBatch(u64 begin, u64 end) {
+   TRACE_SCOPE("SplatConverter::ReadBatch");
+   size_t count = static_cast<size_t>(end - begin);
+   _batch.resize(count);
+   _batchSH.resize(count * _inputSHWords);
+   Parallel::ForChunks(count, 16384, [&](size_t first, size_t last) {
+      _reader.Read(begin + first, begin + last, _batch.data() + first, _batchSH.data() + first * _inputSHWords);
+   });
+}
+
+void SplatConverter::Scan() {
+   TRACE_SCOPE("SplatConverter::Scan");
+   const SplatProcessingOptions& processing = _options.processing;
+   std::mutex mutex;
+   _keptCount = 0;
+   _boundsMin = vec3(std::numeric_limits<float>::max());
+   _boundsMax = vec3(-std::numeric_limits<float>::max());
+   _histogram.assign(ImportanceBins, 0);
+
+   const u64 count = _reader.GetCount();
+   for (u64 begin = 0; begin < count; begin += _batchSize) {
+      ReadBatch(begin, std::min<u64>(count, begin + _batchSize));
+      Parallel::ForChunks(_batch.size(), 65536, [&](size_t first, size_t last) {
+         u64 kept = 0;
+         vec3 localMin(std::numeric_limits<float>::max());
+         vec3 localMax(-std::numeric_limits<float>::max());
+         std::vector<u64> histogram(processing.splatBudget > 0 ? ImportanceBins : 0, 0);
+         for (size_t i = first; i < last; ++i) {
+            const Splat& splat = _batch[i];
+            if (SplatProcessing::IsPruned(splat, processing)) {
+               continue;
+            }
+            ++kept;
+            localMin = min(localMin, vec3(splat.position));
+            localMax = max(localMax, vec3(splat.position));
+            if (processing.splatBudget > 0) {
+               ++histogram[GetImportanceBin(SplatProcessing::ComputeImportance(splat))];
+            }
+         }
+
+         std::lock_guard lock(mutex);
+         _keptCount += kept;
+         _boundsMin = min(_boundsMin, localMin);
+         _boundsMax = max(_boundsMax, localMax);
+         for (size_t bin = 0; bin < histogram.size(); ++bin) {
+            _histogram[bin] += histogram[bin];
+         }
+      });
+   }
+}
+
+void SplatConverter::ApplyBudget() {
+   // Without a budget every splat that survives pruning is kept.
+   _thresholdBin = 0;
+   _boundaryQuota = std::numeric_limits<u64>::max();
+   const u64 budget = _options.processing.splatBudget;
+   if (budget == 0 || _keptCount <= budget) {
+      return;
+   }
+
+   // Bins are filled from the most important one, the bin that crosses the budget is split.
+   u64 above = 0;
+   for (u32 bin = ImportanceBins; bin-- > 0;) {
+      if (above + _histogram[bin] >= budget) {
+         _thresholdBin = bin;
+         _boundaryQuota = budget - above;
+         break;
+      }
+      above += _histogram[bin];
+   }
+   _keptCount = budget;
+}
+
+bool SplatConverter::Stream(SplatWriter& writer, ExternalSplatSort* sort) {
+   TRACE_SCOPE("SplatConverter::Stream");
+   const u64 count = _reader.GetCount();
+   for (u64 begin = 0; begin < count; begin += _batchSize) {
+      ReadBatch(begin, std::min<u64>(count, begin + _batchSize));
+      SelectBatch();
+      if (!sort) {
+         if (!writer.Write(_kept.data(), _keptSH.data(), _kept.size())) {
+            return false;
+         }
+         continue;
+      }
+      for (size_t k = 0; k < _kept.size(); ++k) {
+         if (!sort->Add(_keptCodes[k], _kept[k], _keptSH.data() + k * _outputSHWords)) {
+            return false;
+         }
+      }
+   }
+   return !sort || sort->Merge(writer, static_cast<size_t>(_options.memoryBudget / 2));
+}
+
+void SplatConverter::SelectBatch() {
+   TRACE_SCOPE("SplatConverter::SelectBatch");
+   const SplatProcessingOptions& processing = _options.processing;
+   const size_t count = _batch.size();
+   _selection.resize(count);
+   Parallel::ForChunks(count, 65536, [&](size_t first, size_t last) {
+      for (size_t i = first; i < last; ++i) {
+         const Splat& splat = _batch[i];
+         if (SplatProcessing::IsPruned(splat, processing)) {
+            _selection[i] = SELECTION_DROPPED;
+         } else if (processing.splatBudget == 0) {
+            _selection[i] = SELECTION_KEPT;
+         } else {
+            u32 bin = GetImportanceBin(SplatProcessing::ComputeImportance(splat));
+            _selection[i] = bin > _thresholdBin ? SELECTION_KEPT : bin == _thresholdBin ? SELECTION_BOUNDARY : SELECTION_DROPPED;
+         }
+      }
+   });
+
+   // The quota of the threshold bin goes to the first splats in file order, so the result does not depend on the batch size.
+   std::vector<u32> indices;
+   indices.reserve(count);
+   for (size_t i = 0; i < count; ++i) {
+      bool kept = _selection[i] == SELECTION_KEPT;
+      if (_selection[i] == SELECTION_BOUNDARY && _boundaryQuota > 0) {
+         --_boundaryQuota;
+         kept = true;
+      }
+      if (kept) {
+         indices.push_back(static_cast<u32>(i));
+      }
+   }
+
+   // Lower SH bands come first in the interleaved layout, so truncating keeps a prefix of the words.
+   // An odd number of halves leaves the upper half of the last word unused.
+   const u32 outputHalves = _outputSHDegree > 0 ? 3 * ((_outputSHDegree + 1) * (_outputSHDegree + 1) - 1) : 0;
+   const bool reorder = processing.spatialReorder;
+   const vec3 extent = max(_boundsMax - _boundsMin, vec3(1e-6f));
+   _kept.resize(indices.size());
+   _keptSH.resize(indices.size() * _outputSHWords);
+   _keptCodes.resize(reorder ? indices.size() : 0);
+   Parallel::ForChunks(indices.size(), 65536, [&](size_t first, size_t last) {
+      for (size_t k = first; k < last; ++k) {
+         const size_t i = indices[k];
+         _kept[k] = _batch[i];
+         if (_outputSHWords > 0) {
+            u32* coefficients = _keptSH.data() + k * _outputSHWords;
+            memcpy(coefficients, _batchSH.data() + i * _inputSHWords, _outputSHWords * sizeof(u32));
+            if (outputHalves % 2 == 1) {
+               coefficients[_outputSHWords - 1] &= 0xFFFF;
+            }
+         }
+         // Bounds of the pruned scene, splats dropped by the budget do not shrink them.
+         if (reorder) {
+            _keptCodes[k] = SplatProcessing::ComputeMortonCode(vec3(_kept[k].position), _boundsMin, extent);
+         }
+      }
+   });
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <SplatConverter/ExternalSort.h>
+#include <SplatConverter/SplatStream.h>
+#include <Utils/SplatProcessing.h>
+
+struct ConverterOptions {
+   // Pruning, splat budget and Morton reordering, with the same defaults as loading in the renderer.
+   // The budget selection is approximate, see SplatConverter.
+   SplatProcessingOptions processing;
+   // Higher SH bands are dropped, .splat files store none.
+   u32 maxSHDegree = 3;
+   // Bytes for decoded batches, sort runs and merge buffers.
+   u64 memoryBudget = 1024ull * 1024 * 1024;
+   // Sort runs go next to the output file when empty.
+   std::filesystem::path tempDirectory;
+};
+
+// Converts between scene formats in two streaming passes over the mapped input, so memory stays
+// within the budget for inputs larger than RAM. The first pass collects the bounds and a histogram
+// of splat importance, which turns the splat budget into an importance threshold. The second pass
+// decodes, prunes and truncates the SH in parallel batches and writes the splats directly, or
+// through an external Morton sort when they are reordered.
+// The budget is exact in count but only approximates the renderer's selection: importance is ranked
+// to histogram bin resolution, the threshold bin is filled in file order, and the Morton bounds are
+// those of the pruned scene before the budget.
+class SplatConverter {
+public:
+   // Histogram bins over log2 of the importance, 32 per octave.
+   static constexpr u32 ImportanceBins = 4096;
+
+private:
+   ConverterOptions _options;
+   SplatReader _reader;
+   u32 _inputSHWords = 0;
+   u32 _outputSHDegree = 0;
+   u32 _outputSHWords = 0;
+   size_t _batchSize = 0;
+
+   // Decoded batch of input splats and what happens to each of them.
+   std::vector<Splat> _batch;
+   std::vector<u32> _batchSH;
+   std::vector<u8> _selection;
+
+   // Kept splats of the batch in the output layout.
+   std::vector<Splat> _kept;
+   std::vector<u32> _keptSH;
+   std::vector<u64> _keptCodes;
+
+   // Results of the first pass.
+   u64 _keptCount = 0;
+   vec3 _boundsMin = vec3(0.0f);
+   vec3 _boundsMax = vec3(0.0f);
+   std::vector<u64> _histogram;
+   // Splats in higher bins are kept, _boundaryQuota splats of this bin are kept in file order.
+   u32 _thresholdBin = 0;
+   u64 _boundaryQuota = 0;
+
+public:
+   bool Convert(const std::filesystem::path& input, const std::filesystem::path& output, const ConverterOptions& options);
+
+   static u32 GetImportanceBin(float importance);
+
+private:
+   // Decodes input splats [begin, end) into the batch.
+   void ReadBatch(u64 begin, u64 end);
+
+   void Scan();
+
+   // Turns the splat budget into the threshold bin and the quota of that bin.
+   void ApplyBudget();
+
+   bool Stream(SplatWriter& writer, ExternalSplatSort* sort);
+
+   // Marks the kept splats of the batch and moves them into the output layout.
+   void SelectBatch();
+};
@@ -0,0 +1,366 @@
+#include <GaussianSplatting.h>
+#include <SplatConverter/SplatStream.h>
+#include <Utils/ChunkHierarchy.h>
+#include <Utils/Parallel.h>
+#include <Utils/SplatLod.h>
+#include <Utils/Tracer.h>
+
+#include <sstream>
+
+// Position, DC color, degree 3 SH, opacity, scale and rotation.
+constexpr size_t MaxPlyProperties = 3 + 3 + 45 + 1 + 3 + 4;
+
+ESceneFormat GetSceneFormat(const std::filesystem::path& path) {
+   if (path.extension() == ".splat") {
+      return SCENE_FORMAT_SPLAT;
+   }
+   if (path.extension() == ".ply") {
+      return SCENE_FORMAT_PLY;
+   }
+   if (path.extension() == SceneCache::Extension) {
+      return SCENE_FORMAT_NATIVE;
+   }
+   return SCENE_FORMAT_COUNT;
+}
+
+bool SplatReader::Open(const std::filesystem::path& path) {
+   _format = GetSceneFormat(path);
+   if (_format == SCENE_FORMAT_NATIVE) {
+      if (!_native.Open(path, SceneCache::StandaloneHash)) {
+         std::cerr << "Not a native scene file: " << path << std::endl;
+         return false;
+      }
+      _count = _native.GetHeader().splatCount;
+      _shDegree = _native.GetHeader().shDegree;
+      return true;
+   }
+
+   if (_format == SCENE_FORMAT_PLY) {
+      std::ifstream file(path, std::ios::binary);
+      PlyHeader header;
+      if (!file.is_open() || !FileReader::ReadPlyHeader(file, path, header) || !_plyDecoder.Init(header, path)) {
+         return false;
+      }
+      _dataOffset = header.dataOffset;
+      _stride = header.vertexStride;
+      _count = header.vertexCount;
+      _shDegree = _plyDecoder.shDegree;
+   } else if (_format == SCENE_FORMAT_SPLAT) {
+      _dataOffset = 0;
+      _stride = FileReader::SplatRecordSize;
+      _shDegree = 0;
+   } else {
+      std::cerr << "Unsupported scene format: " << path << std::endl;
+      return false;
+   }
+
+   if (!_file.Open(path)) {
+      std::cerr << "Failed to open geometry file: " << path << std::endl;
+      return false;
+   }
+   if (_format == SCENE_FORMAT_SPLAT) {
+      _count = _file.GetSize() / _stride;
+   } else if (_dataOffset + _count * _stride > _file.GetSize()) {
+      std::cerr << "PLY file is truncated: " << path << std::endl;
+      return false;
+   }
+   return true;
+}
+
+void SplatReader::Read(u64 begin, u64 end, Splat* splats, u32* shCoefficients) const {
+   const u32 shWords = GetSHWords();
+   if (_format == SCENE_FORMAT_NATIVE) {
+      memcpy(splats, _native.GetSplats() + begin, (end - begin) * sizeof(Splat));
+      if (shWords > 0) {
+         memcpy(shCoefficients, _native.GetSHCoefficients() + begin * shWords, (end - begin) * shWords * sizeof(u32));
+      }
+      return;
+   }
+
+   const uint8_t* data = _file.GetData() + _dataOffset;
+   for (u64 i = begin; i < end; ++i) {
+      const uint8_t* record = data + i * _stride;
+      if (_format == SCENE_FORMAT_PLY) {
+         _plyDecoder.Decode(reinterpret_cast<const char*>(record), splats[i - begin], shCoefficients + (i - begin) * shWords);
+      } else {
+         FileReader::DecodeSplatRecord(record, splats[i - begin]);
+      }
+   }
+}
+
+SplatWriter::~SplatWriter() {
+   // Files that were never closed are incomplete.
+   if (_file.is_open()) {
+      _file.close();
+      std::error_code error;
+      std::filesystem::remove(_tempPath, error);
+   }
+}
+
+bool SplatWriter::Open(const std::filesystem::path& path, u64 count, u32 shDegree) {
+   _format = GetSceneFormat(path);
+   if (_format == SCENE_FORMAT_COUNT) {
+      std::cerr << "Unsupported scene format: " << path << std::endl;
+      return false;
+   }
+   _path = path;
+   _count = count;
+   _written = 0;
+   _shDegree = shDegree;
+   _shWords = shDegree > 0 ? GetSHWordsPerSplat(shDegree) : 0;
+
+   // Write to a temporary file first so an interrupted conversion never leaves a valid looking file behind.
+   _tempPath = path;
+   _tempPath += ".tmp";
+   std::error_code error;
+   if (path.has_parent_path()) {
+      std::filesystem::create_directories(path.parent_path(), error);
+   }
+
+   if (_format != SCENE_FORMAT_NATIVE) {
+      _file.open(_tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+      if (!_file.is_open()) {
+         std::cerr << "Failed to create file: " << _tempPath << std::endl;
+         return false;
+      }
+      return _format != SCENE_FORMAT_PLY || WritePlyHeader();
+   }
+
+   // Sections are written out of order, so the file gets its final size up front.
+   _header = SceneCache::CreateHeader(count, shDegree, SceneCache::StandaloneHash);
+   _header.boundsMin = vec4(std::numeric_limits<float>::max());
+   _header.boundsMax = vec4(-std::numeric_limits<float>::max());
+   std::ofstream(_tempPath, std::ios::binary | std::ios::trunc).close();
+   std::filesystem::resize_file(_tempPath, _header.fileSize, error);
+   _file.open(_tempPath, std::ios::in | std::ios::out | std::ios::binary);
+   if (error || !_file.is_open()) {
+      std::cerr << "Failed to create file: " << _tempPath << std::endl;
+      return false;
+   }
+
+   _chunk.assign(SceneCache::ChunkSize, Splat{});
+   _chunkSH.assign(static_cast<size_t>(SceneCache::ChunkSize) * _shWords, 0u);
+   _chunkFill = 0;
+   _nextChunk = 0;
+   _positionSum = dvec3(0.0);
+   _lodNodes.clear();
+   _nextLodNode = 0;
+   _lodDepth = 0;
+   if (_header.lodChunkCount > 0) {
+      CollectLodNodes(0, _header.chunkCount, 0);
+   }
+   return true;
+}
+
+bool SplatWriter::Write(const Splat* splats, const u32* shCoefficients, size_t count) {
+   TRACE_SCOPE("SplatWriter::Write");
+   if (_written + count > _count) {
+      std::cerr << "More splats written than announced: " << _path << std::endl;
+      return false;
+   }
+   _written += count;
+
+   if (_format == SCENE_FORMAT_NATIVE) {
+      for (size_t i = 0; i < count; ++i) {
+         _chunk[_chunkFill] = splats[i];
+         if (_shWords > 0) {
+            memcpy(&_chunkSH[_chunkFill * _shWords], shCoefficients + i * _shWords, _shWords * sizeof(u32));
+         }
+         if (++_chunkFill == SceneCache::ChunkSize && !FlushChunk()) {
+            return false;
+         }
+      }
+      return true;
+   }
+
+   // Records are encoded in parallel and written at once.
+   const size_t stride = _format == SCENE_FORMAT_PLY ? GetPlyStride() : FileReader::SplatRecordSize;
+   _encoded.resize(count * stride);
+   Parallel::ForChunks(count, 16384, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+         if (_format == SCENE_FORMAT_PLY) {
+            EncodePlyVertex(splats[i], shCoefficients + i * _shWords, _encoded.data() + i * stride);
+         } else {
+            FileReader::EncodeSplatRecord(splats[i], _encoded.data() + i * stride);
+         }
+      }
+   });
+   _file.write(reinterpret_cast<const char*>(_encoded.data()), static_cast<std::streamsize>(_encoded.size()));
+   return _file.good();
+}
+
+bool SplatWriter::Close() {
+   bool complete = _written == _count;
+   if (!complete) {
+      std::cerr << "Only " << _written << " of " << _count << " splats were written: " << _path << std::endl;
+   }
+
+   if (complete && _format == SCENE_FORMAT_NATIVE) {
+      if (_chunkFill > 0) {
+         complete = FlushChunk();
+      }
+      _header.centroid = _count > 0 ? vec4(vec3(_positionSum / static_cast<double>(_count)), 1.0f) : vec4(0.0f, 0.0f, 0.0f, 1.0f);
+      complete = complete && WriteAt(0, &_header, sizeof(_header));
+   }
+
+   _file.close();
+   std::error_code error;
+   if (!complete || _file.fail()) {
+      std::cerr << "Failed to write file: " << _tempPath << std::endl;
+      std::filesystem::remove(_tempPath, error);
+      return false;
+   }
+
+   std::filesystem::rename(_tempPath, _path, error);
+   if (error) {
+      std::cerr << "Failed to move file into place: " << _path << std::endl;
+      std::filesystem::remove(_tempPath, error);
+      return false;
+   }
+   return true;
+}
+
+bool SplatWriter::WriteAt(u64 offset, const void* data, size_t size) {
+   _file.seekp(static_cast<std::streamoff>(offset));
+   _file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+   return _file.good();
+}
+
+bool SplatWriter::WritePlyHeader() {
+   // Same properties and order as the reference 3DGS training code, without the unused normals.
+   std::ostringstream header;
+   header << "ply\nformat binary_little_endian 1.0\nelement vertex " << _count << "\n";
+   for (const char* name : { "x", "y", "z", "f_dc_0", "f_dc_1", "f_dc_2" }) {
+      header << "property float " << name << "\n";
+   }
+   size_t restCount = _shDegree > 0 ? 3 * ((_shDegree + 1) * (_shDegree + 1) - 1) : 0;
+   for (size_t i = 0; i < restCount; ++i) {
+      header << "property float f_rest_" << i << "\n";
+   }
+   for (const char* name : { "opacity", "scale_0", "scale_1", "scale_2", "rot_0", "rot_1", "rot_2", "rot_3" }) {
+      header << "property float " << name << "\n";
+   }
+   header << "end_header\n";
+
+   std::string text = header.str();
+   _file.write(text.data(), static_cast<std::streamsize>(text.size()));
+   return _file.good();
+}
+
+size_t SplatWriter::GetPlyStride() const {
+   size_t restCount = _shDegree > 0 ? 3 * ((_shDegree + 1) * (_shDegree + 1) - 1) : 0;
+   return (3 + 3 + restCount + 1 + 3 + 4) * sizeof(float);
+}
+
+void SplatWriter::EncodePlyVertex(const Splat& splat, const u32* shCoefficients, uint8_t* vertex) const {
+   float values[MaxPlyProperties];
+   size_t count = 0;
+   values[count++] = splat.position.x;
+   values[count++] = splat.position.y;
+   values[count++] = splat.position.z;
+
+   // Inverse of the activations applied by the PLY loader.
+   vec4 color = vec4((splat.color >> 24) & 0xFF, (splat.color >> 16) & 0xFF, (splat.color >> 8) & 0xFF, splat.color & 0xFF) / 255.0f;
+   for (int c = 0; c < 3; ++c) {
+      values[count++] = (color[c] - 0.5f) / SH_C0;
+   }
+
+   // f_rest_* are stored channel by channel, the GPU layout interleaves RGB triplets.
+   if (_shDegree > 0) {
+      u32 shCount = (_shDegree + 1) * (_shDegree + 1) - 1;
+      for (u32 c = 0; c < 3; ++c) {
+         for (u32 k = 0; k < shCount; ++k) {
+            u32 half = k * 3 + c;
+            values[count++] = unpackHalf2x16(shCoefficients[half / 2])[half % 2];
+         }
+      }
+   }
+
+   float opacity = clamp(color.a, 0.5f / 255.0f, 254.5f / 255.0f);
+   values[count++] = std::log(opacity / (1.0f - opacity));
+   for (int c = 0; c < 3; ++c) {
+      values[count++] = std::log(std::max(splat.scale[c], 1e-30f));
+   }
+
+   // Packed as (w, x, y, z) bytes, the same order the PLY file uses.
+   for (u32 c = 0; c < 4; ++c) {
+      values[count++] = (static_cast<float>((splat.rotation >> (c * 8)) & 0xFF) - 128.0f) / 128.0f;
+   }
+   memcpy(vertex, values, count * sizeof(float));
+}
+
+void SplatWriter::CollectLodNodes(u32 firstChunk, u32 chunkCount, u32 lodIndex) {
+   // Same split and depth first numbering as SplatLod and ChunkHierarchy, children complete before their parent.
+   u32 leftCount = ChunkHierarchy::GetLeftChunkCount(chunkCount);
+   u32 rightCount = chunkCount - leftCount;
+   if (leftCount > 1) {
+      CollectLodNodes(firstChunk, leftCount, lodIndex + 1);
+   }
+   if (rightCount > 1) {
+      CollectLodNodes(firstChunk + leftCount, rightCount, lodIndex + leftCount);
+   }
+   _lodNodes.push_back({ firstChunk + chunkCount - 1, lodIndex });
+}
+
+bool SplatWriter::FlushChunk() {
+   TRACE_SCOPE("SplatWriter::FlushChunk");
+   const u32 chunkSize = SceneCache::ChunkSize;
+   const u32 chunk = _nextChunk++;
+   const size_t splatCount = _chunkFill;
+   _chunkFill = 0;
+
+   // Padding records stay zero, which makes them fully transparent. Without level of detail chunks the last chunk is not padded.
+   std::fill(_chunk.begin() + static_cast<std::ptrdiff_t>(splatCount), _chunk.end(), Splat{});
+   std::fill(_chunkSH.begin() + static_cast<std::ptrdiff_t>(splatCount * _shWords), _chunkSH.end(), 0u);
+   size_t recordCount = _header.lodChunkCount > 0 ? chunkSize : splatCount;
+   u64 record = static_cast<u64>(chunk) * chunkSize;
+   SceneCacheChunk metadata = SceneCache::ComputeChunk(_chunk.data(), splatCount, false);
+   if (!WriteAt(_header.splatsOffset + record * sizeof(Splat), _chunk.data(), recordCount * sizeof(Splat)) ||
+       !WriteAt(_header.shCoefficientsOffset + record * _shWords * sizeof(u32), _chunkSH.data(), recordCount * _shWords * sizeof(u32)) ||
+       !WriteAt(_header.chunksOffset + chunk * sizeof(SceneCacheChunk), &metadata, sizeof(metadata))) {
+      return false;
+   }
+
+   _header.boundsMin = min(_header.boundsMin, metadata.boundsMin);
+   _header.boundsMax = max(_header.boundsMax, metadata.boundsMax);
+   for (size_t i = 0; i < splatCount; ++i) {
+      _positionSum += dvec3(_chunk[i].position);
+   }
+   if (_header.lodChunkCount == 0) {
+      return true;
+   }
+
+   // The chunk waits on the stack until its parent is complete, _chunk gets the storage of the slot.
+   if (_lodSplats.size() <= _lodDepth) {
+      _lodSplats.emplace_back(chunkSize);
+      _lodSH.emplace_back(static_cast<size_t>(chunkSize) * _shWords);
+   }
+   std::swap(_chunk, _lodSplats[_lodDepth]);
+   std::swap(_chunkSH, _lodSH[_lodDepth]);
+   ++_lodDepth;
+
+   // The two topmost chunks are the children of every node completed by this chunk, deepest node first.
+   while (_nextLodNode < _lodNodes.size() && _lodNodes[_nextLodNode].lastChunk == chunk) {
+      const LodNode& node = _lodNodes[_nextLodNode++];
+      size_t left = _lodDepth - 2;
+      size_t right = _lodDepth - 1;
+      const Splat* children[2] = { _lodSplats[left].data(), _lodSplats[right].data() };
+      const u32* childrenSH[2] = { _lodSH[left].data(), _lodSH[right].data() };
+      SplatLod::MergeChildren(children, childrenSH, _shWords, _chunk.data(), _chunkSH.data());
+
+      u32 lodChunk = _header.chunkCount + node.lodIndex;
+      u64 lodRecord = static_cast<u64>(lodChunk) * chunkSize;
+      SceneCacheChunk lodMetadata = SceneCache::ComputeChunk(_chunk.data(), chunkSize, true);
+      if (!WriteAt(_header.splatsOffset + lodRecord * sizeof(Splat), _chunk.data(), chunkSize * sizeof(Splat)) ||
+          !WriteAt(_header.shCoefficientsOffset + lodRecord * _shWords * sizeof(u32), _chunkSH.data(), chunkSize * _shWords * sizeof(u32)) ||
+          !WriteAt(_header.chunksOffset + lodChunk * sizeof(SceneCacheChunk), &lodMetadata, sizeof(lodMetadata))) {
+         return false;
+      }
+
+      // The merged chunk replaces its children on the stack.
+      std::swap(_chunk, _lodSplats[left]);
+      std::swap(_chunkSH, _lodSH[left]);
+      --_lodDepth;
+   }
+   return true;
+}
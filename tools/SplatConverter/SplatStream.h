@@ -0,0 +1,100 @@
+#pragma once
+
+#include <Core/Core.h>
+#include <Utils/FileReader.h>
+#include <Utils/MappedFile.h>
+#include <Utils/SceneCache.h>
+#include <Utils/SceneFormat.h>
+
+// Format of a scene file from its extension, SCENE_FORMAT_COUNT for other files.
+ESceneFormat GetSceneFormat(const std::filesystem::path& path);
+
+// Scene file decoded in ranges. The file is mapped, so only the pages of the ranges being
+// read are resident and files larger than memory can be streamed.
+class SplatReader {
+private:
+   MappedFile _file;
+   SceneCache _native;
+   ESceneFormat _format = SCENE_FORMAT_COUNT;
+   PlyVertexDecoder _plyDecoder;
+   size_t _dataOffset = 0;
+   size_t _stride = 0;
+   u64 _count = 0;
+   u32 _shDegree = 0;
+
+public:
+   bool Open(const std::filesystem::path& path);
+
+   [[nodiscard]] u64 GetCount() const { return _count; }
+
+   [[nodiscard]] u32 GetSHDegree() const { return _shDegree; }
+
+   [[nodiscard]] u32 GetSHWords() const { return _shDegree > 0 ? GetSHWordsPerSplat(_shDegree) : 0; }
+
+   // Decodes splats [begin, end) into the GPU layout, GetSHWords() words per splat. Safe to call from several threads.
+   void Read(u64 begin, u64 end, Splat* splats, u32* shCoefficients) const;
+};
+
+// Scene file written in order, one batch of splats at a time. Native files also get their chunk
+// metadata and level of detail chunks while they are written: source chunks arrive in the depth
+// first order of the chunk hierarchy, so every merged chunk is built as soon as its last child is
+// complete and only one chunk per hierarchy level is kept in memory.
+class SplatWriter {
+private:
+   // Internal node of the chunk hierarchy in the order the nodes are completed.
+   struct LodNode {
+      u32 lastChunk;
+      u32 lodIndex;
+   };
+
+   std::filesystem::path _path;
+   std::filesystem::path _tempPath;
+   std::fstream _file;
+   ESceneFormat _format = SCENE_FORMAT_COUNT;
+   u64 _count = 0;
+   u64 _written = 0;
+   u32 _shDegree = 0;
+   u32 _shWords = 0;
+   std::vector<uint8_t> _encoded;
+
+   // Native files only.
+   SceneCacheHeader _header = {};
+   std::vector<Splat> _chunk;
+   std::vector<u32> _chunkSH;
+   size_t _chunkFill = 0;
+   u32 _nextChunk = 0;
+   dvec3 _positionSum = dvec3(0.0);
+   std::vector<LodNode> _lodNodes;
+   size_t _nextLodNode = 0;
+   // Stack of chunks waiting for their sibling, slots keep their storage.
+   std::vector<std::vector<Splat>> _lodSplats;
+   std::vector<std::vector<u32>> _lodSH;
+   size_t _lodDepth = 0;
+
+public:
+   ~SplatWriter();
+
+   // The format follows the extension. shDegree is the degree of the coefficients passed to Write,
+   // .splat files drop them.
+   bool Open(const std::filesystem::path& path, u64 count, u32 shDegree);
+
+   // GetSHWordsPerSplat(shDegree) words per splat when shDegree > 0.
+   bool Write(const Splat* splats, const u32* shCoefficients, size_t count);
+
+   // Finishes the file and moves it into place, fails unless exactly count splats were written.
+   bool Close();
+
+private:
+   bool WriteAt(u64 offset, const void* data, size_t size);
+
+   bool WritePlyHeader();
+
+   void EncodePlyVertex(const Splat& splat, const u32* shCoefficients, uint8_t* vertex) const;
+
+   [[nodiscard]] size_t GetPlyStride() const;
+
+   void CollectLodNodes(u32 firstChunk, u32 chunkCount, u32 lodIndex);
+
+   // Writes the filled source chunk and every level of detail chunk it completes.
+   bool FlushChunk();
+};
@@ -0,0 +1,66 @@
+#include <GaussianSplatting.h>
+#include <SplatConverter/SplatConverter.h>
+#include <Utils/Tracer.h>
+
+#include <cstdlib>
+
+void PrintUsage() {
+   std::cout << "Usage: SplatConverter <input> <output> [options]\n"
+                "Formats follow the extensions: .splat, .ply and " << SceneCache::Extension << " (native, with chunk and LOD indices).\n"
+                "  --no-prune             Keep degenerate and transparent splats.\n"
+                "  --min-opacity <value>  Prune splats below this opacity, 1/255 by default.\n"
+                "  --min-importance <value> Prune splats below this opacity times volume^(2/3), 0 by default.\n"
+                "  --budget <count>       Keep only the most important splats, ranked to 1/32 of an octave of importance.\n"
+                "  --no-reorder           Keep the input order instead of sorting along a Morton curve.\n"
+                "  --sh-degree <0-3>      Drop higher spherical harmonics bands.\n"
+                "  --memory <MB>          Memory for batches and sort runs, 1024 by default.\n"
+                "  --temp <directory>     Directory of the sort runs, next to the output by default.\n"
+                "Setting GS_TRACE to a file path writes a Chrome trace of the conversion." << std::endl;
+}
+
+int main(int argc, char** argv) {
+   if (argc < 3) {
+      PrintUsage();
+      return 1;
+   }
+
+   ConverterOptions options;
+   for (int i = 3; i < argc; ++i) {
+      std::string option = argv[i];
+      bool hasValue = i + 1 < argc;
+      if (option == "--no-prune") {
+         options.processing.prune = false;
+      } else if (option == "--no-reorder") {
+         options.processing.spatialReorder = false;
+      } else if (option == "--min-opacity" && hasValue) {
+         options.processing.minOpacity = std::strtof(argv[++i], nullptr);
+      } else if (option == "--min-importance" && hasValue) {
+         options.processing.minImportance = std::strtof(argv[++i], nullptr);
+      } else if (option == "--budget" && hasValue) {
+         options.processing.splatBudget = static_cast<u32>(std::strtoul(argv[++i], nullptr, 10));
+      } else if (option == "--sh-degree" && hasValue) {
+         options.maxSHDegree = static_cast<u32>(std::strtoul(argv[++i], nullptr, 10));
+      } else if (option == "--memory" && hasValue) {
+         options.memoryBudget = std::max<u64>(std::strtoull(argv[++i], nullptr, 10), 16) * 1024 * 1024;
+      } else if (option == "--temp" && hasValue) {
+         options.tempDirectory = argv[++i];
+      } else {
+         std::cerr << "Unknown option: " << option << std::endl;
+         PrintUsage();
+         return 1;
+      }
+   }
+
+   const char* tracePath = std::getenv("GS_TRACE");
+   if (tracePath) {
+      Tracer::GetInstance().SetEnabled(true);
+   }
+   Tracer::GetInstance().SetThreadName("Main");
+
+   SplatConverter converter;
+   bool converted = converter.Convert(argv[1], argv[2], options);
+   if (tracePath) {
+      Tracer::GetInstance().Export(tracePath);
+   }
+   return converted ? 0 : 1;
+}